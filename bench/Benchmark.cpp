@@ -0,0 +1,641 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CameraRayGenerator.hpp"
+#include "Framebuffer.hpp"
+#include "GraphicsEngine.hpp"
+#include "InputFileParser.hpp"
+#include "PpmWriter.hpp"
+#include "SceneLoader.hpp"
+#include "core/GeometryArrays.hpp"
+#include "core/Object.hpp"
+#include "core/Ray.hpp"
+#include "core/Texture.hpp"
+#include "core/Vector3D.hpp"
+
+// Description: The ray/triangle test used before triangles were precomputed: Intersect with the triangle's plane,
+// then check the barycentric coordinates of the point, rebuilding the edges and normal along the way.
+// Kept around as the baseline to compare Triangle::IntersectWith against.
+static bool
+legacy_triangle_intersect(const Triangle& triangle, const Ray& ray, float& intersectionTime)
+{
+	auto e1 = Vector3D(triangle.vertexA, triangle.vertexB);
+	auto e2 = Vector3D(triangle.vertexA, triangle.vertexC);
+	auto n = e1.CrossProduct(e2);
+
+	float d = -((n.dx * triangle.vertexA.x) + (n.dy * triangle.vertexA.y) + (n.dz * triangle.vertexA.z));
+
+	float tDenominator = (n.dx * ray.direction.dx) + (n.dy * ray.direction.dy) + (n.dz * ray.direction.dz);
+	if (std::fpclassify(tDenominator) == FP_ZERO)
+		return false;
+
+	float t = -((n.dx * ray.origin.x) + (n.dy * ray.origin.y) + (n.dz * ray.origin.z) + d) / tDenominator;
+	if (std::islessequal(t, 0.0f))
+		return false;
+
+	Point3D point = ray.origin + (ray.direction * t);
+
+	Vector3D ep = Vector3D(triangle.vertexA, point);
+	float d11 = e1.DotProduct(e1);
+	float d12 = e1.DotProduct(e2);
+	float d22 = e2.DotProduct(e2);
+	float determinant = (d11 * d22) - (d12 * d12);
+	if (std::fabs(determinant) < 0.001f)
+		return false;
+
+	float d1p = e1.DotProduct(ep);
+	float d2p = e2.DotProduct(ep);
+	float beta = ((d22 * d1p) - (d12 * d2p)) / determinant;
+	float gamma = ((d11 * d2p) - (d12 * d1p)) / determinant;
+	float alpha = 1.f - beta - gamma;
+	if (alpha < 0.f || alpha > 1.f || beta < 0.f || beta > 1.f || gamma < 0.f || gamma > 1.f)
+		return false;
+
+	intersectionTime = t;
+	return true;
+}
+
+// Description: The ray/sphere test used before spheres were kept in a SphereArray: The full quadratic formula, with
+// powf() for every square. Kept around as the baseline to compare the SphereArray tests against.
+static bool
+legacy_sphere_intersect(const Sphere& sphere, const Ray& ray, float& intersectionTime)
+{
+	float b = 2.f * (ray.direction.dx * (ray.origin.x - sphere.center.x) + ray.direction.dy * (ray.origin.y - sphere.center.y) + ray.direction.dz * (ray.origin.z - sphere.center.z));
+	float c = powf(ray.origin.x - sphere.center.x, 2.f) + powf(ray.origin.y - sphere.center.y, 2.f) + powf(ray.origin.z - sphere.center.z, 2.f) - powf(sphere.radius, 2.f);
+
+	float discriminant = (b * b) - (4.f * c);
+	if (std::signbit(discriminant) && std::fpclassify(discriminant) != FP_ZERO)
+		return false;
+
+	const float sqrtDiscrim = sqrtf(discriminant);
+	float t1 = ((b * -1.f) + sqrtDiscrim) / 2.f;
+	float t2 = ((b * -1.f) - sqrtDiscrim) / 2.f;
+
+	if (!std::signbit(t1) && std::isless(t1, t2))
+		intersectionTime = t1;
+	else if (!std::signbit(t2))
+		intersectionTime = t2;
+	else
+		return false;
+
+	return true;
+}
+
+// How many times each benchmark is run, to see how much its timings vary.
+static constexpr int kRepetitions = 7;
+
+// How long one operation of a benchmark took, over every time it was run.
+struct Measurement {
+	// The fastest, which is the least disturbed by everything else going on.
+	double bestNs;
+	double meanNs;
+
+	// How far apart the runs were, as the standard deviation from the mean.
+	double deviationNs;
+
+	[[nodiscard]] double MillionOperationsPerSecond() const { return 1000.0 / bestNs; }
+};
+
+// Description: Runs 'function' kRepetitions times, after once more to warm up, each time doing 'operationCount'
+// operations.
+// Returns: How many nanoseconds each operation took.
+template<typename Function>
+static Measurement
+measure(Function&& function, std::size_t operationCount)
+{
+	function();
+
+	std::vector<double> samples;
+	for (int repetition = 0; repetition < kRepetitions; repetition++) {
+		const auto start = std::chrono::steady_clock::now();
+		function();
+		const auto end = std::chrono::steady_clock::now();
+
+		const double elapsed = std::chrono::duration<double, std::nano>(end - start).count();
+		samples.push_back(elapsed / static_cast<double>(operationCount));
+	}
+
+	Measurement measurement{ *std::min_element(samples.begin(), samples.end()), 0.0, 0.0 };
+	for (double sample : samples)
+		measurement.meanNs += sample / kRepetitions;
+
+	double variance = 0.0;
+	for (double sample : samples)
+		variance += (sample - measurement.meanNs) * (sample - measurement.meanNs) / kRepetitions;
+	measurement.deviationNs = std::sqrt(variance);
+
+	return measurement;
+}
+
+// Description: Prints out 'measurement' of the benchmark called 'label', along with whatever 'detail' it found.
+static void
+report(const std::string& label, const Measurement& measurement, const std::string& detail = {})
+{
+	std::cout << "\t" << label << ": " << measurement.bestNs << " ns/op, " << measurement.MillionOperationsPerSecond()
+		<< " million ops/s (mean " << measurement.meanNs << " ± " << measurement.deviationNs << " ns, "
+		<< (100.0 * measurement.deviationNs / measurement.meanNs) << "%)";
+	if (!detail.empty())
+		std::cout << ", " << detail;
+	std::cout << std::endl;
+}
+static void
+bench_triangle_intersect(std::size_t triangleCount, std::size_t rayCount)
+{
+	std::mt19937 generator(5607);
+	std::uniform_real_distribution<float> position(-10.f, 10.f);
+	std::uniform_real_distribution<float> offset(-1.f, 1.f);
+
+	std::vector<Triangle> triangles;
+	triangles.reserve(triangleCount);
+	while (triangles.size() < triangleCount) {
+		Triangle triangle;
+		triangle.vertexA = Point3D(position(generator), position(generator), position(generator));
+		triangle.vertexB = triangle.vertexA + Vector3D(offset(generator), offset(generator), offset(generator)) * 3.f;
+		triangle.vertexC = triangle.vertexA + Vector3D(offset(generator), offset(generator), offset(generator)) * 3.f;
+		if (triangle.Precompute())
+			triangles.push_back(triangle);
+	}
+
+	std::vector<Ray> rays(rayCount);
+	for (auto& ray : rays) {
+		ray.origin = Point3D(position(generator), position(generator), -20.f);
+		ray.direction = Vector3D(offset(generator) * 0.5f, offset(generator) * 0.5f, 1.f).Normalize();
+	}
+
+	const std::size_t testCount = triangleCount * rayCount;
+	std::size_t hits = 0;
+	std::size_t legacyHits = 0;
+
+	const Measurement precomputed = measure([&]() {
+		hits = 0;
+		for (const auto& ray : rays) {
+			for (const auto& triangle : triangles) {
+				float t, beta, gamma;
+				hits += triangle.IntersectWith(ray, t, beta, gamma);
+			}
+		}
+	}, testCount);
+
+	const Measurement legacy = measure([&]() {
+		legacyHits = 0;
+		for (const auto& ray : rays) {
+			for (const auto& triangle : triangles) {
+				float t;
+				legacyHits += legacy_triangle_intersect(triangle, ray, t);
+			}
+		}
+	}, testCount);
+
+	std::cout << "Triangle::IntersectWith (" << triangleCount << " triangles x " << rayCount << " rays)" << std::endl;
+	report("Precomputed Möller–Trumbore", precomputed, std::to_string(hits) + " hits");
+	report("Legacy plane + barycentric", legacy, std::to_string(legacyHits) + " hits");
+	std::cout << "\tSpeedup: " << (legacy.bestNs / precomputed.bestNs) << "x" << std::endl;
+}
+
+static void
+bench_sphere_intersect(std::size_t sphereCount, std::size_t rayCount)
+{
+	// The same number of spheres a bounding volume hierarchy leaf tests against a ray at once.
+	static constexpr std::size_t kBatchSize = 16;
+
+	std::mt19937 generator(5607);
+	std::uniform_real_distribution<float> position(-10.f, 10.f);
+	std::uniform_real_distribution<float> offset(-1.f, 1.f);
+	std::uniform_real_distribution<float> size(0.05f, 0.5f);
+
+	std::vector<Sphere> spheres(sphereCount);
+	SphereArray sphereArray;
+	for (std::size_t index = 0; index < sphereCount; index++) {
+		spheres[index].center = Point3D(position(generator), position(generator), position(generator));
+		spheres[index].radius = size(generator);
+		sphereArray.Add(spheres[index], static_cast<uint32_t>(index));
+	}
+
+	std::vector<Ray> rays(rayCount);
+	for (auto& ray : rays) {
+		ray.origin = Point3D(position(generator), position(generator), -20.f);
+		ray.direction = Vector3D(offset(generator) * 0.5f, offset(generator) * 0.5f, 1.f).Normalize();
+	}
+
+	const std::size_t testCount = sphereCount * rayCount;
+	std::size_t batchHits = 0;
+	std::size_t singleHits = 0;
+	std::size_t legacyHits = 0;
+
+	const Measurement batch = measure([&]() {
+		batchHits = 0;
+		alignas(64) float times[kBatchSize];
+		alignas(64) int32_t hits[kBatchSize];
+		for (const auto& ray : rays) {
+			for (std::size_t start = 0; start < sphereCount; start += kBatchSize) {
+				const std::size_t count = std::min(kBatchSize, sphereCount - start);
+				sphereArray.IntersectWith(start, count, ray, times, hits);
+				for (std::size_t sphere = 0; sphere < count; sphere++)
+					batchHits += hits[sphere];
+			}
+		}
+	}, testCount);
+
+	const Measurement single = measure([&]() {
+		singleHits = 0;
+		for (const auto& ray : rays) {
+			for (std::size_t index = 0; index < sphereCount; index++) {
+				float t;
+				singleHits += sphereArray.IntersectWith(index, ray, t);
+			}
+		}
+	}, testCount);
+
+	const Measurement legacy = measure([&]() {
+		legacyHits = 0;
+		for (const auto& ray : rays) {
+			for (const auto& sphere : spheres) {
+				float t;
+				legacyHits += legacy_sphere_intersect(sphere, ray, t);
+			}
+		}
+	}, testCount);
+
+	std::cout << "Sphere::IntersectWith (" << sphereCount << " spheres x " << rayCount << " rays)" << std::endl;
+	report("Batches of " + std::to_string(kBatchSize), batch, std::to_string(batchHits) + " hits");
+	report("One at a time", single, std::to_string(singleHits) + " hits");
+	report("Legacy powf quadratic", legacy, std::to_string(legacyHits) + " hits");
+	std::cout << "\tSpeedup: " << (legacy.bestNs / batch.bestNs) << "x" << std::endl;
+}
+
+/* Synthetic Scenes */
+
+// Description: Writes out a scene definition with 'primitiveCount' primitives, every other one a sphere and the rest
+// triangles, scattered in front of the eye and lit by 'lightCount' lights, every fourth of them directional. Every
+// fourth material is see-through, so shading sends refracted rays on as well as reflected ones. The same arguments
+// always make the same scene.
+static std::string
+synthetic_scene(std::size_t primitiveCount, std::size_t lightCount)
+{
+	std::mt19937 generator(5607);
+	std::uniform_real_distribution<float> position(-10.f, 10.f);
+	std::uniform_real_distribution<float> offset(-1.f, 1.f);
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+	std::uniform_real_distribution<float> size(0.1f, 0.6f);
+
+	std::ostringstream scene;
+	scene << "eye 0 0 -25\nviewdir 0 0 1\nupdir 0 1 0\nvfov 50\nimsize 256 256\n\nbkgcolor 0.1 0.1 0.1 1\n\n";
+
+	for (std::size_t light = 0; light < lightCount; light++) {
+		if (light % 4 == 0)
+			scene << "light " << offset(generator) << " " << offset(generator) << " 1 0 0.6 0.6 0.6\n";
+		else
+			scene << "light " << position(generator) << " " << position(generator) << " -15 1 0.6 0.6 0.6\n";
+	}
+
+	std::size_t vertexCount = 0;
+	for (std::size_t primitive = 0; primitive < primitiveCount; primitive++) {
+		if (primitive % 8 == 0) {
+			const bool seeThrough = (primitive / 8) % 4 == 0;
+			scene << "\nmtlcolor " << unit(generator) << " " << unit(generator) << " " << unit(generator)
+				<< " 1 1 1 0.1 0.6 0.3 20 " << (seeThrough ? 0.3f : 1.f) << " 1.5\n";
+		}
+
+		const Point3D center(position(generator), position(generator), position(generator));
+		if (primitive % 2 == 0) {
+			scene << "sphere " << center.x << " " << center.y << " " << center.z << " " << size(generator) << "\n";
+			continue;
+		}
+
+		for (int vertex = 0; vertex < 3; vertex++) {
+			const Point3D corner = center + Vector3D(offset(generator), offset(generator), offset(generator));
+			scene << "v " << corner.x << " " << corner.y << " " << corner.z << "\n";
+		}
+
+		scene << "f " << (vertexCount + 1) << " " << (vertexCount + 2) << " " << (vertexCount + 3) << "\n";
+		vertexCount += 3;
+	}
+
+	return scene.str();
+}
+
+// Description: Loads the scene synthetic_scene() writes out for 'primitiveCount' and 'lightCount' into 'scene', and
+// finds what up to 'rayCount' rays from the eye through random points of the image hit, into 'rays' and 'hits'. Rays
+// that miss are tried again, a few times over.
+// Returns: false if the scene couldn't be loaded.
+static bool
+load_synthetic_hits(std::size_t primitiveCount, std::size_t lightCount, std::size_t rayCount, SceneDefinition& scene,
+	std::vector<Ray>& rays, std::vector<HitRecord>& hits)
+{
+	// The parser prints out how it went to standard output, which would drown out the results.
+	std::ostream quiet(nullptr);
+	std::cout.setstate(std::ios_base::badbit);
+	const bool loaded = SceneLoader::LoadText(synthetic_scene(primitiveCount, lightCount),
+		std::filesystem::temp_directory_path(), scene, quiet);
+	std::cout.clear();
+
+	if (!loaded) {
+		std::cerr << "(Error) Failed to load the synthetic scene!" << std::endl;
+		return false;
+	}
+
+	std::mt19937 generator(5607);
+	std::uniform_real_distribution<float> pixelX(0.f, static_cast<float>(scene.imagePixelSize.width));
+	std::uniform_real_distribution<float> pixelY(0.f, static_cast<float>(scene.imagePixelSize.height));
+
+	const CameraRayGenerator camera(scene);
+	for (std::size_t attempt = 0; attempt < rayCount * 8 && hits.size() < rayCount; attempt++) {
+		const Ray ray = camera.GenerateRay(pixelX(generator), pixelY(generator));
+
+		HitRecord hit;
+		if (!scene.objectHierarchy.IntersectClosest(ray, hit))
+			continue;
+
+		rays.push_back(ray);
+		hits.push_back(hit);
+	}
+
+	return true;
+}
+
+
+/* Benchmarks */
+
+static void
+bench_calculate_shadow(std::size_t primitiveCount, std::size_t rayCount)
+{
+	static constexpr std::size_t kLightCount = 4;
+
+	SceneDefinition scene;
+	std::vector<Ray> rays;
+	std::vector<HitRecord> hits;
+	if (!load_synthetic_hits(primitiveCount, kLightCount, rayCount, scene, rays, hits))
+		return;
+
+	float shadowSum = 0.f;
+	const Measurement shadow = measure([&]() {
+		shadowSum = 0.f;
+		for (const HitRecord& hit : hits) {
+			for (const SharedLight& light : scene.lightList)
+				shadowSum += GraphicsEngine::CalculateShadow(hit, light, scene.objectHierarchy);
+		}
+	}, hits.size() * kLightCount);
+
+	std::cout << "GraphicsEngine::CalculateShadow (" << primitiveCount << " primitives, " << kLightCount << " lights, "
+		<< hits.size() << " hits)" << std::endl;
+	report("Shadow ray", shadow, std::to_string(shadowSum / static_cast<float>(hits.size() * kLightCount))
+		+ " lit on average");
+}
+
+static void
+bench_shade_with_ray(std::size_t primitiveCount, std::size_t rayCount)
+{
+	static constexpr std::size_t kLightCount = 4;
+
+	SceneDefinition scene;
+	std::vector<Ray> rays;
+	std::vector<HitRecord> hits;
+	if (!load_synthetic_hits(primitiveCount, kLightCount, rayCount, scene, rays, hits))
+		return;
+
+	std::cout << "GraphicsEngine::ShadeWithRay (" << primitiveCount << " primitives, " << kLightCount << " lights, "
+		<< hits.size() << " hits)" << std::endl;
+
+	// Depth 0 is only the surface and its shadows, and the deeper ones add the reflected and refracted rays.
+	for (uint32_t depth : { 0u, 2u }) {
+		float redSum = 0.f;
+		const Measurement shade = measure([&]() {
+			redSum = 0.f;
+			for (std::size_t index = 0; index < hits.size(); index++) {
+				const ColorRGB color = GraphicsEngine::ShadeWithRay(rays[index], hits[index], scene,
+					scene.backgroundRefractionIndex, depth);
+				redSum += std::get<0>(color.ToFloat());
+			}
+		}, hits.size());
+
+		report("Depth " + std::to_string(depth), shade, std::to_string(redSum / static_cast<float>(hits.size()))
+			+ " red on average");
+	}
+}
+
+static void
+bench_texture_lookup(std::size_t textureWidth, std::size_t lookupCount)
+{
+	std::mt19937 generator(5607);
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+	// Texture coordinates outside of [0, 1] are wrapped, so some of them are.
+	std::uniform_real_distribution<float> coordinate(0.f, 4.f);
+
+	const std::size_t pixelCount = textureWidth * textureWidth;
+	auto pixels = std::make_unique<ColorRGB[]>(pixelCount);
+	for (std::size_t index = 0; index < pixelCount; index++)
+		pixels[index] = ColorRGB(unit(generator), unit(generator), unit(generator));
+
+	Texture texture;
+	texture.SetPixelSize(Size{ static_cast<uint32_t>(textureWidth), static_cast<uint32_t>(textureWidth) });
+	texture.MovePixelsIntoTexture(std::move(pixels), pixelCount);
+
+	std::vector<float> us(lookupCount);
+	std::vector<float> vs(lookupCount);
+	for (std::size_t index = 0; index < lookupCount; index++) {
+		us[index] = coordinate(generator);
+		vs[index] = coordinate(generator);
+	}
+
+	std::size_t found = 0;
+	const Measurement lookup = measure([&]() {
+		found = 0;
+		ColorRGB pixel;
+		for (std::size_t index = 0; index < lookupCount; index++)
+			found += texture.GetPixelWithTextureCoordinate(us[index], vs[index], pixel);
+	}, lookupCount);
+
+	std::cout << "Texture::GetPixelWithTextureCoordinate (" << textureWidth << "x" << textureWidth << " texture, "
+		<< lookupCount << " lookups)" << std::endl;
+	report("Nearest neighbour", lookup, std::to_string(found) + " found");
+}
+
+static void
+bench_vector_ops(std::size_t vectorCount, std::size_t /*unused*/)
+{
+	std::mt19937 generator(5607);
+	std::uniform_real_distribution<float> component(-10.f, 10.f);
+
+	std::vector<Vector3D> vectors(vectorCount);
+	for (Vector3D& vector : vectors)
+		vector = Vector3D(component(generator), component(generator), component(generator));
+
+	// The last vector pairs up with the first, so there are as many pairs as vectors.
+	auto next = [&](std::size_t index) -> const Vector3D& { return vectors[(index + 1) % vectorCount]; };
+
+	float dotSum = 0.f;
+	const Measurement dot = measure([&]() {
+		dotSum = 0.f;
+		for (std::size_t index = 0; index < vectorCount; index++)
+			dotSum += vectors[index].DotProduct(next(index));
+	}, vectorCount);
+
+	float crossSum = 0.f;
+	const Measurement cross = measure([&]() {
+		crossSum = 0.f;
+		for (std::size_t index = 0; index < vectorCount; index++)
+			crossSum += vectors[index].CrossProduct(next(index)).dz;
+	}, vectorCount);
+
+	float normalizeSum = 0.f;
+	const Measurement normalize = measure([&]() {
+		normalizeSum = 0.f;
+		for (std::size_t index = 0; index < vectorCount; index++)
+			normalizeSum += vectors[index].Normalize().dx;
+	}, vectorCount);
+
+	std::cout << "Vector3D (" << vectorCount << " vectors)" << std::endl;
+	report("DotProduct", dot, "sum " + std::to_string(dotSum));
+	report("CrossProduct", cross, "sum " + std::to_string(crossSum));
+	report("Normalize", normalize, "sum " + std::to_string(normalizeSum));
+}
+
+static void
+bench_scene_parser(std::size_t primitiveCount, std::size_t /*unused*/)
+{
+	const std::string sceneText = synthetic_scene(primitiveCount, 4);
+	std::ostream quiet(nullptr);
+	std::cout.setstate(std::ios_base::badbit);
+
+	bool parsed = false;
+	const Measurement parse = measure([&]() {
+		std::istringstream input(sceneText);
+		SceneDefinition scene;
+		InputFileParser parser;
+		parsed = parser.Parse(input, scene);
+	}, primitiveCount);
+
+	bool loaded = false;
+	const Measurement load = measure([&]() {
+		SceneDefinition scene;
+		loaded = SceneLoader::LoadText(sceneText, std::filesystem::temp_directory_path(), scene, quiet);
+	}, primitiveCount);
+	std::cout.clear();
+
+	std::cout << "Scene parser (" << primitiveCount << " primitives, " << sceneText.size() << " bytes)" << std::endl;
+	report("InputFileParser::Parse, per primitive", parse, parsed ? "parsed" : "FAILED");
+	report("SceneLoader::LoadText, per primitive", load, loaded ? "loaded" : "FAILED");
+}
+
+static void
+bench_ppm_writer(std::size_t imageWidth, std::size_t /*unused*/)
+{
+	std::mt19937 generator(5607);
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+	const Size imageSize{ static_cast<uint32_t>(imageWidth), static_cast<uint32_t>(imageWidth) };
+	Framebuffer framebuffer(imageSize);
+	for (uint32_t y = 0; y < imageSize.height; y++) {
+		for (uint32_t x = 0; x < imageSize.width; x++)
+			framebuffer(x, y) = ColorRGB(unit(generator), unit(generator), unit(generator));
+	}
+
+	// Only formatting the pixels is timed, not how fast the disk is.
+	PPMWriter writer{};
+	writer.outputFile = fopen("/dev/null", "w");
+	if (writer.outputFile == nullptr) {
+		std::cerr << "(Error) Failed to open /dev/null for writing!" << std::endl;
+		return;
+	}
+	ppm_writer_set_image_size(&writer, imageSize);
+
+	bool written = false;
+	const Measurement write = measure([&]() {
+		written = ppm_writer_write(&writer, framebuffer);
+		fflush(writer.outputFile);
+	}, framebuffer.PixelCount());
+	ppm_writer_close(&writer);
+
+	std::cout << "ppm_writer_write (" << imageWidth << "x" << imageWidth << " image)" << std::endl;
+	report("Per pixel", write, written ? "written" : "FAILED");
+}
+
+// A benchmark that can be picked from the command line, with what its size and count mean, and what they are when
+// they aren't given.
+struct Kernel {
+	const char* name;
+	void (*run)(std::size_t size, std::size_t count);
+	const char* sizeMeaning;
+	std::size_t defaultSize;
+	const char* countMeaning;
+	std::size_t defaultCount;
+};
+
+static constexpr Kernel kKernels[] = {
+	{ "triangle", bench_triangle_intersect, "triangles", 16384, "rays", 128 },
+	{ "sphere", bench_sphere_intersect, "spheres", 131072, "rays", 16 },
+	{ "shadow", bench_calculate_shadow, "primitives in the scene", 10000, "rays from the eye", 16384 },
+	{ "shade", bench_shade_with_ray, "primitives in the scene", 10000, "rays from the eye", 16384 },
+	{ "texture", bench_texture_lookup, "texture width", 512, "lookups", 1 << 20 },
+	{ "vector", bench_vector_ops, "vectors", 1 << 20, "(unused)", 0 },
+	{ "parser", bench_scene_parser, "primitives in the scene", 100000, "(unused)", 0 },
+	{ "ppm", bench_ppm_writer, "image width", 512, "(unused)", 0 },
+};
+
+static void
+print_usage(const char* programName)
+{
+	std::cerr << "Usage: " << programName << " [<kernel> [<size> [<count>]]]" << std::endl;
+	std::cerr << "Kernels:" << std::endl;
+	for (const Kernel& kernel : kKernels) {
+		std::cerr << "\t" << kernel.name << "\t<size>: " << kernel.sizeMeaning << " (default: " << kernel.defaultSize
+			<< "), <count>: " << kernel.countMeaning;
+		if (kernel.defaultCount > 0)
+			std::cerr << " (default: " << kernel.defaultCount << ")";
+		std::cerr << std::endl;
+	}
+}
+
+int
+main(int argc, char* argv[])
+{
+	if (argc > 1) {
+		const std::string name = argv[1];
+		const Kernel* kernel = std::find_if(std::begin(kKernels), std::end(kKernels),
+			[&](const Kernel& candidate) { return name == candidate.name; });
+		if (kernel == std::end(kKernels) || argc > 4) {
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+
+		const std::size_t size = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : kernel->defaultSize;
+		const std::size_t count = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : kernel->defaultCount;
+		if (size == 0 || (kernel->defaultCount > 0 && count == 0)) {
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+
+		kernel->run(size, count);
+		return EXIT_SUCCESS;
+	}
+
+	// Once with everything fitting in cache, and once with the triangles having to come from memory.
+	bench_triangle_intersect(64, 32768);
+	bench_triangle_intersect(16384, 128);
+
+	// Same for spheres, with the second being a particle sized scene.
+	bench_sphere_intersect(64, 32768);
+	bench_sphere_intersect(131072, 16);
+
+	for (const Kernel& kernel : kKernels) {
+		if (kernel.run != bench_triangle_intersect && kernel.run != bench_sphere_intersect)
+			kernel.run(kernel.defaultSize, kernel.defaultCount);
+	}
+
+	return EXIT_SUCCESS;
+}
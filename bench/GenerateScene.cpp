@@ -0,0 +1,57 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "SceneGenerator.hpp"
+
+static void
+print_usage(const char* programName)
+{
+	std::cerr << "Usage: " << programName << " [options] <kind> <primitive count> <Path to write scene to>" << std::endl;
+	std::cerr << "Kinds:" << std::endl;
+	std::cerr << "\tspheres\tSpheres scattered through a cube" << std::endl;
+	std::cerr << "\tmesh\tA rippled, textured sheet of smooth shaded triangles" << std::endl;
+	std::cerr << "\tlights\tSpheres on a floor, lit by up to 64 point lights" << std::endl;
+	std::cerr << "\tglass\tStacks of 8 see-through spheres in front of a textured wall" << std::endl;
+	std::cerr << "Options:" << std::endl;
+	std::cerr << "\t--image-size <n>\tRender an n by n image (default: 256)" << std::endl;
+	std::cerr << "\t--seed <n>\tMake the scene up from random seed n (default: 5607)" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+	SceneGenerator::Options options{ SceneGenerator::Kind::SPHERES, 0, Size{ 256, 256 }, 5607 };
+
+	int argument = 1;
+	for (; argument + 1 < argc && std::string(argv[argument]).starts_with("--"); argument += 2) {
+		const std::string option = argv[argument];
+		const unsigned long value = std::strtoul(argv[argument + 1], nullptr, 10);
+		if (option == "--image-size" && value > 0) {
+			options.imageSize = Size{ static_cast<uint32_t>(value), static_cast<uint32_t>(value) };
+		} else if (option == "--seed") {
+			options.seed = static_cast<uint32_t>(value);
+		} else {
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (argc - argument != 3) {
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const std::optional<SceneGenerator::Kind> kind = SceneGenerator::KindNamed(argv[argument]);
+	options.primitiveCount = std::strtoull(argv[argument + 1], nullptr, 10);
+	if (!kind || options.primitiveCount == 0) {
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	options.kind = *kind;
+	return SceneGenerator::Write(argv[argument + 2], options) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,366 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "JsonWriter.hpp"
+#include "SceneGenerator.hpp"
+#include "core/RayStats.hpp"
+
+// One render of a generated scene.
+struct ScalingRun {
+	SceneGenerator::Kind kind;
+	uint64_t primitiveCount;
+	uint64_t sceneBytes;
+	uint32_t threadCount;
+	bool succeeded;
+	double wallSeconds;
+	long peakRssKilobytes;
+	uint64_t rayCount;
+
+	// Compared with the run of the same scene with the fewest threads.
+	double speedup;
+	double parallelEfficiency;
+};
+
+// Everything about the benchmark that comes from the command line.
+struct ScalingOptions {
+	std::vector<SceneGenerator::Kind> kinds;
+	std::vector<uint64_t> sizes;
+	std::vector<uint64_t> threadCounts;
+	uint32_t imageWidth;
+	std::filesystem::path directory;
+	std::filesystem::path rendererPath;
+	std::filesystem::path outputPath;
+};
+
+// Description: Parses 'argument', whole numbers separated by commas, into 'values'.
+// Returns: false if any of them isn't a positive whole number.
+static bool
+parse_number_list(std::string_view argument, std::vector<uint64_t>& values)
+{
+	values.clear();
+	while (!argument.empty()) {
+		const std::size_t comma = argument.find(',');
+		const std::string number(argument.substr(0, comma));
+		char* end = nullptr;
+		const uint64_t value = std::strtoull(number.c_str(), &end, 10);
+		if (number.empty() || *end != '\0' || value == 0)
+			return false;
+
+		values.push_back(value);
+		argument = comma == std::string_view::npos ? std::string_view() : argument.substr(comma + 1);
+	}
+
+	return !values.empty();
+}
+
+// Description: Parses 'argument', names of kinds of scenes separated by commas, into 'kinds'.
+// Returns: false if any of them isn't the name of a kind of scene.
+static bool
+parse_kind_list(std::string_view argument, std::vector<SceneGenerator::Kind>& kinds)
+{
+	kinds.clear();
+	while (!argument.empty()) {
+		const std::size_t comma = argument.find(',');
+		const std::optional<SceneGenerator::Kind> kind = SceneGenerator::KindNamed(argument.substr(0, comma));
+		if (!kind)
+			return false;
+
+		kinds.push_back(*kind);
+		argument = comma == std::string_view::npos ? std::string_view() : argument.substr(comma + 1);
+	}
+
+	return !kinds.empty();
+}
+
+// Description: Returns 1, 2, 4, and so on up to the number of cores, and the number of cores itself.
+static std::vector<uint64_t>
+default_thread_counts()
+{
+	const uint64_t coreCount = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<uint64_t> threadCounts;
+	for (uint64_t threadCount = 1; threadCount < coreCount; threadCount *= 2)
+		threadCounts.push_back(threadCount);
+	threadCounts.push_back(coreCount);
+
+	return threadCounts;
+}
+
+// Description: Returns the directory this program is in, where raytracer1d is built alongside it.
+static std::filesystem::path
+program_directory(const char* programName)
+{
+	std::error_code error;
+	std::filesystem::path path = std::filesystem::read_symlink("/proc/self/exe", error);
+	if (error)
+		path = std::filesystem::absolute(programName);
+
+	return path.parent_path();
+}
+
+// Description: Renders the scene at 'scenePath' with the renderer at 'rendererPath', using 'threadCount' threads,
+// with what it prints out thrown away. The rays it traced are written to 'statsPath', if it counts them.
+// Returns: true if it rendered the scene, along with how long it took and the most memory it used at once.
+static bool
+run_renderer(const std::filesystem::path& rendererPath, const std::filesystem::path& scenePath, uint64_t threadCount,
+	const std::filesystem::path& statsPath, double& wallSeconds, long& peakRssKilobytes)
+{
+	const std::string renderer = rendererPath.string();
+	const std::string scene = scenePath.string();
+	const std::string stats = statsPath.string();
+	const std::string threads = std::to_string(threadCount);
+
+	const auto startTime = std::chrono::steady_clock::now();
+	const pid_t processID = fork();
+	if (processID < 0) {
+		std::cerr << "(Error) Couldn't start the renderer: " << std::strerror(errno) << std::endl;
+		return false;
+	}
+
+	if (processID == 0) {
+		setenv("OMP_NUM_THREADS", threads.c_str(), 1);
+
+		const int devNull = open("/dev/null", O_WRONLY);
+		if (devNull >= 0)
+			dup2(devNull, STDOUT_FILENO);
+
+		if (RayStats::kEnabled)
+			execl(renderer.c_str(), renderer.c_str(), "--stats", stats.c_str(), scene.c_str(), static_cast<char*>(nullptr));
+		else
+			execl(renderer.c_str(), renderer.c_str(), scene.c_str(), static_cast<char*>(nullptr));
+
+		std::cerr << "(Error) Couldn't run the renderer " << renderer << ": " << std::strerror(errno) << std::endl;
+		_exit(EXIT_FAILURE);
+	}
+
+	int status = 0;
+	rusage usage{};
+	if (wait4(processID, &status, 0, &usage) < 0) {
+		std::cerr << "(Error) Couldn't wait for the renderer: " << std::strerror(errno) << std::endl;
+		return false;
+	}
+
+	wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	peakRssKilobytes = usage.ru_maxrss;
+	return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+
+// Description: Reads how many rays were traced out of the JSON the renderer wrote to 'statsPath' with --stats.
+// Returns: false if it couldn't be found.
+static bool
+read_ray_count(const std::filesystem::path& statsPath, uint64_t& rayCount)
+{
+	std::ifstream statsFile(statsPath);
+	const std::string stats((std::istreambuf_iterator<char>(statsFile)), std::istreambuf_iterator<char>());
+
+	static constexpr std::string_view kKey = "\"totalRays\": ";
+	const std::size_t keyIndex = stats.find(kKey);
+	if (keyIndex == std::string::npos)
+		return false;
+
+	rayCount = std::strtoull(stats.c_str() + keyIndex + kKey.size(), nullptr, 10);
+	return true;
+}
+
+// Description: Works out the speedup and parallel efficiency of each of 'runs', all of the same scene, compared with
+// the one with the fewest threads.
+static void
+compare_runs(std::vector<ScalingRun>& runs)
+{
+	const ScalingRun* baseline = nullptr;
+	for (const ScalingRun& run : runs) {
+		if (run.succeeded && (baseline == nullptr || run.threadCount < baseline->threadCount))
+			baseline = &run;
+	}
+
+	if (baseline == nullptr)
+		return;
+
+	const double baselineSeconds = baseline->wallSeconds;
+	const double baselineThreads = baseline->threadCount;
+	for (ScalingRun& run : runs) {
+		if (!run.succeeded)
+			continue;
+
+		run.speedup = baselineSeconds / run.wallSeconds;
+		run.parallelEfficiency = run.speedup * baselineThreads / static_cast<double>(run.threadCount);
+	}
+}
+
+static bool
+write_results(const ScalingOptions& options, const std::vector<ScalingRun>& runs)
+{
+	std::ofstream resultsFile(options.outputPath);
+	if (resultsFile.fail()) {
+		std::cerr << "(Error) Failed to open the results for writing at path: " << options.outputPath << std::endl;
+		return false;
+	}
+
+	JsonWriter json(resultsFile);
+	json.BeginObject();
+	json.Field("renderer", options.rendererPath.string());
+	json.Field("hardwareThreads", std::thread::hardware_concurrency());
+	json.Field("imageWidth", options.imageWidth);
+	json.Field("imageHeight", options.imageWidth);
+
+	// Only a renderer built with RAYTRACER_STATS counts every ray, and without it only the rays from the eye are known.
+	json.Field("raysCounted", RayStats::kEnabled ? "all" : "primary");
+
+	json.Key("runs");
+	json.BeginArray();
+	for (const ScalingRun& run : runs) {
+		json.BeginObject();
+		json.Field("kind", SceneGenerator::KindName(run.kind));
+		json.Field("primitives", run.primitiveCount);
+		json.Field("sceneBytes", run.sceneBytes);
+		json.Field("threads", run.threadCount);
+		json.Field("succeeded", run.succeeded);
+		json.Field("wallSeconds", run.wallSeconds);
+		json.Field("peakRssKilobytes", static_cast<int64_t>(run.peakRssKilobytes));
+		json.Field("rays", run.rayCount);
+		json.Field("raysPerSecond", run.succeeded ? static_cast<double>(run.rayCount) / run.wallSeconds : 0.0);
+		json.Field("speedup", run.speedup);
+		json.Field("parallelEfficiency", run.parallelEfficiency);
+		json.EndObject();
+	}
+	json.EndArray();
+	json.EndObject();
+
+	resultsFile.close();
+	return !resultsFile.fail();
+}
+
+static void
+print_usage(const char* programName)
+{
+	std::cerr << "Usage: " << programName << " [options]" << std::endl;
+	std::cerr << "Options:" << std::endl;
+	std::cerr << "\t--kinds <kind>,...\tThe kinds of scenes to generate, of spheres, mesh, lights, and glass (default: all of them)" << std::endl;
+	std::cerr << "\t--sizes <n>,...\tHow many primitives to generate each kind of scene with (default: 100,1000,10000,100000)" << std::endl;
+	std::cerr << "\t--threads <n>,...\tHow many threads to render each scene with (default: 1, 2, 4, and so on up to one per core)" << std::endl;
+	std::cerr << "\t--image-size <n>\tRender n by n images (default: 256)" << std::endl;
+	std::cerr << "\t--directory <path>\tWhere to generate the scenes, and render them to (default: raytracer-scaling in the temporary directory)" << std::endl;
+	std::cerr << "\t--renderer <path>\tThe raytracer1d to run (default: the one built next to this program)" << std::endl;
+	std::cerr << "\t--output <path>\tWhere to write out the results, as JSON (default: scaling.json)" << std::endl;
+}
+
+static bool
+parse_options(int argc, char* argv[], ScalingOptions& options)
+{
+	options.kinds = { SceneGenerator::Kind::SPHERES, SceneGenerator::Kind::MESH, SceneGenerator::Kind::LIGHTS,
+		SceneGenerator::Kind::GLASS };
+	options.sizes = { 100, 1000, 10000, 100000 };
+	options.threadCounts = default_thread_counts();
+	options.imageWidth = 256;
+	options.directory = std::filesystem::temp_directory_path() / "raytracer-scaling";
+	options.rendererPath = program_directory(argv[0]) / "raytracer1d";
+	options.outputPath = "scaling.json";
+
+	for (int index = 1; index < argc; index += 2) {
+		const std::string_view option = argv[index];
+		if (index + 1 >= argc)
+			return false;
+
+		const std::string_view value = argv[index + 1];
+		std::vector<uint64_t> imageWidth;
+		if (option == "--kinds" && parse_kind_list(value, options.kinds))
+			continue;
+		if (option == "--sizes" && parse_number_list(value, options.sizes))
+			continue;
+		if (option == "--threads" && parse_number_list(value, options.threadCounts))
+			continue;
+		if (option == "--image-size" && parse_number_list(value, imageWidth) && imageWidth.size() == 1) {
+			options.imageWidth = static_cast<uint32_t>(imageWidth.front());
+			continue;
+		}
+		if (option == "--directory" || option == "--renderer" || option == "--output") {
+			(option == "--directory" ? options.directory : option == "--renderer" ? options.rendererPath
+				: options.outputPath) = value;
+			continue;
+		}
+
+		return false;
+	}
+
+	return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+	ScalingOptions options;
+	if (!parse_options(argc, argv, options)) {
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(options.directory, error);
+	if (error) {
+		std::cerr << "(Error) Failed to create the directory at path: " << options.directory << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const std::filesystem::path statsPath = options.directory / "stats.json";
+
+	bool allSucceeded = true;
+	std::vector<ScalingRun> runs;
+	for (SceneGenerator::Kind kind : options.kinds) {
+		for (uint64_t size : options.sizes) {
+			const std::filesystem::path scenePath = options.directory
+				/ (std::string(SceneGenerator::KindName(kind)) + "-" + std::to_string(size) + ".txt");
+
+			const SceneGenerator::Options sceneOptions{ kind, size, Size{ options.imageWidth, options.imageWidth }, 5607 };
+			std::cout << "=== " << scenePath.filename().string() << " ===" << std::endl;
+			if (!SceneGenerator::Write(scenePath, sceneOptions))
+				return EXIT_FAILURE;
+
+			const uint64_t sceneBytes = std::filesystem::file_size(scenePath, error);
+
+			std::vector<ScalingRun> sceneRuns;
+			for (uint64_t threadCount : options.threadCounts) {
+				ScalingRun run{ kind, size, sceneBytes, static_cast<uint32_t>(threadCount), false, 0.0, 0, 0, 0.0, 0.0 };
+
+				std::filesystem::remove(statsPath, error);
+				run.succeeded = run_renderer(options.rendererPath, scenePath, threadCount, statsPath, run.wallSeconds,
+					run.peakRssKilobytes);
+
+				// Without counting, every pixel's ray from the eye is the only ray known to have been traced.
+				run.rayCount = static_cast<uint64_t>(options.imageWidth) * options.imageWidth;
+				if (RayStats::kEnabled && run.succeeded)
+					run.succeeded = read_ray_count(statsPath, run.rayCount);
+
+				std::cout << "\t" << threadCount << " threads: " << (run.succeeded ? "" : "FAILED, ")
+					<< run.wallSeconds << "s, " << (static_cast<double>(run.rayCount) / run.wallSeconds)
+					<< " rays/s, peak RSS " << run.peakRssKilobytes << " KiB" << std::endl;
+
+				allSucceeded = allSucceeded && run.succeeded;
+				sceneRuns.push_back(run);
+			}
+
+			compare_runs(sceneRuns);
+			runs.insert(runs.end(), sceneRuns.begin(), sceneRuns.end());
+		}
+	}
+
+	if (!write_results(options, runs))
+		return EXIT_FAILURE;
+
+	std::cout << "Results written to: " << options.outputPath.string() << std::endl;
+	return allSucceeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
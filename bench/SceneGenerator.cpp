@@ -0,0 +1,318 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "SceneGenerator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string_view>
+
+#include "TextureCache.hpp"
+#include "core/Point.hpp"
+#include "core/Vector3D.hpp"
+
+/* Scene Writers */
+
+// Description: Writes out the camera, image size, and background color of a scene to 'out', with the eye at 'eye'
+// looking along 'viewDirection'.
+static void
+write_camera(std::ostream& out, const Point3D& eye, const Vector3D& viewDirection, float verticalFov, const Size& imageSize)
+{
+	out << "eye " << eye.x << " " << eye.y << " " << eye.z << "\n";
+	out << "viewdir " << viewDirection.dx << " " << viewDirection.dy << " " << viewDirection.dz << "\n";
+	out << "updir 0 1 0\n";
+	out << "vfov " << verticalFov << "\n";
+	out << "imsize " << imageSize.width << " " << imageSize.height << "\n\n";
+	out << "bkgcolor 0.1 0.1 0.15 1\n\n";
+}
+
+// Description: Writes out an opaque material of a random color to 'out'.
+static void
+write_opaque_material(std::ostream& out, std::mt19937& generator)
+{
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+	out << "\nmtlcolor " << unit(generator) << " " << unit(generator) << " " << unit(generator)
+		<< " 1 1 1 0.1 0.7 0.2 20 1 1\n";
+}
+
+static void
+write_spheres(std::ostream& out, const SceneGenerator::Options& options, std::mt19937& generator)
+{
+	// However many spheres there are, they're about as far apart from each other.
+	const auto count = static_cast<double>(std::max<uint64_t>(options.primitiveCount, 1));
+	const float halfExtent = std::max(2.f, static_cast<float>(10.0 * std::cbrt(count / 1000.0)));
+	const float spacing = 2.f * halfExtent / static_cast<float>(std::cbrt(count));
+
+	std::uniform_real_distribution<float> position(-halfExtent, halfExtent);
+	std::uniform_real_distribution<float> radius(0.2f * spacing, 0.4f * spacing);
+
+	write_camera(out, Point3D(0.f, 0.f, -3.5f * halfExtent), Vector3D(0.f, 0.f, 1.f), 45.f, options.imageSize);
+	out << "light -1 -1 1 0 0.7 0.7 0.7\n";
+	out << "light " << halfExtent << " " << halfExtent << " " << (-2.f * halfExtent) << " 1 0.5 0.5 0.5\n";
+
+	for (uint64_t sphere = 0; sphere < options.primitiveCount; sphere++) {
+		if (sphere % 64 == 0)
+			write_opaque_material(out, generator);
+
+		out << "sphere " << position(generator) << " " << position(generator) << " " << position(generator) << " "
+			<< radius(generator) << "\n";
+	}
+}
+
+static void
+write_mesh(std::ostream& out, const SceneGenerator::Options& options, std::mt19937& generator)
+{
+	// Each square of the grid is two triangles.
+	const auto squaresPerSide = static_cast<uint64_t>(std::max(1.0,
+		std::round(std::sqrt(static_cast<double>(options.primitiveCount) / 2.0))));
+	const uint64_t verticesPerSide = squaresPerSide + 1;
+
+	// The squares stay the same size, and the sheet grows with them, as the parser skips triangles that are too small.
+	static constexpr float kSquareWidth = 0.5f;
+	static constexpr float kAmplitude = 0.8f;
+	static constexpr float kFrequency = 0.6f;
+	const float halfExtent = kSquareWidth * static_cast<float>(squaresPerSide) / 2.f;
+
+	write_camera(out, Point3D(0.f, 1.2f * halfExtent, -1.8f * halfExtent), Vector3D(0.f, -0.55f, 1.f).Normalize(), 50.f,
+		options.imageSize);
+	out << "light 0.3 -1 0.5 0 0.7 0.7 0.7\n";
+	out << "light " << (-0.6f * halfExtent) << " " << (0.8f * halfExtent) << " " << (-0.6f * halfExtent)
+		<< " 1 0.4 0.4 0.4\n";
+
+	write_opaque_material(out, generator);
+	out << "texture " << SceneGenerator::kTextureName << "\n\n";
+
+	// The sheet ripples up and down, so that its normals, and so its shading, vary across it.
+	for (uint64_t row = 0; row < verticesPerSide; row++) {
+		for (uint64_t column = 0; column < verticesPerSide; column++) {
+			const float u = static_cast<float>(column) / static_cast<float>(squaresPerSide);
+			const float v = static_cast<float>(row) / static_cast<float>(squaresPerSide);
+			const float x = (u * 2.f - 1.f) * halfExtent;
+			const float z = (v * 2.f - 1.f) * halfExtent;
+			const float y = kAmplitude * std::sin(x * kFrequency) * std::cos(z * kFrequency);
+
+			const float slopeX = kAmplitude * kFrequency * std::cos(x * kFrequency) * std::cos(z * kFrequency);
+			const float slopeZ = -kAmplitude * kFrequency * std::sin(x * kFrequency) * std::sin(z * kFrequency);
+			const Vector3D normal = Vector3D(-slopeX, 1.f, -slopeZ).Normalize();
+
+			out << "v " << x << " " << y << " " << z << "\n";
+			out << "vn " << normal.dx << " " << normal.dy << " " << normal.dz << "\n";
+			out << "vt " << (u * 4.f) << " " << (v * 4.f) << "\n";
+		}
+	}
+
+	// Vertices, normals, and texture coordinates all line up, so one index picks all three.
+	const auto writeCorner = [&](uint64_t row, uint64_t column) {
+		const uint64_t index = (row * verticesPerSide) + column + 1;
+		out << " " << index << "/" << index << "/" << index;
+	};
+
+	for (uint64_t row = 0; row < squaresPerSide; row++) {
+		for (uint64_t column = 0; column < squaresPerSide; column++) {
+			out << "f";
+			writeCorner(row, column);
+			writeCorner(row, column + 1);
+			writeCorner(row + 1, column + 1);
+			out << "\nf";
+			writeCorner(row, column);
+			writeCorner(row + 1, column + 1);
+			writeCorner(row + 1, column);
+			out << "\n";
+		}
+	}
+}
+
+static void
+write_lights(std::ostream& out, const SceneGenerator::Options& options, std::mt19937& generator)
+{
+	// The spheres only spread out across the floor, so it grows with the square root of how many there are.
+	const auto count = static_cast<double>(std::max<uint64_t>(options.primitiveCount, 1));
+	const float halfExtent = std::max(3.f, static_cast<float>(10.0 * std::sqrt(count / 1000.0)));
+	const float spacing = 2.f * halfExtent / static_cast<float>(std::sqrt(count));
+
+	std::uniform_real_distribution<float> position(-halfExtent, halfExtent);
+	std::uniform_real_distribution<float> radius(0.15f * spacing, 0.35f * spacing);
+
+	write_camera(out, Point3D(0.f, 1.2f * halfExtent, -1.6f * halfExtent), Vector3D(0.f, -0.6f, 1.f).Normalize(), 50.f,
+		options.imageSize);
+
+	// Every light is dimmer the more of them there are, so the scene's about as bright however many there are.
+	const auto lightCount = static_cast<uint32_t>(std::clamp(std::round(std::sqrt(count) / 2.0), 4.0, 64.0));
+	const float brightness = std::min(1.f, 2.f / static_cast<float>(lightCount));
+	for (uint32_t light = 0; light < lightCount; light++) {
+		const float angle = 2.f * static_cast<float>(M_PI) * static_cast<float>(light) / static_cast<float>(lightCount);
+		out << "light " << (0.8f * halfExtent * std::cos(angle)) << " " << (0.5f * halfExtent) << " "
+			<< (0.8f * halfExtent * std::sin(angle)) << " 1 " << brightness << " " << brightness << " " << brightness
+			<< "\n";
+	}
+
+	// The floor
+	out << "\nmtlcolor 0.8 0.8 0.8 1 1 1 0.1 0.8 0.1 10 1 1\n";
+	const float floorExtent = halfExtent * 1.5f;
+	out << "v " << -floorExtent << " 0 " << -floorExtent << "\n";
+	out << "v " << floorExtent << " 0 " << -floorExtent << "\n";
+	out << "v " << floorExtent << " 0 " << floorExtent << "\n";
+	out << "v " << -floorExtent << " 0 " << floorExtent << "\n";
+	out << "f 1 3 2\nf 1 4 3\n";
+
+	for (uint64_t sphere = 0; sphere < options.primitiveCount; sphere++) {
+		if (sphere % 64 == 0)
+			write_opaque_material(out, generator);
+
+		const float sphereRadius = radius(generator);
+		out << "sphere " << position(generator) << " " << sphereRadius << " " << position(generator) << " "
+			<< sphereRadius << "\n";
+	}
+}
+
+static void
+write_glass(std::ostream& out, const SceneGenerator::Options& options, std::mt19937& generator)
+{
+	// Every ray through a stack is refracted by each sphere in it, one after another.
+	static constexpr uint64_t kStackDepth = 8;
+	static constexpr float kColumnSpacing = 2.f;
+	static constexpr float kRadius = 0.9f;
+
+	const auto columnsPerSide = static_cast<uint64_t>(std::max(1.0,
+		std::round(std::sqrt(static_cast<double>(options.primitiveCount) / kStackDepth))));
+	const float halfExtent = static_cast<float>(columnsPerSide) * kColumnSpacing / 2.f;
+	const float wallDepth = static_cast<float>(kStackDepth) * kColumnSpacing + 2.f;
+
+	std::uniform_real_distribution<float> tint(0.6f, 1.f);
+	std::uniform_real_distribution<float> jitter(-0.05f, 0.05f);
+
+	write_camera(out, Point3D(0.f, 0.f, -2.8f * halfExtent - 2.f), Vector3D(0.f, 0.f, 1.f), 45.f, options.imageSize);
+	out << "light 0.2 -0.3 1 0 0.6 0.6 0.6\n";
+	out << "light 0 " << halfExtent << " " << -halfExtent << " 1 0.5 0.5 0.5\n";
+
+	for (uint64_t column = 0; column < columnsPerSide * columnsPerSide; column++) {
+		const float x = (static_cast<float>(column % columnsPerSide) + 0.5f) * kColumnSpacing - halfExtent;
+		const float y = (static_cast<float>(column / columnsPerSide) + 0.5f) * kColumnSpacing - halfExtent;
+
+		// Alternate between glass and water, so neighbouring stacks bend light differently.
+		out << "\nmtlcolor " << tint(generator) << " " << tint(generator) << " " << tint(generator)
+			<< " 1 1 1 0.1 0.5 0.4 60 0.25 " << (column % 2 == 0 ? 1.5f : 1.33f) << "\n";
+		for (uint64_t layer = 0; layer < kStackDepth; layer++) {
+			out << "sphere " << (x + jitter(generator)) << " " << (y + jitter(generator)) << " "
+				<< (static_cast<float>(layer) * kColumnSpacing) << " " << kRadius << "\n";
+		}
+	}
+
+	// The wall behind the stacks, textured so that what's seen through them is visibly bent.
+	const float wallExtent = halfExtent * 1.5f + 1.f;
+	out << "\nmtlcolor 1 1 1 1 1 1 0.2 0.8 0.0 1 1 1\n";
+	out << "texture " << SceneGenerator::kTextureName << "\n";
+	out << "v " << -wallExtent << " " << -wallExtent << " " << wallDepth << "\n";
+	out << "v " << wallExtent << " " << -wallExtent << " " << wallDepth << "\n";
+	out << "v " << wallExtent << " " << wallExtent << " " << wallDepth << "\n";
+	out << "v " << -wallExtent << " " << wallExtent << " " << wallDepth << "\n";
+	out << "vt 0 0\nvt 4 0\nvt 4 4\nvt 0 4\n";
+	out << "f 1/1 2/2 3/3\nf 1/1 3/3 4/4\n";
+}
+
+
+/* SceneGenerator */
+
+std::optional<SceneGenerator::Kind>
+SceneGenerator::KindNamed(std::string_view name)
+{
+	for (Kind kind : { Kind::SPHERES, Kind::MESH, Kind::LIGHTS, Kind::GLASS }) {
+		if (name == KindName(kind))
+			return kind;
+	}
+
+	return {};
+}
+
+const char*
+SceneGenerator::KindName(Kind kind)
+{
+	switch (kind) {
+		case Kind::SPHERES:
+			return "spheres";
+		case Kind::MESH:
+			return "mesh";
+		case Kind::LIGHTS:
+			return "lights";
+		case Kind::GLASS:
+			return "glass";
+	}
+
+	return "unknown";
+}
+
+bool
+SceneGenerator::Write(const std::filesystem::path& scenePath, const Options& options)
+{
+	std::ofstream sceneFile(scenePath);
+	if (sceneFile.fail()) {
+		std::cerr << "(Error) Failed to open the scene for writing at path: " << scenePath << std::endl;
+		return false;
+	}
+
+	sceneFile << "# " << KindName(options.kind) << " scene of about " << options.primitiveCount
+		<< " primitives, generated from seed " << options.seed << "\n\n";
+
+	std::mt19937 generator(options.seed);
+	bool needsTexture = false;
+	switch (options.kind) {
+		case Kind::SPHERES:
+			write_spheres(sceneFile, options, generator);
+			break;
+		case Kind::MESH:
+			write_mesh(sceneFile, options, generator);
+			needsTexture = true;
+			break;
+		case Kind::LIGHTS:
+			write_lights(sceneFile, options, generator);
+			break;
+		case Kind::GLASS:
+			write_glass(sceneFile, options, generator);
+			needsTexture = true;
+			break;
+	}
+
+	sceneFile.close();
+	if (sceneFile.fail()) {
+		std::cerr << "(Error) Failed to write out the scene at path: " << scenePath << std::endl;
+		return false;
+	}
+
+	return !needsTexture || WriteTexture_(std::filesystem::absolute(scenePath).parent_path());
+}
+
+bool
+SceneGenerator::WriteTexture_(const std::filesystem::path& sceneDirectory)
+{
+	static constexpr uint32_t kTextureWidth = 64;
+	static constexpr uint32_t kSquareWidth = 8;
+
+	const std::filesystem::path texturePath = TextureCache::TexturePath(sceneDirectory, kTextureName);
+	std::error_code error;
+	std::filesystem::create_directories(texturePath.parent_path(), error);
+	if (error) {
+		std::cerr << "(Error) Failed to create the texture folder at path: " << texturePath.parent_path() << std::endl;
+		return false;
+	}
+
+	std::ofstream textureFile(texturePath);
+	if (textureFile.fail()) {
+		std::cerr << "(Error) Failed to open the texture for writing at path: " << texturePath << std::endl;
+		return false;
+	}
+
+	// Written out by hand rather than with the PPM writer, since textures are read without skipping its comment.
+	static constexpr std::array<std::string_view, 2> kColors = { "230 217 77", "51 77 204" };
+	textureFile << "P3\n" << kTextureWidth << " " << kTextureWidth << "\n255\n";
+	for (uint32_t y = 0; y < kTextureWidth; y++) {
+		for (uint32_t x = 0; x < kTextureWidth; x++)
+			textureFile << kColors[((x / kSquareWidth) + (y / kSquareWidth)) % 2] << "\n";
+	}
+
+	textureFile.close();
+	return !textureFile.fail();
+}
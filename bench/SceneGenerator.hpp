@@ -0,0 +1,65 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef SCENE_GENERATOR_H
+#define SCENE_GENERATOR_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+#include "core/TypeDefinitions.hpp"
+
+/** SceneGenerator */
+
+// Writes out scene definition files of any size, made up from a seeded random number generator, so that how rendering
+// scales with the number of primitives can be measured on scenes far bigger than anyone would write by hand. The same
+// options always write out the same scene.
+class SceneGenerator {
+public:
+	enum struct Kind {
+		// Spheres scattered through a cube, in a handful of opaque materials, lit by two lights.
+		SPHERES,
+
+		// A rippled sheet of smooth shaded, textured triangles, looked down on at an angle.
+		MESH,
+
+		// Spheres resting on a floor, lit by a ring of point lights that grows with the number of spheres.
+		LIGHTS,
+
+		// Stacks of see-through spheres, one behind another, in front of a textured wall.
+		GLASS
+	};
+
+	// What to generate.
+	struct Options {
+		Kind kind;
+
+		// About how many spheres or triangles to write out. Shapes that only come in whole rows or stacks round it.
+		uint64_t primitiveCount;
+
+		Size imageSize;
+		uint32_t seed;
+	};
+
+	// The name of the texture the MESH and GLASS scenes use, which is written to the "texture" folder next to them.
+	static constexpr std::string_view kTextureName = "generated-checker.ppm";
+
+public:
+	SceneGenerator() = delete;
+
+	// Description: Returns the kind of scene called 'name', as it's written on the command line.
+	static std::optional<Kind> KindNamed(std::string_view name);
+
+	// Description: Returns what 'kind' of scene is called on the command line.
+	static const char* KindName(Kind kind);
+
+	// Description: Writes out the scene 'options' asks for to 'scenePath', along with the texture it uses, if any.
+	// Returns: true if everything was written out.
+	static bool Write(const std::filesystem::path& scenePath, const Options& options);
+
+private:
+	static bool WriteTexture_(const std::filesystem::path& sceneDirectory);
+};
+
+#endif // SCENE_GENERATOR_H
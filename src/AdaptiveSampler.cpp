@@ -0,0 +1,286 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "AdaptiveSampler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "core/RayPacket.hpp"
+
+/* Sampling Helpers */
+
+// Description: Scrambles the bits of 'value', so that neighbouring values give unrelated results.
+static uint32_t
+hash_bits(uint32_t value)
+{
+	value ^= value >> 16;
+	value *= 0x7FEB352Du;
+	value ^= value >> 15;
+	value *= 0x846CA68Bu;
+	value ^= value >> 16;
+	return value;
+}
+
+// Description: Returns a number in [0, 1) that only depends on the pixel ('x', 'y'), which of its samples 'sample' is,
+// and 'axis', so that an image is jittered the same way no matter which thread renders which tile.
+static float
+sample_jitter(uint32_t x, uint32_t y, uint32_t sample, uint32_t axis)
+{
+	const uint32_t bits = hash_bits(x ^ hash_bits(y ^ hash_bits((sample << 1) | axis)));
+	return static_cast<float>(bits >> 8) * (1.f / 16777216.f);
+}
+
+// Description: Returns the most any component of 'a' and 'b' differs by.
+static uint8_t
+color_contrast(const ColorRGB& a, const ColorRGB& b)
+{
+	return static_cast<uint8_t>(std::max({ std::abs(a.red - b.red), std::abs(a.green - b.green),
+		std::abs(a.blue - b.blue) }));
+}
+
+
+/* AdaptiveSampler */
+
+AdaptiveSampler::AdaptiveSampler(const CameraRayGenerator& camera, const SceneDefinition& scene, uint32_t depth,
+	uint32_t maxSamples, bool packetTracing, float contrastThreshold, float sampleBudget)
+	:
+	fCamera(camera),
+	fScene(scene),
+	fDepth(depth),
+	fPacketTracing(packetTracing),
+	fStrataPerSide(0),
+	fContrastThreshold(static_cast<uint8_t>(std::clamp(roundf(contrastThreshold * 255.f), 0.f, 255.f))),
+	fSampleBudget(std::max(sampleBudget, 0.f))
+{
+	// A refined pixel keeps its first sample, so the grid gets whatever's left of the maximum.
+	if (maxSamples > 1)
+		fStrataPerSide = static_cast<uint32_t>(std::sqrt(static_cast<float>(maxSamples - 1)));
+}
+
+uint64_t
+AdaptiveSampler::RefineTile(const Tile& tile, ColorRGB* tilePixels, CostHeatmap* heatmap) const
+{
+	if (fStrataPerSide == 0)
+		return 0;
+
+	const std::size_t pixelCount = tile.PixelCount();
+
+	// Every sample the tile is given counts against its budget, including the ones traced just outside it.
+	auto budgetSamples = static_cast<uint64_t>(fSampleBudget * static_cast<float>(pixelCount));
+	uint64_t addedSamples = 0;
+
+	// Find how much each pixel stands out from the pixel to its right, and the one below it. Both pixels of a pair that
+	// contrast are counted, as the edge between them could be in either.
+	std::vector<uint8_t> contrast(pixelCount, 0);
+	for (uint32_t row = 0; row < tile.height; row++) {
+		for (uint32_t column = 0; column < tile.width; column++) {
+			const std::size_t index = (row * tile.width) + column;
+
+			if (column + 1 < tile.width) {
+				const uint8_t difference = color_contrast(tilePixels[index], tilePixels[index + 1]);
+				contrast[index] = std::max(contrast[index], difference);
+				contrast[index + 1] = std::max(contrast[index + 1], difference);
+			}
+
+			if (row + 1 < tile.height) {
+				const uint8_t difference = color_contrast(tilePixels[index], tilePixels[index + tile.width]);
+				contrast[index] = std::max(contrast[index], difference);
+				contrast[index + tile.width] = std::max(contrast[index + tile.width], difference);
+			}
+		}
+	}
+
+	// The pixels on the tile's border are also compared with the ones just outside it, so that an edge lying along the
+	// border is refined on both sides of it, whichever tile each side is in. That's only done if there's budget left
+	// over to refine something with afterwards.
+	std::vector<HaloPixel_> halo = FindHalo_(tile);
+	if (halo.size() < budgetSamples) {
+		TraceHalo_(tile, halo, heatmap);
+		for (const HaloPixel_& pixel : halo)
+			contrast[pixel.borderPixel] = std::max(contrast[pixel.borderPixel],
+				color_contrast(tilePixels[pixel.borderPixel], pixel.color));
+
+		budgetSamples -= halo.size();
+		addedSamples += halo.size();
+	}
+
+	std::vector<std::size_t> candidates;
+	for (std::size_t index = 0; index < pixelCount; index++) {
+		if (contrast[index] > fContrastThreshold)
+			candidates.push_back(index);
+	}
+
+	if (candidates.empty())
+		return addedSamples;
+
+	// Rather than leaving part of an edge running right across the tile unrefined, which takes about two pixels on
+	// every row and column it crosses, each refined pixel is given a coarser grid, down to a single extra sample.
+	const std::size_t edgePixels =
+		std::min(candidates.size(), 2 * (static_cast<std::size_t>(tile.width) + tile.height));
+	uint32_t strataPerSide = fStrataPerSide;
+	while (strataPerSide > 1 && edgePixels * strataPerSide * strataPerSide > budgetSamples)
+		strataPerSide--;
+
+	// If there are still more candidates than the budget allows for, keep the ones that contrast the most.
+	const uint32_t samplesPerPixel = strataPerSide * strataPerSide;
+	const auto affordablePixels = static_cast<std::size_t>(budgetSamples / samplesPerPixel);
+	if (candidates.size() > affordablePixels) {
+		std::nth_element(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(affordablePixels),
+			candidates.end(), [&contrast](std::size_t a, std::size_t b) { return contrast[a] > contrast[b]; });
+		candidates.resize(affordablePixels);
+	}
+
+	std::vector<uint8_t> refine(pixelCount, 0);
+	for (std::size_t index : candidates)
+		refine[index] = 1;
+
+	// Every refined pixel's samples are summed up here, starting with the one it already has.
+	std::vector<std::array<float, 3>> sums(pixelCount);
+	for (std::size_t index = 0; index < pixelCount; index++) {
+		if (refine[index]) {
+			const auto [red, green, blue] = tilePixels[index].ToFloat();
+			sums[index] = { red, green, blue };
+		}
+	}
+
+	// Samples are gathered up until there's enough to fill a packet, which can span more than one pixel.
+	alignas(64) float sampleX[kRayPacketSize];
+	alignas(64) float sampleY[kRayPacketSize];
+	std::size_t samplePixel[kRayPacketSize];
+	std::size_t pendingCount = 0;
+
+	const auto traceSamples = [&]() {
+		std::array<ColorRGB, kRayPacketSize> colors;
+		TraceSamples_(tile, pendingCount, sampleX, sampleY, samplePixel, colors.data(), heatmap);
+
+		for (std::size_t sample = 0; sample < pendingCount; sample++) {
+			const auto [red, green, blue] = colors[sample].ToFloat();
+			std::array<float, 3>& sum = sums[samplePixel[sample]];
+			sum[0] += red;
+			sum[1] += green;
+			sum[2] += blue;
+		}
+
+		pendingCount = 0;
+	};
+
+	// Each sample is jittered within its own cell of a grid laid over the pixel, which is centered on the pixel's first
+	// sample.
+	const float cellSize = 1.f / static_cast<float>(strataPerSide);
+	for (std::size_t index = 0; index < pixelCount; index++) {
+		if (!refine[index])
+			continue;
+
+		const uint32_t x = tile.x + static_cast<uint32_t>(index % tile.width);
+		const uint32_t y = tile.y + static_cast<uint32_t>(index / tile.width);
+
+		for (uint32_t cellY = 0; cellY < strataPerSide; cellY++) {
+			for (uint32_t cellX = 0; cellX < strataPerSide; cellX++) {
+				const uint32_t sample = (cellY * strataPerSide) + cellX;
+				const float offsetX = ((static_cast<float>(cellX) + sample_jitter(x, y, sample, 0)) * cellSize) - 0.5f;
+				const float offsetY = ((static_cast<float>(cellY) + sample_jitter(x, y, sample, 1)) * cellSize) - 0.5f;
+
+				sampleX[pendingCount] = static_cast<float>(x) + offsetX;
+				sampleY[pendingCount] = static_cast<float>(y) + offsetY;
+				samplePixel[pendingCount] = index;
+				if (++pendingCount == kRayPacketSize)
+					traceSamples();
+			}
+		}
+
+		addedSamples += samplesPerPixel;
+	}
+
+	if (pendingCount > 0)
+		traceSamples();
+
+	const float sampleWeight = 1.f / static_cast<float>(1 + samplesPerPixel);
+	for (std::size_t index = 0; index < pixelCount; index++) {
+		if (refine[index]) {
+			const std::array<float, 3>& sum = sums[index];
+			tilePixels[index] = ColorRGB(sum[0] * sampleWeight, sum[1] * sampleWeight, sum[2] * sampleWeight);
+		}
+	}
+
+	return addedSamples;
+}
+
+std::vector<AdaptiveSampler::HaloPixel_>
+AdaptiveSampler::FindHalo_(const Tile& tile) const
+{
+	const Size& imageSize = fScene.imagePixelSize;
+	std::vector<HaloPixel_> halo;
+	halo.reserve(2 * (static_cast<std::size_t>(tile.width) + tile.height));
+
+	// Each pixel outside the tile is listed with the border pixel next to it, unless it's past the edge of the image.
+	// The corners are left out, as only pixels side by side or one above the other are compared.
+	const auto addPixel = [&](uint32_t x, uint32_t y, uint32_t column, uint32_t row) {
+		halo.push_back({ x, y, (static_cast<std::size_t>(row) * tile.width) + column, ColorRGB() });
+	};
+	for (uint32_t column = 0; column < tile.width; column++) {
+		if (tile.y > 0)
+			addPixel(tile.x + column, tile.y - 1, column, 0);
+		if (tile.y + tile.height < imageSize.height)
+			addPixel(tile.x + column, tile.y + tile.height, column, tile.height - 1);
+	}
+	for (uint32_t row = 0; row < tile.height; row++) {
+		if (tile.x > 0)
+			addPixel(tile.x - 1, tile.y + row, 0, row);
+		if (tile.x + tile.width < imageSize.width)
+			addPixel(tile.x + tile.width, tile.y + row, tile.width - 1, row);
+	}
+
+	return halo;
+}
+
+void
+AdaptiveSampler::TraceHalo_(const Tile& tile, std::vector<HaloPixel_>& halo, CostHeatmap* heatmap) const
+{
+	// They're traced with one sample at their centers, the same first sample their own tiles give them.
+	alignas(64) float sampleX[kRayPacketSize];
+	alignas(64) float sampleY[kRayPacketSize];
+	std::size_t samplePixel[kRayPacketSize];
+	std::array<ColorRGB, kRayPacketSize> colors;
+	for (std::size_t first = 0; first < halo.size(); first += kRayPacketSize) {
+		const std::size_t count = std::min(kRayPacketSize, halo.size() - first);
+		for (std::size_t sample = 0; sample < count; sample++) {
+			sampleX[sample] = static_cast<float>(halo[first + sample].x);
+			sampleY[sample] = static_cast<float>(halo[first + sample].y);
+			samplePixel[sample] = halo[first + sample].borderPixel;
+		}
+
+		TraceSamples_(tile, count, sampleX, sampleY, samplePixel, colors.data(), heatmap);
+		for (std::size_t sample = 0; sample < count; sample++)
+			halo[first + sample].color = colors[sample];
+	}
+}
+
+void
+AdaptiveSampler::TraceSamples_(const Tile& tile, std::size_t count, const float* sampleX, const float* sampleY,
+	const std::size_t* samplePixel, ColorRGB* colors, CostHeatmap* heatmap) const
+{
+	const uint64_t costBefore = heatmap != nullptr ? heatmap->Measure() : 0;
+	if (fPacketTracing) {
+		RayPacket packet;
+		fCamera.GeneratePacket(count, sampleX, sampleY, packet);
+		GraphicsEngine::TraceWithPacket(packet, fScene, colors, fScene.backgroundRefractionIndex, fDepth);
+	} else {
+		for (std::size_t sample = 0; sample < count; sample++) {
+			const Ray ray = fCamera.GenerateRay(sampleX[sample], sampleY[sample]);
+			colors[sample] = GraphicsEngine::TraceWithRay(ray, fScene, fScene.backgroundRefractionIndex, fDepth);
+		}
+	}
+
+	// The samples were traced together, so they share what it cost, whichever pixels they're in.
+	if (heatmap != nullptr) {
+		const double sampleCost = static_cast<double>(heatmap->Measure() - costBefore) / static_cast<double>(count);
+		for (std::size_t sample = 0; sample < count; sample++) {
+			const auto pixel = static_cast<uint32_t>(samplePixel[sample]);
+			heatmap->AddCost(tile.x + (pixel % tile.width), tile.y + (pixel / tile.width), sampleCost);
+		}
+	}
+}
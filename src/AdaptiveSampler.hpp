@@ -0,0 +1,80 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef ADAPTIVE_SAMPLER_H
+#define ADAPTIVE_SAMPLER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "CameraRayGenerator.hpp"
+#include "core/ColorRGB.hpp"
+#include "CostHeatmap.hpp"
+#include "GraphicsEngine.hpp"
+#include "TileScheduler.hpp"
+
+/** AdaptiveSampler */
+
+// Antialiases a tile that's already been traced with one sample per pixel, by only adding more samples to the pixels
+// where the image changes sharply. A pixel whose color differs from one of its neighbours by more than the contrast
+// threshold gets a stratified grid of jittered samples spread across it, which are averaged with its first sample.
+// Everywhere else, the one sample is kept as it is. The pixels just outside the tile are traced as well, out of the
+// same budget, so neighbours across its border are compared too. So busy parts of the image can't blow up the render
+// time, each tile only gets so many extra samples, which go to the pixels that contrast the most first. When that's
+// too few for an edge running across the tile, the refined pixels are given coarser grids instead.
+class AdaptiveSampler {
+public:
+	// How much any component of two neighbouring pixels' colors can differ by, on a scale of 0.0 to 1.0, before both are
+	// given more samples.
+	static constexpr float kDefaultContrastThreshold = 0.1f;
+
+	// How many extra samples a tile can be given, per pixel in it, including the pixels traced around it. With 1, no
+	// tile takes more than about twice as long.
+	static constexpr float kDefaultSampleBudget = 1.f;
+
+public:
+	// Description: Creates a sampler that gives each pixel it refines up to 'maxSamples' samples in total, traced in
+	// packets if 'packetTracing' is true.
+	AdaptiveSampler(const CameraRayGenerator& camera, const SceneDefinition& scene, uint32_t depth, uint32_t maxSamples,
+		bool packetTracing, float contrastThreshold = kDefaultContrastThreshold,
+		float sampleBudget = kDefaultSampleBudget);
+
+	// Description: Returns the most samples there can be on each side of the stratified grid a refined pixel is given.
+	[[nodiscard]] uint32_t StrataPerSide() const { return fStrataPerSide; }
+
+	// Description: Adds samples to the pixels of 'tile' in 'tilePixels', which hold one sample each, row by row, where
+	// they contrast with their neighbours. What the samples cost is added to their pixels in 'heatmap', if given.
+	// Returns: How many samples were traced, including the pixels around the tile.
+	uint64_t RefineTile(const Tile& tile, ColorRGB* tilePixels, CostHeatmap* heatmap = nullptr) const;
+
+private:
+	// A pixel just outside a tile, next to 'borderPixel' on the tile's border.
+	struct HaloPixel_ {
+		uint32_t x;
+		uint32_t y;
+		std::size_t borderPixel;
+		ColorRGB color;
+	};
+
+	// Description: Returns the pixels just outside 'tile' that are in the image, not yet traced.
+	[[nodiscard]] std::vector<HaloPixel_> FindHalo_(const Tile& tile) const;
+
+	// Description: Traces the pixels in 'halo', around 'tile', with one sample each. What they cost is added to the
+	// border pixels next to them in 'heatmap', if given, as no other tile's pixels can be touched.
+	void TraceHalo_(const Tile& tile, std::vector<HaloPixel_>& halo, CostHeatmap* heatmap) const;
+
+	// Description: Traces one sample through each of the 'count' points in 'sampleX' and 'sampleY', no more than a
+	// packet's worth, into 'colors'. What they cost is shared among the pixels of 'tile' in 'samplePixel' that they're
+	// for, in 'heatmap', if given.
+	void TraceSamples_(const Tile& tile, std::size_t count, const float* sampleX, const float* sampleY,
+		const std::size_t* samplePixel, ColorRGB* colors, CostHeatmap* heatmap) const;
+
+	const CameraRayGenerator& fCamera;
+	const SceneDefinition& fScene;
+	uint32_t fDepth;
+	bool fPacketTracing;
+	uint32_t fStrataPerSide;
+	uint8_t fContrastThreshold;
+	float fSampleBudget;
+};
+
+#endif // ADAPTIVE_SAMPLER_H
@@ -0,0 +1,180 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "BatchRenderer.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string>
+
+#include "Framebuffer.hpp"
+#include "JsonWriter.hpp"
+#include "PpmWriter.hpp"
+#include "SceneLoader.hpp"
+#include "SceneRenderer.hpp"
+#include "TextureCache.hpp"
+
+// Description: Returns how many seconds have passed since 'startTime'.
+static double
+seconds_since(std::chrono::steady_clock::time_point startTime)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+BatchRenderer::BatchRenderer(RenderOptions options)
+	:
+	fOptions(std::move(options)),
+	fWallSeconds(0.0)
+{
+}
+
+bool
+BatchRenderer::ReadManifest(const std::filesystem::path& manifestPath, std::vector<std::filesystem::path>& scenePaths)
+{
+	std::ifstream manifest(manifestPath);
+	if (manifest.fail()) {
+		std::cerr << "(Error) Failed to open the batch manifest at path: " << manifestPath << std::endl;
+		return false;
+	}
+
+	const std::filesystem::path manifestDirectory = std::filesystem::absolute(manifestPath).remove_filename();
+
+	std::string line;
+	while (std::getline(manifest, line)) {
+		const std::size_t first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#')
+			continue;
+
+		const std::size_t last = line.find_last_not_of(" \t\r");
+		const std::filesystem::path scenePath = line.substr(first, last - first + 1);
+		scenePaths.push_back(scenePath.is_absolute() ? scenePath : manifestDirectory / scenePath);
+	}
+
+	if (scenePaths.empty()) {
+		std::cerr << "(Error) The batch manifest doesn't list any scenes: " << manifestPath << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+BatchRenderer::LoadedScene
+BatchRenderer::LoadScene_(const std::filesystem::path& scenePath)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+	const TextureCache::Counters countersBefore = TextureCache::Instance().GetCounters();
+
+	// Only one scene is loaded at a time, so the texture counters only changed because of this one.
+	LoadedScene loadedScene{ std::make_unique<SceneDefinition>(), false, 0.0, 0, 0 };
+	std::ostream quiet(nullptr);
+	loadedScene.loaded = SceneLoader::Load(scenePath, *loadedScene.scene, quiet);
+
+	const TextureCache::Counters countersAfter = TextureCache::Instance().GetCounters();
+	loadedScene.texturesLoaded = countersAfter.texturesLoaded - countersBefore.texturesLoaded;
+	loadedScene.texturesReused = countersAfter.texturesReused - countersBefore.texturesReused;
+	loadedScene.loadSeconds = seconds_since(startTime);
+	return loadedScene;
+}
+
+bool
+BatchRenderer::Render(const std::vector<std::filesystem::path>& scenePaths, std::ostream& log)
+{
+	const auto batchStartTime = std::chrono::steady_clock::now();
+	fResults.clear();
+
+	bool allSucceeded = true;
+	std::future<LoadedScene> nextScene = std::async(std::launch::async, &BatchRenderer::LoadScene_, scenePaths.front());
+	for (std::size_t index = 0; index < scenePaths.size(); index++) {
+		const std::filesystem::path& scenePath = scenePaths[index];
+		log << "=== Scene " << (index + 1) << " of " << scenePaths.size() << ": " << scenePath.string() << " ===" << std::endl;
+
+		const auto waitStartTime = std::chrono::steady_clock::now();
+		LoadedScene loadedScene = nextScene.get();
+		const double waitSeconds = seconds_since(waitStartTime);
+
+		// Start loading the next scene while this one renders.
+		if (index + 1 < scenePaths.size())
+			nextScene = std::async(std::launch::async, &BatchRenderer::LoadScene_, scenePaths[index + 1]);
+
+		SceneResult result{ scenePath, false, {}, loadedScene.loadSeconds, waitSeconds, 0.0, 0.0,
+			loadedScene.texturesLoaded, loadedScene.texturesReused, 0 };
+		if (!loadedScene.loaded) {
+			std::cerr << "(Error) Failed to load scene: " << scenePath << std::endl;
+			fResults.push_back(result);
+			allSucceeded = false;
+			continue;
+		}
+
+		SceneDefinition& scene = *loadedScene.scene;
+		SceneRenderer::ChoosePruning(scene, fOptions);
+		result.imageSize = scene.imagePixelSize;
+
+		const auto renderStartTime = std::chrono::steady_clock::now();
+		Framebuffer framebuffer(scene.imagePixelSize);
+		TileRenderStats stats;
+		const bool rendered = SceneRenderer::Render(scene, fOptions, scenePath, framebuffer, stats, log);
+		result.renderSeconds = seconds_since(renderStartTime);
+		result.addedSamples = stats.addedSamples;
+		SceneRenderer::PrintStats(log, stats, framebuffer.PixelCount(), fOptions);
+
+		const auto writeStartTime = std::chrono::steady_clock::now();
+		result.succeeded = rendered
+			&& ppm_writer_write_file(scenePath.c_str(), SceneRenderer::OutputImage(std::move(framebuffer), fOptions));
+		result.writeSeconds = seconds_since(writeStartTime);
+
+		log << "\tLoaded in " << result.loadSeconds << "s (waited " << result.waitSeconds << "s), rendered in "
+			<< result.renderSeconds << "s, written in " << result.writeSeconds << "s, " << result.texturesReused
+			<< " of " << result.texturesLoaded << " textures already loaded" << std::endl;
+
+		allSucceeded = allSucceeded && result.succeeded;
+		fResults.push_back(result);
+	}
+
+	fWallSeconds = seconds_since(batchStartTime);
+	return allSucceeded;
+}
+
+bool
+BatchRenderer::WriteSummary(const std::filesystem::path& summaryPath) const
+{
+	std::ofstream summaryFile(summaryPath);
+	if (summaryFile.fail()) {
+		std::cerr << "(Error) Failed to open the batch summary for writing at path: " << summaryPath << std::endl;
+		return false;
+	}
+
+	uint64_t failedCount = 0;
+	for (const SceneResult& result : fResults)
+		failedCount += result.succeeded ? 0 : 1;
+
+	JsonWriter json(summaryFile);
+	json.BeginObject();
+	json.Field("sceneCount", fResults.size());
+	json.Field("failedCount", failedCount);
+	json.Field("wallSeconds", fWallSeconds);
+
+	json.Key("scenes");
+	json.BeginArray();
+	for (const SceneResult& result : fResults) {
+		json.BeginObject();
+		json.Field("scene", result.scenePath.string());
+		json.Field("succeeded", result.succeeded);
+		json.Field("width", result.imageSize.width);
+		json.Field("height", result.imageSize.height);
+		json.Field("loadSeconds", result.loadSeconds);
+		json.Field("waitSeconds", result.waitSeconds);
+		json.Field("renderSeconds", result.renderSeconds);
+		json.Field("writeSeconds", result.writeSeconds);
+		json.Field("texturesLoaded", result.texturesLoaded);
+		json.Field("texturesReused", result.texturesReused);
+		json.Field("addedSamples", result.addedSamples);
+		json.EndObject();
+	}
+	json.EndArray();
+	json.EndObject();
+
+	summaryFile.close();
+	return !summaryFile.fail();
+}
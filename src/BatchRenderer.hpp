@@ -0,0 +1,74 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef BATCH_RENDERER_H
+#define BATCH_RENDERER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "core/TypeDefinitions.hpp"
+#include "GraphicsEngine.hpp"
+#include "RenderOptions.hpp"
+
+/** BatchRenderer */
+
+// Renders many scenes one after another in a single process, each to a PPM file next to its scene definition file, as
+// if the program had been run on each of them in turn.
+// Everything that outlives a scene is kept warm between them: textures stay in the TextureCache, where a texture with
+// the same contents as one loaded for an earlier scene isn't parsed again, and OpenMP keeps its threads around. The
+// next scene is loaded on another thread while the current one renders, so loading is mostly hidden behind rendering.
+class BatchRenderer {
+public:
+	// Description: Creates a renderer for scenes rendered with the choices made in 'options'.
+	explicit BatchRenderer(RenderOptions options);
+
+	// Description: Reads the manifest at 'manifestPath', which lists a scene definition file on each line, into
+	// 'scenePaths'. Relative paths are relative to the manifest's directory. Blank lines and lines starting with '#'
+	// are skipped.
+	// Returns: true if the manifest was read and lists at least one scene.
+	static bool ReadManifest(const std::filesystem::path& manifestPath, std::vector<std::filesystem::path>& scenePaths);
+
+	// Description: Renders every scene at 'scenePaths', printing out how it's going to the stream 'log'. A scene that
+	// fails to load or render doesn't stop the rest.
+	// Returns: true if every scene was rendered and written out.
+	bool Render(const std::vector<std::filesystem::path>& scenePaths, std::ostream& log);
+
+	// Description: Writes out how long each scene of the last Render() took, as JSON, to the file at 'summaryPath'.
+	// Returns: true if the whole summary was written out.
+	bool WriteSummary(const std::filesystem::path& summaryPath) const;
+
+private:
+	// A scene, loaded on another thread, ready to be rendered.
+	struct LoadedScene {
+		std::unique_ptr<SceneDefinition> scene;
+		bool loaded;
+		double loadSeconds;
+		uint64_t texturesLoaded;
+		uint64_t texturesReused;
+	};
+
+	// How one scene went.
+	struct SceneResult {
+		std::filesystem::path scenePath;
+		bool succeeded;
+		Size imageSize;
+		double loadSeconds;
+		double waitSeconds;
+		double renderSeconds;
+		double writeSeconds;
+		uint64_t texturesLoaded;
+		uint64_t texturesReused;
+		uint64_t addedSamples;
+	};
+
+	static LoadedScene LoadScene_(const std::filesystem::path& scenePath);
+
+	RenderOptions fOptions;
+	std::vector<SceneResult> fResults;
+	double fWallSeconds;
+};
+
+#endif // BATCH_RENDERER_H
@@ -0,0 +1,123 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "CameraRayGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/RayStats.hpp"
+
+CameraRayGenerator::CameraRayGenerator(const ViewingWindow& window, const Point3D& eyePosition, const Size& imageSize)
+	:
+	fEyePosition(eyePosition),
+	fUpperLeft(window.upperLeft),
+	fHorizontalDelta(window.GetHorizontalOffset(imageSize.width)),
+	fVerticalDelta(window.GetVerticalOffset(imageSize.height))
+{
+}
+
+CameraRayGenerator::CameraRayGenerator(const SceneDefinition& scene)
+	:
+	CameraRayGenerator(ViewingWindow(CoordSys(scene.viewDirection, scene.upDirection), scene.viewDirection,
+		scene.eyePosition, scene.fovVertical, scene.imagePixelSize), scene.eyePosition, scene.imagePixelSize)
+{
+}
+
+Ray
+CameraRayGenerator::GenerateRay(float x, float y) const
+{
+	Ray ray{};
+	ray.origin = fEyePosition;
+	GenerateDirections(1, &x, &y, &ray.direction.dx, &ray.direction.dy, &ray.direction.dz);
+	RAY_STATS_ADD(primaryRays, 1);
+
+	return ray;
+}
+
+void
+CameraRayGenerator::GenerateDirections(std::size_t count, const float* __restrict pixelX,
+	const float* __restrict pixelY, float* __restrict directionX, float* __restrict directionY,
+	float* __restrict directionZ) const
+{
+	const float upperLeftX = fUpperLeft.x, upperLeftY = fUpperLeft.y, upperLeftZ = fUpperLeft.z;
+	const float eyeX = fEyePosition.x, eyeY = fEyePosition.y, eyeZ = fEyePosition.z;
+	const float horizontalX = fHorizontalDelta.dx, horizontalY = fHorizontalDelta.dy, horizontalZ = fHorizontalDelta.dz;
+	const float verticalX = fVerticalDelta.dx, verticalY = fVerticalDelta.dy, verticalZ = fVerticalDelta.dz;
+
+	// The point on the window is found in the same order MapImagePixelToPoint() does it, so the rays match its exactly.
+	#pragma omp simd
+	for (std::size_t index = 0; index < count; index++) {
+		const float x = pixelX[index];
+		const float y = pixelY[index];
+
+		const float dx = ((upperLeftX + (horizontalX * x)) + (verticalX * y)) - eyeX;
+		const float dy = ((upperLeftY + (horizontalY * x)) + (verticalY * y)) - eyeY;
+		const float dz = ((upperLeftZ + (horizontalZ * x)) + (verticalZ * y)) - eyeZ;
+
+		// The eye is never on the window, so there's no zero length to guard against.
+		const float length = std::sqrt((dx * dx) + (dy * dy) + (dz * dz));
+		directionX[index] = dx / length;
+		directionY[index] = dy / length;
+		directionZ[index] = dz / length;
+	}
+}
+
+std::size_t
+CameraRayGenerator::GeneratePacket(std::size_t count, const float* pixelX, const float* pixelY, RayPacket& packet) const
+{
+	const std::size_t laneCount = std::min(count, kRayPacketSize);
+
+	GenerateDirections(laneCount, pixelX, pixelY, packet.directionX, packet.directionY, packet.directionZ);
+
+	for (std::size_t lane = 0; lane < laneCount; lane++) {
+		packet.originX[lane] = fEyePosition.x;
+		packet.originY[lane] = fEyePosition.y;
+		packet.originZ[lane] = fEyePosition.z;
+
+		packet.inverseDirectionX[lane] = 1.f / packet.directionX[lane];
+		packet.inverseDirectionY[lane] = 1.f / packet.directionY[lane];
+		packet.inverseDirectionZ[lane] = 1.f / packet.directionZ[lane];
+
+		packet.maxTime[lane] = std::numeric_limits<float>::max();
+		packet.objectIndex[lane] = kNoObjectHit;
+		packet.primitiveIndex[lane] = 0;
+		packet.beta[lane] = packet.gamma[lane] = 0.f;
+		packet.active[lane] = 1;
+	}
+
+	RAY_STATS_ADD(primaryRays, laneCount);
+	return laneCount;
+}
+
+std::size_t
+CameraRayGenerator::GeneratePacket(const Tile& tile, std::size_t firstPixel, RayPacket& packet,
+	const float* jitterX, const float* jitterY) const
+{
+	const std::size_t laneCount = std::min<std::size_t>(kRayPacketSize, tile.PixelCount() - firstPixel);
+
+	alignas(64) float pixelX[kRayPacketSize] = {};
+	alignas(64) float pixelY[kRayPacketSize] = {};
+
+	// Walk the tile's rows by stepping along them, wrapping around to the start of the next row at the tile's edge.
+	uint32_t column = static_cast<uint32_t>(firstPixel % tile.width);
+	uint32_t row = static_cast<uint32_t>(firstPixel / tile.width);
+	for (std::size_t lane = 0; lane < laneCount; lane++) {
+		pixelX[lane] = static_cast<float>(tile.x + column);
+		pixelY[lane] = static_cast<float>(tile.y + row);
+
+		if (++column == tile.width) {
+			column = 0;
+			row++;
+		}
+	}
+
+	if (jitterX != nullptr && jitterY != nullptr) {
+		for (std::size_t lane = 0; lane < laneCount; lane++) {
+			pixelX[lane] += jitterX[lane];
+			pixelY[lane] += jitterY[lane];
+		}
+	}
+
+	return GeneratePacket(laneCount, pixelX, pixelY, packet);
+}
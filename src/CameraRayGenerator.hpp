@@ -0,0 +1,60 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef CAMERA_RAY_GENERATOR_H
+#define CAMERA_RAY_GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/Point.hpp"
+#include "core/Ray.hpp"
+#include "core/RayPacket.hpp"
+#include "core/TypeDefinitions.hpp"
+#include "core/Vector3D.hpp"
+#include "GraphicsEngine.hpp"
+#include "TileScheduler.hpp"
+
+/** CameraRayGenerator */
+
+// Makes the primary rays from the eye through the pixels of the image. How far apart neighbouring pixels are on the
+// ViewingWindow is worked out once per frame, so finding a pixel's point on the window is just a couple of
+// multiply-adds, done for a whole batch of pixels at once into separate arrays per component.
+// Pixel coordinates are floats so that rays can be jittered within a pixel, where (x, y) is the same point
+// ViewingWindow::MapImagePixelToPoint() maps pixel (x, y) to, and (x + 1, y + 1) is the next pixel diagonally.
+class CameraRayGenerator {
+public:
+	CameraRayGenerator(const ViewingWindow& window, const Point3D& eyePosition, const Size& imageSize);
+
+	// Description: Creates a generator for the eye, view, and image size given in 'scene'.
+	explicit CameraRayGenerator(const SceneDefinition& scene);
+
+	// Description: Returns the ray from the eye through the point ('x', 'y') of the image.
+	[[nodiscard]] Ray GenerateRay(float x, float y) const;
+
+	// Description: Writes the unit directions of the rays through the 'count' points of the image at 'pixelX' and
+	// 'pixelY' into 'directionX', 'directionY', and 'directionZ'.
+	void GenerateDirections(std::size_t count, const float* pixelX, const float* pixelY, float* directionX,
+		float* directionY, float* directionZ) const;
+
+	// Description: Puts the rays through the first 'count' points of the image at 'pixelX' and 'pixelY', up to
+	// kRayPacketSize of them, into the lanes of 'packet'.
+	// Returns: How many lanes were filled.
+	std::size_t GeneratePacket(std::size_t count, const float* pixelX, const float* pixelY, RayPacket& packet) const;
+
+	// Description: Puts the rays through the pixels of 'tile' from 'firstPixel' on, counting row by row, into the lanes
+	// of 'packet', until either runs out. When 'jitterX' and 'jitterY' are given, each lane's ray is offset within its
+	// pixel by them.
+	// Returns: How many lanes were filled.
+	std::size_t GeneratePacket(const Tile& tile, std::size_t firstPixel, RayPacket& packet,
+		const float* jitterX = nullptr, const float* jitterY = nullptr) const;
+
+private:
+	Point3D fEyePosition;
+	Point3D fUpperLeft;
+
+	// How far along the ViewingWindow one pixel to the right, and one pixel down, are.
+	Vector3D fHorizontalDelta;
+	Vector3D fVerticalDelta;
+};
+
+#endif // CAMERA_RAY_GENERATOR_H
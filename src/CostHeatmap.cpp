@@ -0,0 +1,126 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "CostHeatmap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+/* Color Ramp */
+
+// The colors costs go through from nothing to the most, evenly spaced.
+static constexpr std::array<std::array<float, 3>, 6> kRampColors = { {
+	{ 0.f, 0.f, 0.f },
+	{ 0.3f, 0.05f, 0.5f },
+	{ 0.8f, 0.1f, 0.3f },
+	{ 1.f, 0.5f, 0.f },
+	{ 1.f, 0.9f, 0.1f },
+	{ 1.f, 1.f, 1.f }
+} };
+
+// Description: Returns the color along the ramp at 'position', from 0.0 for the first color to 1.0 for the last.
+static ColorRGB
+ramp_color(float position)
+{
+	const float scaled = std::clamp(position, 0.f, 1.f) * static_cast<float>(kRampColors.size() - 1);
+	const auto lower = std::min(static_cast<std::size_t>(scaled), kRampColors.size() - 2);
+	const float blend = scaled - static_cast<float>(lower);
+
+	const std::array<float, 3>& from = kRampColors[lower];
+	const std::array<float, 3>& to = kRampColors[lower + 1];
+	return ColorRGB(std::lerp(from[0], to[0], blend), std::lerp(from[1], to[1], blend), std::lerp(from[2], to[2], blend));
+}
+
+
+/* CostHeatmap */
+
+CostHeatmap::CostHeatmap(const Size& imageSize, const Tile& region, Metric metric)
+	:
+	fImageSize(imageSize),
+	fRegion(region),
+	fMetric(metric),
+	fCosts(static_cast<std::size_t>(imageSize.width) * imageSize.height, 0.f)
+{
+}
+
+std::optional<CostHeatmap::Metric>
+CostHeatmap::MetricNamed(std::string_view name)
+{
+	for (Metric metric : { Metric::CYCLES, Metric::RAYS, Metric::TESTS }) {
+		if (name == MetricName(metric))
+			return metric;
+	}
+
+	return {};
+}
+
+const char*
+CostHeatmap::MetricName(Metric metric)
+{
+	switch (metric) {
+		case Metric::CYCLES:
+			return "cycles";
+		case Metric::RAYS:
+			return "rays";
+		case Metric::TESTS:
+			return "tests";
+	}
+
+	// It "shouldn't" be possible to get here!
+	__builtin_unreachable();
+}
+
+std::vector<float>
+CostHeatmap::RegionCosts_() const
+{
+	// Pixels outside of a crop window are never rendered, and would count as costing nothing.
+	std::vector<float> regionCosts;
+	regionCosts.reserve(fRegion.PixelCount());
+	for (uint32_t y = fRegion.y; y < fRegion.y + fRegion.height; y++) {
+		const float* costRow = fCosts.data() + (static_cast<std::size_t>(y) * fImageSize.width);
+		regionCosts.insert(regionCosts.end(), costRow + fRegion.x, costRow + fRegion.x + fRegion.width);
+	}
+
+	return regionCosts;
+}
+
+float
+CostHeatmap::WhiteCost_(const std::vector<float>& regionCosts)
+{
+	if (regionCosts.empty())
+		return 0.f;
+
+	std::vector<float> sortedCosts = regionCosts;
+	const auto percentile = sortedCosts.begin() + static_cast<std::ptrdiff_t>((sortedCosts.size() - 1) * 99 / 100);
+	std::nth_element(sortedCosts.begin(), percentile, sortedCosts.end());
+	return *percentile;
+}
+
+Framebuffer
+CostHeatmap::ToImage() const
+{
+	const float whiteCost = WhiteCost_(RegionCosts_());
+
+	Framebuffer image(fImageSize);
+	for (uint32_t y = 0; y < fImageSize.height; y++) {
+		const float* costRow = fCosts.data() + (static_cast<std::size_t>(y) * fImageSize.width);
+		ColorRGB* imageRow = image.Row(y);
+		for (uint32_t x = 0; x < fImageSize.width; x++)
+			imageRow[x] = ramp_color(whiteCost > 0.f ? costRow[x] / whiteCost : 0.f);
+	}
+
+	return image;
+}
+
+void
+CostHeatmap::PrintSummary(std::ostream& out) const
+{
+	const std::vector<float> regionCosts = RegionCosts_();
+	const double totalCost = std::accumulate(regionCosts.begin(), regionCosts.end(), 0.0);
+	const float highestCost = regionCosts.empty() ? 0.f : *std::max_element(regionCosts.begin(), regionCosts.end());
+	const double meanCost = regionCosts.empty() ? 0.0 : totalCost / static_cast<double>(regionCosts.size());
+
+	out << "\tMapped " << MetricName(fMetric) << " per pixel: " << meanCost << " on average, " << WhiteCost_(regionCosts)
+		<< " or more shown as white, and " << highestCost << " at most" << std::endl;
+}
@@ -0,0 +1,102 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef COST_HEATMAP_H
+#define COST_HEATMAP_H
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "Framebuffer.hpp"
+#include "TileScheduler.hpp"
+#include "core/RayStats.hpp"
+#include "core/TypeDefinitions.hpp"
+
+/** CostHeatmap */
+
+// How much each pixel of an image cost to render, so the expensive parts of a scene can be seen at a glance. Costs are
+// measured by reading the thread's running total of the metric before and after tracing each pixel, or each packet of
+// pixels, which is split evenly between them, and antialiasing samples add to the pixel they're in.
+class CostHeatmap {
+public:
+	enum struct Metric {
+		// CPU cycles from the time stamp counter, or nanoseconds where there isn't one.
+		CYCLES,
+
+		// Rays traced, of every kind. Only counted by builds with RAYTRACER_STATS.
+		RAYS,
+
+		// Bounding box and primitive intersection tests. Only counted by builds with RAYTRACER_STATS.
+		TESTS
+	};
+
+public:
+	// Description: Creates a heatmap of 'metric' for an image of 'imageSize', with nothing spent on any pixel yet. Only
+	// the pixels in 'region', those that are rendered, decide how costs are colored and summed up.
+	CostHeatmap(const Size& imageSize, const Tile& region, Metric metric);
+
+	// Description: Returns the metric called 'name', as it's written on the command line.
+	static std::optional<Metric> MetricNamed(std::string_view name);
+
+	// Description: Returns what 'metric' is called on the command line.
+	static const char* MetricName(Metric metric);
+
+	// Description: Returns whether 'metric' can be measured by this build.
+	static bool IsMeasurable(Metric metric) { return metric == Metric::CYCLES || RayStats::kEnabled; }
+
+	// Description: Returns the calling thread's running total of the metric, to subtract from a later one.
+	[[nodiscard]] uint64_t
+	Measure() const
+	{
+		switch (fMetric) {
+			case Metric::RAYS:
+				return RayStats::Local().TotalRays();
+			case Metric::TESTS:
+				return RayStats::Local().boxTests + RayStats::Local().PrimitiveTests();
+			case Metric::CYCLES:
+			default:
+#if defined(__x86_64__) || defined(__i386__)
+				return __rdtsc();
+#else
+				return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+		}
+	}
+
+	// Description: Adds 'cost' to the pixel at ('x', 'y'). Only the thread rendering a pixel may add to it.
+	void
+	AddCost(uint32_t x, uint32_t y, double cost)
+	{
+		fCosts[(static_cast<std::size_t>(y) * fImageSize.width) + x] += static_cast<float>(cost);
+	}
+
+	// Description: Returns an image of the costs, going from black for nothing, through purple, red, orange, and yellow,
+	// to white for the most costly pixels. So that a handful of pixels can't leave the rest black, every pixel in the top
+	// percent of the region is white.
+	[[nodiscard]] Framebuffer ToImage() const;
+
+	// Description: Prints out the mean, the cost shown as white, and the highest cost of any pixel in the region to the
+	// stream 'out'.
+	void PrintSummary(std::ostream& out) const;
+
+private:
+	// The costs of just the pixels in the region, row by row.
+	[[nodiscard]] std::vector<float> RegionCosts_() const;
+
+	// The lowest cost shown as white, the 99th percentile of 'regionCosts'.
+	[[nodiscard]] static float WhiteCost_(const std::vector<float>& regionCosts);
+
+	Size fImageSize;
+	Tile fRegion;
+	Metric fMetric;
+	std::vector<float> fCosts;
+};
+
+#endif // COST_HEATMAP_H
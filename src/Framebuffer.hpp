@@ -0,0 +1,51 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "core/ColorRGB.hpp"
+#include "core/TypeDefinitions.hpp"
+
+/** Framebuffer */
+
+// The rendered image, as nothing but its pixels packed together row by row. A pixel's coordinates follow from where it
+// is, so they're never stored alongside it.
+class Framebuffer {
+public:
+	explicit Framebuffer(const Size& pixelSize)
+		:
+		fPixelArray(std::make_unique<ColorRGB[]>(static_cast<std::size_t>(pixelSize.width) * pixelSize.height)),
+		fPixelSize(pixelSize)
+	{
+	}
+
+	// Description: Returns the width and height of the image, in pixels.
+	[[nodiscard]] Size PixelSize() const { return fPixelSize; }
+
+	// Description: Returns how many pixels are in the image.
+	[[nodiscard]] std::size_t PixelCount() const { return static_cast<std::size_t>(fPixelSize.width) * fPixelSize.height; }
+
+	// Description: Returns the first of the 'PixelSize().width' pixels in row 'y', from left to right.
+	[[nodiscard]] ColorRGB* Row(uint32_t y) { return fPixelArray.get() + (static_cast<std::size_t>(y) * fPixelSize.width); }
+	[[nodiscard]] const ColorRGB* Row(uint32_t y) const { return fPixelArray.get() + (static_cast<std::size_t>(y) * fPixelSize.width); }
+
+	ColorRGB& operator()(uint32_t x, uint32_t y) { return Row(y)[x]; }
+	const ColorRGB& operator()(uint32_t x, uint32_t y) const { return Row(y)[x]; }
+
+	// Description: Sets every pixel of the image to 'color'.
+	void Fill(const ColorRGB& color) { std::fill_n(fPixelArray.get(), PixelCount(), color); }
+
+	// Description: Returns every pixel of the image, row by row.
+	[[nodiscard]] const ColorRGB* Pixels() const { return fPixelArray.get(); }
+
+private:
+	std::unique_ptr<ColorRGB[]> fPixelArray;
+	Size fPixelSize;
+};
+
+#endif // FRAMEBUFFER_H
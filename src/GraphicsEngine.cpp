@@ -3,95 +3,306 @@
 
 #include "GraphicsEngine.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
 #include <iostream>
+#include <utility>
+
+#include "core/RayStats.hpp"
 
 /* Ray Utilities */
 
+// How many of the rays this thread has considered were pruned, since its counters were last taken.
+static thread_local PruningCounters sPruningCounters;
+
+// Description: Returns a number in [0, 1) that only depends on 'ray', so that the same rays are cut off by Russian
+// roulette no matter which thread traces them.
+static float
+ray_random_number(const Ray& ray)
+{
+	const std::array<float, 6> components = { ray.origin.x, ray.origin.y, ray.origin.z,
+		ray.direction.dx, ray.direction.dy, ray.direction.dz };
+
+	uint32_t hash = 2166136261u;
+	for (float component : components) {
+		hash ^= std::bit_cast<uint32_t>(component);
+		hash *= 16777619u;
+		hash ^= hash >> 15;
+	}
+
+	hash *= 0x846CA68Bu;
+	hash ^= hash >> 16;
+	return static_cast<float>(hash >> 8) * (1.f / 16777216.f);
+}
+
+// Description: Decides whether 'ray', a reflected or refracted ray whose color makes it to its pixel scaled by 'weight',
+// is worth tracing under 'pruning'. For rays that survive Russian roulette, 'compensation' is set to how much more what
+// they find needs to count for, to make up for the rays that didn't; otherwise it's 1.
+// Returns: true if the ray should be traced.
+bool
+GraphicsEngine::KeepSecondaryRay(const Ray& ray, float weight, const RayPruning& pruning, float& compensation)
+{
+	compensation = 1.f;
+	sPruningCounters.consideredRays++;
+
+	if (weight >= pruning.minimumWeight)
+		return true;
+
+	if (pruning.russianRoulette && weight > 0.f) {
+		const float survivalProbability = weight / pruning.minimumWeight;
+		if (ray_random_number(ray) < survivalProbability) {
+			compensation = 1.f / survivalProbability;
+			sPruningCounters.rouletteSurvivors++;
+			return true;
+		}
+	}
+
+	sPruningCounters.prunedRays++;
+	return false;
+}
+
+// Description: Returns how many rays this thread has considered and pruned since the last time this was called.
+PruningCounters
+GraphicsEngine::TakePruningCounters()
+{
+	return std::exchange(sPruningCounters, PruningCounters{});
+}
+
+// Description: Fills 'hit' with what BoundingVolumeHierarchy::IntersectClosest() found for 'lane' of 'packet', which
+// must have hit something in 'scene'.
+void
+GraphicsEngine::FillPacketHitRecord(const RayPacket& packet, std::size_t lane, const SceneDefinition& scene, HitRecord& hit)
+{
+	hit.time = packet.maxTime[lane];
+	hit.objectIndex = static_cast<std::size_t>(packet.objectIndex[lane]);
+	hit.primitiveIndex = packet.primitiveIndex[lane];
+	hit.beta = packet.beta[lane];
+	hit.gamma = packet.gamma[lane];
+	hit.object = scene.objectList[hit.objectIndex].get();
+	hit.object->FillHitRecord(packet.GetRay(lane), hit);
+}
+
 // Description:
 // Finds the color of the pixel corresponding to the viewing window point pointed to by 'ray', with 'ray'
 // originating at the camera/eye position. 'scene' defines all the objects, lights, their properties, camera information,
 // and to ensure the returned pixel color accounts for shadows, material properties, light colors, and more.
 ColorRGB
-GraphicsEngine::TraceWithRay(const Ray &ray, const SceneDefinition &scene, float previousRefractionIndex, uint32_t depth)
+GraphicsEngine::TraceWithRay(const Ray &ray, const SceneDefinition &scene, float previousRefractionIndex, uint32_t depth, float weight)
 {
-	float closestIntersectionTime = std::numeric_limits<float>::max();
-	int64_t closestObjectIndex = -1;
-	Point3D closestIntersectPoint{};
-	for (std::size_t index = 0; index < scene.objectList.size(); index++) {
-		SharedObject currentObject = scene.objectList[index];
-
-		// Do the intersection test with the ray and the current object!
-		float intersectionTime = 0.f;
-		std::optional<Point3D> currentIntersect = currentObject->IntersectWith(ray, &intersectionTime);
-		if (!currentIntersect.has_value())
-			continue;
-
-		if (std::isless(intersectionTime, closestIntersectionTime)) {
-			closestIntersectionTime = intersectionTime;
-			closestObjectIndex = static_cast<int64_t>(index);
-			closestIntersectPoint = currentIntersect.value();
-		}
-	}
+	HitRecord hit;
+	const bool hitSomething = scene.objectHierarchy.IntersectClosest(ray, hit);
 
 	// The ray didn't hit any objects, oh well...
-	if (closestObjectIndex == -1)
+	if (!hitSomething) {
+		RAY_STATS_ADD(closestMisses, 1);
 		return scene.backgroundColor;
+	}
+
+	RAY_STATS_ADD(closestHits, 1);
 
-	return ShadeWithRay(ray, closestIntersectPoint, scene, scene.objectList[closestObjectIndex], previousRefractionIndex, depth);
+	return ShadeWithRay(ray, hit, scene, previousRefractionIndex, depth, nullptr, weight);
 }
 
 
-// Description: Calculates the amount of shadow at 'startPoint' caused by 'objects' blocking light rays sourced from 'lightToCheck'
-// on their way to 'targetObject'.
-// Returns: 0.0 if 'startPoint' is in shadow, and 1.0 otherwise.
-float
-GraphicsEngine::CalculateShadow(const Point3D& startPoint, const SharedLight& lightToCheck, const std::vector<SharedObject>& objects, const SharedObject& objectHit)
+// Description:
+// Same as TraceWithRay, but for every active lane of 'packet' at once, with each lane's color stored into 'colorsOut'.
+// The packet is intersected with the scene together, along with the shadow rays towards directional lights, which all
+// point the same way. Everything after that is shaded one lane at a time.
+void
+GraphicsEngine::TraceWithPacket(RayPacket& packet, const SceneDefinition& scene, ColorRGB* colorsOut, float previousRefractionIndex, uint32_t depth)
 {
-	const Ray shadowRay = lightToCheck->GenerateShadowRay(startPoint, *objectHit->SurfaceNormal(startPoint));
-    const std::optional<Vector3D> vectorL = lightToCheck->CalculateL(startPoint);
+	scene.objectHierarchy.IntersectClosest(packet);
 
-	float shadowAmount = 1.f;
-	for (const auto& object : objects)
-	{
-        std::optional<Vector3D> vectorN = object->SurfaceNormal(startPoint);
-
-		if (*object == *objectHit
-            && vectorN.has_value() && vectorL.has_value()
-            && std::isless(vectorN->DotProduct(*vectorL), 0.0f))
-		{
-			shadowAmount *= (1.f - object->material.opacity);
+	std::array<HitRecord, kRayPacketSize> hits{};
+	for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+		if (packet.active[lane] == 0)
 			continue;
+
+		// The ray didn't hit any objects, oh well...
+		if (packet.objectIndex[lane] == kNoObjectHit) {
+			RAY_STATS_ADD(closestMisses, 1);
+			colorsOut[lane] = scene.backgroundColor;
+			continue;
+		}
+
+		RAY_STATS_ADD(closestHits, 1);
+		FillPacketHitRecord(packet, lane, scene, hits[lane]);
+	}
+
+	// Shadows from directional lights, for every lane that hit something.
+	const std::size_t lightCount = scene.lightList.size();
+	std::vector<float> knownShadows(kRayPacketSize * lightCount, -1.f);
+	for (std::size_t lightIndex = 0; lightIndex < lightCount; lightIndex++) {
+		const SharedLight& light = scene.lightList[lightIndex];
+		if (light->Type() != Light::DIRECTIONAL_LIGHT)
+			continue;
+
+		RayPacket shadowPacket;
+		std::array<const Object*, kRayPacketSize> ignoredObjects{};
+		std::array<const Object*, kRayPacketSize> ignoredInstances{};
+		std::array<float, kRayPacketSize> selfShadows{};
+		for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+			if (packet.active[lane] == 0 || packet.objectIndex[lane] == kNoObjectHit)
+				continue;
+
+			// Same as CalculateShadow
+			const HitRecord& hit = hits[lane];
+			const Point3D& startPoint = hit.position;
+			const Vector3D& surfaceNormal = hit.shadingNormal;
+			const std::optional<Vector3D> vectorL = light->CalculateL(startPoint);
+
+			selfShadows[lane] = 1.f;
+			if (vectorL.has_value() && std::isless(surfaceNormal.DotProduct(*vectorL), 0.0f)) {
+				selfShadows[lane] *= (1.f - hit.object->material.opacity);
+				if (selfShadows[lane] <= 0.f) {
+					knownShadows[(lane * lightCount) + lightIndex] = 0.f;
+					continue;
+				}
+
+				ignoredObjects[lane] = hit.object;
+				ignoredInstances[lane] = hit.instance;
+			}
+
+			const Ray shadowRay = light->GenerateShadowRay(startPoint, surfaceNormal);
+			shadowPacket.SetRay(lane, shadowRay, light->DistanceToLight(shadowRay.origin));
 		}
 
-		if (lightToCheck->IntersectionBeforeLight(shadowRay, object)) {
-			shadowAmount *= (1.f - object->material.opacity);
+		if (!shadowPacket.AnyActive())
 			continue;
+
+		RAY_STATS_ADD(shadowRays, RayStats::CountLanes(shadowPacket.active));
+
+		std::array<float, kRayPacketSize> transmittances{};
+		scene.objectHierarchy.Transmittance(shadowPacket, ignoredObjects.data(), ignoredInstances.data(), transmittances.data());
+
+		for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+			if (shadowPacket.active[lane] != 0)
+				knownShadows[(lane * lightCount) + lightIndex] = selfShadows[lane] * transmittances[lane];
 		}
 	}
 
-	return shadowAmount;
+	for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+		if (packet.active[lane] == 0 || packet.objectIndex[lane] == kNoObjectHit)
+			continue;
+
+		colorsOut[lane] = ShadeWithRay(packet.GetRay(lane), hits[lane], scene, previousRefractionIndex, depth,
+			knownShadows.data() + (lane * lightCount));
+	}
+}
+
+
+// Description: Calculates the amount of shadow at the point of intersection of 'hit', caused by the objects in
+// 'hierarchy' blocking light rays sourced from 'lightToCheck'. Only objects between that point and the light can block it.
+// Returns: 0.0 if the point is in shadow, and 1.0 otherwise, with partially transparent objects letting some light through.
+float
+GraphicsEngine::CalculateShadow(const HitRecord& hit, const SharedLight& lightToCheck, const BoundingVolumeHierarchy& hierarchy)
+{
+	const Point3D& startPoint = hit.position;
+	const Vector3D& surfaceNormal = hit.shadingNormal;
+
+	const Ray shadowRay = lightToCheck->GenerateShadowRay(startPoint, surfaceNormal);
+	const std::optional<Vector3D> vectorL = lightToCheck->CalculateL(startPoint);
+
+	float shadowAmount = 1.f;
+
+	// A surface facing away from the light is shadowed by the object it belongs to, so there's no need to test it again.
+	const Object* ignoredObject = nullptr;
+	const Object* ignoredInstance = nullptr;
+	if (vectorL.has_value() && std::isless(surfaceNormal.DotProduct(*vectorL), 0.0f)) {
+		shadowAmount *= (1.f - hit.object->material.opacity);
+		if (shadowAmount <= 0.f)
+			return 0.f;
+
+		ignoredObject = hit.object;
+		ignoredInstance = hit.instance;
+	}
+
+	RAY_STATS_ADD(shadowRays, 1);
+	return shadowAmount * hierarchy.Transmittance(shadowRay, lightToCheck->DistanceToLight(shadowRay.origin), ignoredObject, ignoredInstance);
 }
 
 // Description: Calculates the pixel represented by a viewing window point that is pointed to by 'ray'.
-// The calculation involved performing Blinn-Phong Illumination equation after calculating all necessary parameters.
+// The surface's own color comes from ShadeSurface(), and then the reflected and refracted rays it sends on are traced
+// 'depth' levels deep, with what they find mixed in.
 // Parameters:
 //  - ray: Originates from the eye/camera position and points to a point on the viewing window; Incoming ray
-//  - objectHit: The object closest to the camera/eye position that intersected with 'ray'
-//  - intersectionPoint: The point where 'ray' and 'objectHit' intersected.
-//  - lights: All the lights in the scene. They will be tested to see if their light reaches 'intersectionPoint'.
-//  - objects: All the objects in the scene. They will be tested to see if their presence blocks incoming light and cast a shadow.
+//  - hit: Everything about where 'ray' hit the object closest to the camera/eye position.
+//  - knownShadows: Optionally, the shadow amount for each light in the scene that was already calculated, with negative values
+//    for lights that still need to be calculated.
+//  - weight: How much of this color makes it back to the pixel, which decides whether the rays it sends on are worth
+//    tracing.
 ColorRGB
-GraphicsEngine::ShadeWithRay(const Ray& ray, const Point3D& intersectionPoint, const SceneDefinition& scene, const SharedObject& objectHit, const float& previousRefractionIndex,  uint32_t depth)
+GraphicsEngine::ShadeWithRay(const Ray& ray, const HitRecord& hit, const SceneDefinition& scene, const float& previousRefractionIndex,  uint32_t depth, const float* knownShadows, float weight)
 {
-	// Blinn-Phong Illumination Equation
-	std::optional<Vector3D> maybeN = objectHit->SurfaceNormal(intersectionPoint);
-	if (!maybeN) {
-		std::cerr << "Error: Couldn't calculate surface normal vector N!" << std::endl;
-		exit(EXIT_FAILURE);
+	using ColorRGBFloat = std::tuple<float, float, float>;
+
+	SecondaryRays secondaryRays{};
+	ColorRGB illuminationColor = ShadeSurface(ray, hit, scene, previousRefractionIndex, knownShadows, secondaryRays);
+
+	// ηt - Refraction Index (Transmitted Ray)
+	const float& ηt = previousRefractionIndex;
+
+	// Refraction
+	ColorRGB refractionColor(0.f, 0.f, 0.f);
+	float compensation = 1.f;
+	if (secondaryRays.refracts && depth > 0
+		&& KeepSecondaryRay(secondaryRays.refractedRay, weight * secondaryRays.refractedWeight, scene.pruning, compensation)) {
+		const float refractedWeight = secondaryRays.refractedWeight * compensation;
+		RAY_STATS_ADD(refractedRays, 1);
+		refractionColor = TraceWithRay(secondaryRays.refractedRay, scene, ηt, depth - 1, weight * refractedWeight);
+
+		ColorRGBFloat calcRefractColor = refractionColor.ToFloat();
+		std::get<0>(calcRefractColor) *= refractedWeight; // Red
+		std::get<1>(calcRefractColor) *= refractedWeight; // Green
+		std::get<2>(calcRefractColor) *= refractedWeight; // Blue
+
+		// Final Refraction Color
+		refractionColor = ColorRGB(std::get<0>(calcRefractColor), std::get<1>(calcRefractColor), std::get<2>(calcRefractColor));
 	}
-	Vector3D& vectorN = maybeN.value();
-	vectorN.NormalizeSelf();
+
+	illuminationColor += refractionColor;
+
+	// Reflection
+	ColorRGB reflectionColor(0.f, 0.f, 0.f);
+	if (depth > 0
+		&& KeepSecondaryRay(secondaryRays.reflectedRay, weight * secondaryRays.reflectedWeight, scene.pruning, compensation)) {
+		const float reflectedWeight = secondaryRays.reflectedWeight * compensation;
+		RAY_STATS_ADD(reflectedRays, 1);
+		reflectionColor = TraceWithRay(secondaryRays.reflectedRay, scene, ηt, depth - 1, weight * reflectedWeight);
+
+		ColorRGBFloat calcReflectColor = reflectionColor.ToFloat();
+		std::get<0>(calcReflectColor) *= reflectedWeight; // Red
+		std::get<1>(calcReflectColor) *= reflectedWeight; // Green
+		std::get<2>(calcReflectColor) *= reflectedWeight; // Blue
+
+		// Final Reflection Color
+		reflectionColor = ColorRGB(std::get<0>(calcReflectColor), std::get<1>(calcReflectColor), std::get<2>(calcReflectColor));
+	}
+
+	illuminationColor += reflectionColor;
+
+	return illuminationColor;
+}
+
+// Description: Calculates the color of the surface 'ray' hit at 'hit' on its own, by performing the Blinn-Phong
+// Illumination equation after calculating all necessary parameters, without anything it reflects or lets through.
+// Those are left to the rays put into 'secondaryRays'.
+// Parameters:
+//  - ray: The incoming ray.
+//  - hit: Everything about where 'ray' hit the object closest to its origin.
+//  - scene: All the lights in the scene will be tested to see if their light reaches the point hit, and all the objects
+//    to see if their presence blocks incoming light and casts a shadow.
+//  - knownShadows: Optionally, the shadow amount for each light in the scene that was already calculated, with negative values
+//    for lights that still need to be calculated.
+ColorRGB
+GraphicsEngine::ShadeSurface(const Ray& ray, const HitRecord& hit, const SceneDefinition& scene, float previousRefractionIndex, const float* knownShadows, SecondaryRays& secondaryRays)
+{
+	// Blinn-Phong Illumination Equation
+	const Point3D& intersectionPoint = hit.position;
+	const Object* objectHit = hit.object;
+	Vector3D vectorN = hit.shadingNormal;
 
 	// I - Faces outward, points from intersection point to incoming ray origin
 	Vector3D vectorIPrime = Vector3D(ray.origin, intersectionPoint);
@@ -120,15 +331,19 @@ GraphicsEngine::ShadeWithRay(const Ray& ray, const Point3D& intersectionPoint, c
 	const MaterialProps& objMat = objectHit->material;
 
 	using ColorRGBFloat = std::tuple<float, float, float>;
-	const ColorRGBFloat Od = objectHit->GetIntrinsicColorAtSurfacePoint(intersectionPoint).ToFloat();
+	const ColorRGBFloat Od = objectHit->GetIntrinsicColor(hit).ToFloat();
 	const ColorRGBFloat Os = objMat.specularHighlightColor.ToFloat();
 
 	// Sum up each light's contributions
 
 	ColorRGBFloat lightSum = {0.f, 0.f, 0.f};
-	for (const auto& light : scene.lightList) {
+	for (std::size_t lightIndex = 0; lightIndex < scene.lightList.size(); lightIndex++) {
+		const SharedLight& light = scene.lightList[lightIndex];
+
 		// Is the light blocked?
-		float shadow = CalculateShadow(intersectionPoint, light, scene.objectList, objectHit);
+		float shadow = (knownShadows != nullptr && knownShadows[lightIndex] >= 0.f)
+			? knownShadows[lightIndex]
+			: CalculateShadow(hit, light, scene.objectHierarchy);
 
 		Vector3D vectorL = light->CalculateL(intersectionPoint).value();
 
@@ -181,52 +396,25 @@ GraphicsEngine::ShadeWithRay(const Ray& ray, const Point3D& intersectionPoint, c
 	auto illuminationColor = ColorRGB(std::get<0>(illumination), std::get<1>(illumination), std::get<2>(illumination));
 
 	// Refraction
-	ColorRGB refractionColor(0.f, 0.f, 0.f);
-	if (α < 1.f && depth > 0) {
+	secondaryRays.refracts = α < 1.f;
+	if (secondaryRays.refracts) {
 		// T - Refraction transmitted ray
 		Vector3D vectorT = (vectorN * -1.f) * sqrtf(1.f - (powf(ηi / ηt, 2.f) * (1.f - powf(a, 2.f)))) + ((vectorN * a) - vectorI) * (ηi / ηt);
 		vectorT.NormalizeSelf();
 
-		Ray refractedRay;
-		refractedRay.origin = intersectionPoint + (vectorN * 0.001f);
-		refractedRay.direction = vectorT;
-
-		refractionColor = TraceWithRay(refractedRay, scene, ηt, depth - 1);
-
-		ColorRGBFloat calcRefractColor = refractionColor.ToFloat();
-		std::get<0>(calcRefractColor) *= (1.f - Fr) * (1.f - α); // Red
-		std::get<1>(calcRefractColor) *= (1.f - Fr) * (1.f - α); // Green
-		std::get<2>(calcRefractColor) *= (1.f - Fr) * (1.f - α); // Blue
-
-		// Final Refraction Color
-		refractionColor = ColorRGB(std::get<0>(calcRefractColor), std::get<1>(calcRefractColor), std::get<2>(calcRefractColor));
+		secondaryRays.refractedRay.origin = intersectionPoint + (vectorN * 0.001f);
+		secondaryRays.refractedRay.direction = vectorT;
+		secondaryRays.refractedWeight = (1.f - Fr) * (1.f - α);
 	}
 
-	illuminationColor += refractionColor;
-
 	// Reflection
-	ColorRGB reflectionColor(0.f, 0.f, 0.f);
-	if (depth > 0) {
-		// R - Reflected Ray Direction
-		Vector3D vectorR = (vectorN * a * 2.f) - vectorI;
-		vectorR.NormalizeSelf();
+	// R - Reflected Ray Direction
+	Vector3D vectorR = (vectorN * a * 2.f) - vectorI;
+	vectorR.NormalizeSelf();
 
-		Ray reflectedRay;
-		reflectedRay.origin = intersectionPoint + (vectorN * 0.001f);
-		reflectedRay.direction = vectorR;
-
-		reflectionColor = TraceWithRay(reflectedRay, scene, ηt, depth - 1);
-
-		ColorRGBFloat calcReflectColor = reflectionColor.ToFloat();
-		std::get<0>(calcReflectColor) *= Fr; // Red
-		std::get<1>(calcReflectColor) *= Fr; // Green
-		std::get<2>(calcReflectColor) *= Fr; // Blue
-
-		// Final Reflection Color
-		reflectionColor = ColorRGB(std::get<0>(calcReflectColor), std::get<1>(calcReflectColor), std::get<2>(calcReflectColor));
-	}
-
-	illuminationColor += reflectionColor;
+	secondaryRays.reflectedRay.origin = intersectionPoint + (vectorN * 0.001f);
+	secondaryRays.reflectedRay.direction = vectorR;
+	secondaryRays.reflectedWeight = Fr;
 
 	return illuminationColor;
 }
@@ -6,12 +6,47 @@
 #include <map>
 #include <unordered_map>
 #include <memory>
+#include <string>
 
+#include "core/BoundingVolumeHierarchy.hpp"
+#include "core/HitRecord.hpp"
 #include "core/TypeDefinitions.hpp"
 #include "core/Light.hpp"
+#include "core/Mesh.hpp"
 #include "core/Object.hpp"
+#include "core/RayPacket.hpp"
 #include "core/Vector3D.hpp"
 
+/** Ray Pruning **/
+
+// How reflected and refracted rays that would barely add anything to their pixel are cut off. A ray's weight is how
+// much of the color it finds makes it back to the eye, which shrinks with every bounce.
+struct RayPruning {
+	// Rays weighing less than this aren't traced. 0 traces every ray.
+	float minimumWeight = 0.f;
+
+	// Rather than always cutting off light rays, give each a chance of being traced in proportion to its weight, and
+	// scale up what the ones that are traced find to make up for the rest, so the image stays the same on average.
+	bool russianRoulette = false;
+};
+
+// How many reflected and refracted rays were considered for tracing, and what happened to those that were too light.
+struct PruningCounters {
+	uint64_t consideredRays = 0;
+	uint64_t prunedRays = 0;
+	uint64_t rouletteSurvivors = 0;
+
+	PruningCounters&
+	operator+=(const PruningCounters& other)
+	{
+		consideredRays += other.consideredRays;
+		prunedRays += other.prunedRays;
+		rouletteSurvivors += other.rouletteSurvivors;
+		return *this;
+	}
+};
+
+
 /** The Scene Definition **/
 
 struct SceneDefinition {
@@ -29,6 +64,15 @@ struct SceneDefinition {
 	// Objects
 	std::vector<SharedObject> objectList;
 
+	// Meshes, by name, which are placed in the scene by the MeshInstances in 'objectList'.
+	std::map<std::string, SharedMesh, std::less<>> meshMap;
+
+	// Acceleration structure over 'objectList', built once the scene has been parsed.
+	BoundingVolumeHierarchy objectHierarchy;
+
+	// Which reflected and refracted rays aren't worth tracing, as chosen on the command line.
+	RayPruning pruning;
+
 	// Lights
 	std::vector<SharedLight> lightList;
 
@@ -56,6 +100,10 @@ operator<<(std::ostream& out, const SceneDefinition& definition)
 	for (const auto& object : definition.objectList) {
 		object->Print(out);
 	}
+	out << "Meshes: " << definition.meshMap.size() << '\n';
+	for (const auto& [name, mesh] : definition.meshMap) {
+		out << '\t' << name << ": " << mesh->Triangles().size() << " triangles\n";
+	}
 	out << "Lights: " << definition.lightList.size() << '\n';
 	for (const auto& light : definition.lightList) {
 		light->Print(out);
@@ -194,14 +242,31 @@ struct ViewingWindow {
 };
 
 
+// The rays a surface sends on to find what it reflects and what can be seen through it, and how much of the color each
+// finds makes it back.
+struct SecondaryRays {
+	Ray reflectedRay;
+	float reflectedWeight;
+
+	// Only opaque surfaces don't refract.
+	bool refracts;
+	Ray refractedRay;
+	float refractedWeight;
+};
+
 class GraphicsEngine {
 public:
 	GraphicsEngine() = delete;
 
     // Check GraphicsEngine.cpp for information!
-	static ColorRGB TraceWithRay(const Ray &ray, const SceneDefinition &scene, float previousRefractionIndex = 1.f, uint32_t depth = 0);
-	static float CalculateShadow(const Point3D& startPoint, const SharedLight& lightToCheck, const std::vector<SharedObject>& objects, const SharedObject& objectHit);
-	static ColorRGB ShadeWithRay(const Ray& ray, const Point3D& intersectionPoint, const SceneDefinition& scene, const SharedObject& objectHit, const float& previousRefractionIndex = 1.f, uint32_t depth = 0);
+	static ColorRGB TraceWithRay(const Ray &ray, const SceneDefinition &scene, float previousRefractionIndex = 1.f, uint32_t depth = 0, float weight = 1.f);
+	static void TraceWithPacket(RayPacket& packet, const SceneDefinition& scene, ColorRGB* colorsOut, float previousRefractionIndex = 1.f, uint32_t depth = 0);
+	static void FillPacketHitRecord(const RayPacket& packet, std::size_t lane, const SceneDefinition& scene, HitRecord& hit);
+	static float CalculateShadow(const HitRecord& hit, const SharedLight& lightToCheck, const BoundingVolumeHierarchy& hierarchy);
+	static ColorRGB ShadeWithRay(const Ray& ray, const HitRecord& hit, const SceneDefinition& scene, const float& previousRefractionIndex = 1.f, uint32_t depth = 0, const float* knownShadows = nullptr, float weight = 1.f);
+	static bool KeepSecondaryRay(const Ray& ray, float weight, const RayPruning& pruning, float& compensation);
+	static PruningCounters TakePruningCounters();
+	static ColorRGB ShadeSurface(const Ray& ray, const HitRecord& hit, const SceneDefinition& scene, float previousRefractionIndex, const float* knownShadows, SecondaryRays& secondaryRays);
 };
 
 #endif // GRAPHICS_ENGINE_H
\ No newline at end of file
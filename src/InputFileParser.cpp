@@ -37,7 +37,11 @@ enum TokenType {
     TOKEN_TRIANGLE,
     TOKEN_VERTEX_NORMAL,
     TOKEN_TEXTURE,
-    TOKEN_TEXTURE_COORDINATE
+    TOKEN_TEXTURE_COORDINATE,
+    // Extra
+    TOKEN_MESH,
+    TOKEN_END_MESH,
+    TOKEN_INSTANCE
 };
 
 const std::map<const std::string_view, TokenType> kValidTokenMap = {
@@ -62,7 +66,11 @@ const std::map<const std::string_view, TokenType> kValidTokenMap = {
         {"f",           TOKEN_TRIANGLE},
         {"vn",          TOKEN_VERTEX_NORMAL},
         {"texture",     TOKEN_TEXTURE},
-        {"vt",          TOKEN_TEXTURE_COORDINATE}
+        {"vt",          TOKEN_TEXTURE_COORDINATE},
+        // Extra
+        {"mesh",        TOKEN_MESH},
+        {"endmesh",     TOKEN_END_MESH},
+        {"instance",    TOKEN_INSTANCE}
 };
 
 /* Primary Functions */
@@ -108,6 +116,12 @@ InputFileParser::Close()
 
 bool
 InputFileParser::Parse(SceneDefinition& definition)
+{
+	return Parse(fInputFile, definition);
+}
+
+bool
+InputFileParser::Parse(std::istream& input, SceneDefinition& definition)
 {
 	// Bitmask for tracking tokens that were discovered.
 	// This helps validate a Scene Description that had no invalid tokens,
@@ -125,11 +139,20 @@ InputFileParser::Parse(SceneDefinition& definition)
 	constexpr std::bitset<std::numeric_limits<uint8_t>::digits> kKeyTokens = HAS_IMSIZE | HAS_EYE | HAS_VIEWDIR | HAS_VFOV | HAS_UPDIR | HAS_BKGCOLOR;
 	std::bitset<std::numeric_limits<uint8_t>::digits> parsedTokens = 0;
 
-	while(!fInputFile.eof())
+	std::size_t degenerateTriangleCount = 0;
+
+	// Triangles go into this mesh instead of the scene while it's being declared.
+	SharedMesh currentMesh = nullptr;
+
+	// The material and texture given to each object as it's declared, until the next mtlcolor or texture line.
+	MaterialProps currentMaterialProps{};
+	std::filesystem::path currentTexturePath;
+
+	while(!input.eof())
 	{
 		std::string currentLine;
-		std::getline(fInputFile, currentLine);
-		if (!fInputFile.eof() && fInputFile.fail()) {
+		std::getline(input, currentLine);
+		if (!input.eof() && input.fail()) {
 			std::cerr << "Failed to read a line from the input file!" << std::endl;
 			return false;
 		}
@@ -144,8 +167,6 @@ InputFileParser::Parse(SceneDefinition& definition)
 			return false;
 		}
 
-		static MaterialProps currentMaterialProps{};
-        static std::filesystem::path currentTexturePath;
 		switch (kValidTokenMap.at(lineToken)) {
 			case TOKEN_COMMENT:
 			{
@@ -232,6 +253,11 @@ InputFileParser::Parse(SceneDefinition& definition)
 
 			case TOKEN_SPHERE:
 			{
+				if (currentMesh) {
+					std::cerr << "Error: Only triangles can be part of a mesh!" << std::endl;
+					return false;
+				}
+
 				// Make sure a material color was set
 				if (!parsedTokens.test(HAS_MTLCOLOR)) {
 					std::cerr << "Error: An object was encountered, though there's no material color set yet!" << std::endl;
@@ -263,6 +289,11 @@ InputFileParser::Parse(SceneDefinition& definition)
 
 			case TOKEN_CYLINDER:
 			{
+				if (currentMesh) {
+					std::cerr << "Error: Only triangles can be part of a mesh!" << std::endl;
+					return false;
+				}
+
 				// Make sure a material color was set
 				if (!parsedTokens.test(HAS_MTLCOLOR)) {
 					std::cerr << "Error: An object was encountered, though there's no material color set yet!" << std::endl;
@@ -383,6 +414,17 @@ InputFileParser::Parse(SceneDefinition& definition)
                 triangle->material = currentMaterialProps;
                 triangle->texturePath.assign(currentTexturePath);
 
+                // Nothing can hit a degenerate triangle, so don't bother keeping it around.
+                if (!triangle->Precompute()) {
+                    degenerateTriangleCount++;
+                    break;
+                }
+
+                if (currentMesh) {
+                    currentMesh->AddTriangle(std::move(triangle));
+                    break;
+                }
+
                 definition.objectList.push_back(std::move(triangle));
 
                 break;
@@ -427,6 +469,68 @@ InputFileParser::Parse(SceneDefinition& definition)
                 break;
             }
 
+			case TOKEN_MESH:
+			{
+				if (currentMesh) {
+					std::cerr << "Error: Meshes can't be declared inside of another mesh!" << std::endl;
+					return false;
+				}
+
+				std::string meshName;
+				if (!parse_mesh(currentLine, meshName)) {
+					std::cerr << "Error: Failed to parse mesh line: " << currentLine << std::endl;
+					return false;
+				}
+
+				if (definition.meshMap.contains(meshName)) {
+					std::cerr << "Error: The mesh \"" << meshName << "\" was already declared!" << std::endl;
+					return false;
+				}
+
+				currentMesh = std::make_shared<Mesh>(meshName);
+				definition.meshMap.emplace(meshName, currentMesh);
+
+				break;
+			}
+
+			case TOKEN_END_MESH:
+			{
+				if (!currentMesh) {
+					std::cerr << "Error: Found endmesh without a mesh being declared!" << std::endl;
+					return false;
+				}
+
+				currentMesh = nullptr;
+				break;
+			}
+
+			case TOKEN_INSTANCE:
+			{
+				std::string meshName;
+				Transform objectToWorld;
+				if (!parse_instance(currentLine, meshName, objectToWorld)) {
+					std::cerr << "Error: Failed to parse instance line: " << currentLine << std::endl;
+					return false;
+				}
+
+				const auto mesh = definition.meshMap.find(meshName);
+				if (mesh == definition.meshMap.end() || mesh->second == currentMesh) {
+					std::cerr << "Error: An instance refers to the mesh \"" << meshName << "\", which hasn't been declared!" << std::endl;
+					return false;
+				}
+
+				const std::optional<Transform> worldToObject = objectToWorld.Inverse();
+				if (!worldToObject) {
+					std::cerr << "Error: An instance of \"" << meshName << "\" has a transform that can't be inverted!" << std::endl;
+					return false;
+				}
+
+				definition.objectList.push_back(std::make_shared<MeshInstance>(mesh->second, objectToWorld, *worldToObject));
+
+				parsedTokens.set(HAS_OBJECT);
+				break;
+			}
+
 			default:
 			{
 				// The previous check should have caught everything...
@@ -436,6 +540,11 @@ InputFileParser::Parse(SceneDefinition& definition)
 		}
 	}
 
+	if (currentMesh) {
+		std::cerr << "Error: The mesh \"" << currentMesh->Name() << "\" is missing its endmesh!" << std::endl;
+		return false;
+	}
+
 	// Let's make sure we have all essential tokens for the Scene Definition
 	if ((parsedTokens & kKeyTokens) != kKeyTokens) {
 		std::cerr << "Critical tokens are missing from the Scene Definition file!" << std::endl;
@@ -462,6 +571,9 @@ InputFileParser::Parse(SceneDefinition& definition)
 		return false;
 	}
 
+	if (degenerateTriangleCount > 0)
+		std::cout << "Skipped " << degenerateTriangleCount << " degenerate triangles, as nothing can hit them." << std::endl;
+
 	std::cout << "Read in and parsed all input! :D" << std::endl;
 	return true;
 }
@@ -905,4 +1017,38 @@ InputFileParser::parse_texture_coordinate(std::string_view line, std::unique_ptr
     stream >> parsedTextureCoordinate->v;
 
     return !stream.fail();
-}
\ No newline at end of file
+}
+
+bool
+InputFileParser::parse_mesh(std::string_view line, std::string& parsedName)
+{
+    std::istringstream stream(line.data());
+
+    // Ignore first keyword...
+    stream.ignore(std::numeric_limits<std::streamsize>::max(), ' ');
+
+    // Mesh Name
+    stream >> parsedName;
+
+    return !stream.fail();
+}
+
+bool
+InputFileParser::parse_instance(std::string_view line, std::string& parsedMeshName, Transform& parsedTransform)
+{
+    std::istringstream stream(line.data());
+
+    // Ignore first keyword...
+    stream.ignore(std::numeric_limits<std::streamsize>::max(), ' ');
+
+    // Mesh Name
+    stream >> parsedMeshName;
+
+    // Object To World Transform (3 rows of 4, the last column being the translation)
+    for (auto& row : parsedTransform.m) {
+        for (float& value : row)
+            stream >> value;
+    }
+
+    return !stream.fail();
+}
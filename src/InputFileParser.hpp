@@ -6,10 +6,12 @@
 #include <cstdio>
 #include <filesystem>
 #include <fstream>
+#include <istream>
 #include <vector>
 #include <optional>
 
 #include "core/Light.hpp"
+#include "core/Transform.hpp"
 #include "core/TypeDefinitions.hpp"
 #include "GraphicsEngine.hpp"
 
@@ -25,6 +27,8 @@ public:
 	void Close();
 
 	bool Parse(SceneDefinition& definition);
+	// Parses a scene definition from 'input' rather than from the open file.
+	bool Parse(std::istream& input, SceneDefinition& definition);
 
 private:
 	bool parse_eye_position(std::string_view line, Point3D& parsedPosition);
@@ -50,6 +54,10 @@ private:
     bool parse_texture(std::string_view line, std::filesystem::path& parsedTexturePath);
     bool parse_texture_coordinate(std::string_view line, std::unique_ptr<TextureCoordinate>& parsedTextureCoordinate);
 
+	// Extra
+	bool parse_mesh(std::string_view line, std::string& parsedName);
+	bool parse_instance(std::string_view line, std::string& parsedMeshName, Transform& parsedTransform);
+
 private:
 	std::ifstream fInputFile;
 };
@@ -0,0 +1,182 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+/** JsonWriter */
+
+// Writes JSON out to a stream as it's built up, one value at a time, taking care of the commas and indentation.
+// Objects and arrays are opened and closed in pairs, and every value in an object is preceded by its Key().
+class JsonWriter {
+public:
+	explicit JsonWriter(std::ostream& out)
+		:
+		fOut(out),
+		fFirstInScope(),
+		fAfterKey(false)
+	{
+	}
+
+	void BeginObject() { Open_('{'); }
+	void EndObject() { Close_('}'); }
+	void BeginArray() { Open_('['); }
+	void EndArray() { Close_(']'); }
+
+	void
+	Key(std::string_view key)
+	{
+		Separate_();
+		WriteString_(key);
+		fOut << ": ";
+		fAfterKey = true;
+	}
+
+	void
+	Value(std::string_view value)
+	{
+		Separate_();
+		WriteString_(value);
+	}
+
+	void Value(const char* value) { Value(std::string_view(value)); }
+
+	void
+	Value(bool value)
+	{
+		Separate_();
+		fOut << (value ? "true" : "false");
+	}
+
+	template<std::integral T>
+	void
+	Value(T value)
+	{
+		Separate_();
+		fOut << +value;
+	}
+
+	void
+	Value(double value)
+	{
+		Separate_();
+
+		// JSON has no infinities or NaNs.
+		if (!std::isfinite(value)) {
+			fOut << "null";
+			return;
+		}
+
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+		fOut << buffer;
+	}
+
+	void Value(float value) { Value(static_cast<double>(value)); }
+
+	// Description: Writes out the key 'key' along with its value 'value'.
+	template<typename T>
+	void
+	Field(std::string_view key, const T& value)
+	{
+		Key(key);
+		Value(value);
+	}
+
+private:
+	void
+	Open_(char bracket)
+	{
+		Separate_();
+		fOut << bracket;
+		fFirstInScope.push_back(true);
+	}
+
+	void
+	Close_(char bracket)
+	{
+		const bool empty = fFirstInScope.back();
+		fFirstInScope.pop_back();
+		if (!empty)
+			Newline_();
+		fOut << bracket;
+
+		if (fFirstInScope.empty())
+			fOut << '\n';
+	}
+
+	// Puts a comma between this value and the last one in the same object or array, unless it's the value of a key.
+	void
+	Separate_()
+	{
+		if (fAfterKey) {
+			fAfterKey = false;
+			return;
+		}
+
+		if (fFirstInScope.empty())
+			return;
+
+		if (!fFirstInScope.back())
+			fOut << ',';
+		fFirstInScope.back() = false;
+		Newline_();
+	}
+
+	void
+	Newline_()
+	{
+		fOut << '\n';
+		for (std::size_t level = 0; level < fFirstInScope.size(); level++)
+			fOut << "  ";
+	}
+
+	void
+	WriteString_(std::string_view text)
+	{
+		fOut << '"';
+		for (char character : text) {
+			switch (character) {
+				case '"':
+					fOut << "\\\"";
+					break;
+				case '\\':
+					fOut << "\\\\";
+					break;
+				case '\n':
+					fOut << "\\n";
+					break;
+				case '\r':
+					fOut << "\\r";
+					break;
+				case '\t':
+					fOut << "\\t";
+					break;
+				default:
+					if (static_cast<unsigned char>(character) < 0x20) {
+						char escape[8];
+						std::snprintf(escape, sizeof(escape), "\\u%04x", character);
+						fOut << escape;
+					} else {
+						fOut << character;
+					}
+			}
+		}
+		fOut << '"';
+	}
+
+	std::ostream& fOut;
+
+	// For each object or array that's open, whether nothing's been written into it yet.
+	std::vector<bool> fFirstInScope;
+	bool fAfterKey;
+};
+
+#endif // JSON_WRITER_H
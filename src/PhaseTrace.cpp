@@ -0,0 +1,178 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "PhaseTrace.hpp"
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string_view>
+
+#include <omp.h>
+
+#include "JsonWriter.hpp"
+
+/* Clock Helpers */
+
+// Description: Returns how much CPU time 'clock', one of the CPU time clocks, has measured.
+static double
+cpu_microseconds(clockid_t clock)
+{
+	timespec time{};
+	clock_gettime(clock, &time);
+	return (static_cast<double>(time.tv_sec) * 1e6) + (static_cast<double>(time.tv_nsec) / 1e3);
+}
+
+
+/* PhaseTrace */
+
+static std::mutex sEventsMutex;
+static std::vector<PhaseTrace::Event> sEvents;
+
+void
+PhaseTrace::Start()
+{
+	std::lock_guard lock(sEventsMutex);
+	sEvents.clear();
+	sStartTime = std::chrono::steady_clock::now();
+	sRecording = true;
+}
+
+void
+PhaseTrace::Record(Event event)
+{
+	std::lock_guard lock(sEventsMutex);
+	sEvents.push_back(std::move(event));
+}
+
+double
+PhaseTrace::MicrosecondsSinceStart()
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sStartTime).count();
+}
+
+void
+PhaseTrace::PrintPhases(std::ostream& out)
+{
+	std::lock_guard lock(sEventsMutex);
+
+	// Phases are recorded as they finish, so ones inside others come first.
+	std::vector<const Event*> phases;
+	for (const Event& event : sEvents) {
+		if (std::string_view(event.category) == "phase")
+			phases.push_back(&event);
+	}
+
+	std::stable_sort(phases.begin(), phases.end(), [](const Event* a, const Event* b) {
+		return a->startMicroseconds < b->startMicroseconds;
+	});
+
+	out << std::fixed << std::setprecision(6);
+	for (const Event* phase : phases) {
+		out << "\t" << phase->name << ": " << (phase->wallMicroseconds / 1e6) << "s wall, "
+			<< (phase->processCpuMicroseconds / 1e6) << "s CPU" << std::endl;
+	}
+	out << std::defaultfloat << std::setprecision(6);
+}
+
+bool
+PhaseTrace::WriteChromeTrace(const std::filesystem::path& tracePath)
+{
+	std::ofstream traceFile(tracePath);
+	if (traceFile.fail()) {
+		std::cerr << "(Error) Failed to open the trace for writing at path: " << tracePath << std::endl;
+		return false;
+	}
+
+	std::lock_guard lock(sEventsMutex);
+
+	uint32_t threadCount = 1;
+	for (const Event& event : sEvents)
+		threadCount = std::max(threadCount, event.threadIndex + 1);
+
+	JsonWriter json(traceFile);
+	json.BeginObject();
+	json.Field("displayTimeUnit", "ms");
+	json.Key("traceEvents");
+	json.BeginArray();
+
+	// Name each thread the way the tile scheduler's report does.
+	for (uint32_t threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+		json.BeginObject();
+		json.Field("name", "thread_name");
+		json.Field("ph", "M");
+		json.Field("pid", 1);
+		json.Field("tid", threadIndex);
+		json.Key("args");
+		json.BeginObject();
+		json.Field("name", threadIndex == 0 ? std::string("Main thread") : "Thread " + std::to_string(threadIndex));
+		json.EndObject();
+		json.EndObject();
+	}
+
+	// Complete events, which nest inside one another on the same thread by time.
+	for (const Event& event : sEvents) {
+		json.BeginObject();
+		json.Field("name", event.name);
+		json.Field("cat", event.category);
+		json.Field("ph", "X");
+		json.Field("pid", 1);
+		json.Field("tid", event.threadIndex);
+		json.Field("ts", event.startMicroseconds);
+		json.Field("dur", event.wallMicroseconds);
+		json.Key("args");
+		json.BeginObject();
+		json.Field("threadCpuMicroseconds", event.threadCpuMicroseconds);
+		json.Field("processCpuMicroseconds", event.processCpuMicroseconds);
+		for (const auto& [key, value] : event.arguments)
+			json.Field(key, value);
+		json.EndObject();
+		json.EndObject();
+	}
+
+	json.EndArray();
+	json.EndObject();
+
+	traceFile.close();
+	return !traceFile.fail();
+}
+
+
+/* ScopedPhaseTimer */
+
+ScopedPhaseTimer::ScopedPhaseTimer(const char* name, const char* category)
+	:
+	fRecording(PhaseTrace::IsRecording()),
+	fEvent()
+{
+	if (!fRecording)
+		return;
+
+	fEvent.name = name;
+	fEvent.category = category;
+	fEvent.threadIndex = static_cast<uint32_t>(std::max(omp_get_thread_num(), 0));
+	fEvent.threadCpuMicroseconds = cpu_microseconds(CLOCK_THREAD_CPUTIME_ID);
+	fEvent.processCpuMicroseconds = cpu_microseconds(CLOCK_PROCESS_CPUTIME_ID);
+	fEvent.startMicroseconds = PhaseTrace::MicrosecondsSinceStart();
+}
+
+ScopedPhaseTimer::~ScopedPhaseTimer()
+{
+	if (!fRecording)
+		return;
+
+	fEvent.wallMicroseconds = PhaseTrace::MicrosecondsSinceStart() - fEvent.startMicroseconds;
+	fEvent.threadCpuMicroseconds = cpu_microseconds(CLOCK_THREAD_CPUTIME_ID) - fEvent.threadCpuMicroseconds;
+	fEvent.processCpuMicroseconds = cpu_microseconds(CLOCK_PROCESS_CPUTIME_ID) - fEvent.processCpuMicroseconds;
+	PhaseTrace::Record(std::move(fEvent));
+}
+
+void
+ScopedPhaseTimer::AddArgument(const char* key, int64_t value)
+{
+	if (fRecording)
+		fEvent.arguments.emplace_back(key, value);
+}
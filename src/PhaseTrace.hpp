@@ -0,0 +1,91 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef PHASE_TRACE_H
+#define PHASE_TRACE_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+/** PhaseTrace */
+
+// Records how long each phase of rendering a scene took, and each tile within it, in wall and CPU time and on which
+// thread, so they can be printed out or written as a Chrome trace (for chrome://tracing or Perfetto). Nothing is
+// recorded until Start() is called, so the timers cost next to nothing otherwise.
+class PhaseTrace {
+public:
+	// What something took from start to finish, timed by a ScopedPhaseTimer.
+	struct Event {
+		const char* name;
+
+		// "phase" for the steps of the pipeline, "tile" for each tile rendered within them.
+		const char* category;
+
+		// The OpenMP thread that ran it, where 0 is the main thread.
+		uint32_t threadIndex;
+
+		// When it started, since Start() was called.
+		double startMicroseconds;
+
+		double wallMicroseconds;
+
+		// The CPU time of the thread that ran it, and of the whole process, which is more than the wall time when
+		// other threads were busy alongside it.
+		double threadCpuMicroseconds;
+		double processCpuMicroseconds;
+
+		std::vector<std::pair<const char*, int64_t>> arguments;
+	};
+
+public:
+	PhaseTrace() = delete;
+
+	// Description: Starts recording, with the time it's called as the start of the trace.
+	static void Start();
+
+	// Description: Returns whether anything is being recorded.
+	[[nodiscard]] static bool IsRecording() { return sRecording; }
+
+	// Description: Adds 'event' to the trace. Safe to call from any thread.
+	static void Record(Event event);
+
+	// Description: Returns how long it's been since Start() was called.
+	[[nodiscard]] static double MicrosecondsSinceStart();
+
+	// Description: Prints out the wall and CPU time of each phase recorded to the stream 'out'.
+	static void PrintPhases(std::ostream& out);
+
+	// Description: Writes out every event recorded to 'tracePath', in the Chrome trace event format.
+	// Returns: true if the file was written.
+	static bool WriteChromeTrace(const std::filesystem::path& tracePath);
+
+private:
+	static inline bool sRecording = false;
+	static inline std::chrono::steady_clock::time_point sStartTime;
+};
+
+
+/** ScopedPhaseTimer */
+
+// Times from when it's created to when it's destroyed, and records that in the PhaseTrace, if it's recording.
+class ScopedPhaseTimer {
+public:
+	// Description: Starts timing 'name', which must outlive the trace, as part of 'category'.
+	explicit ScopedPhaseTimer(const char* name, const char* category = "phase");
+	~ScopedPhaseTimer();
+
+	ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+	ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+	// Description: Records 'value' under 'key', which must outlive the trace, along with the time.
+	void AddArgument(const char* key, int64_t value);
+
+private:
+	bool fRecording;
+	PhaseTrace::Event fEvent;
+};
+
+#endif // PHASE_TRACE_H
@@ -12,7 +12,8 @@ ppm_writer_open(const char* outputFileName, PPMWriter* writer)
 	if (outputFileName == nullptr || outputFileName[0] == '\0' || writer == nullptr)
 		return false;
 
-	const size_t outputFileNameLength = strlen(outputFileName) + strlen(kPPMExtension);
+	// Leave room for the terminator, too.
+	const size_t outputFileNameLength = strlen(outputFileName) + strlen(kPPMExtension) + 1;
 	char name[outputFileNameLength];
 	strcpy(name, outputFileName);
 	strcat(name, kPPMExtension);
@@ -51,7 +52,7 @@ ppm_writer_set_image_size(PPMWriter* writer, Size imageSize)
 }
 
 bool
-ppm_writer_write(PPMWriter* writer, const std::vector<PixelInfo>& pixels)
+ppm_writer_write(PPMWriter* writer, const Framebuffer& framebuffer)
 {
 	if (writer == nullptr || writer->outputFile == nullptr)
 		return false;
@@ -69,17 +70,18 @@ ppm_writer_write(PPMWriter* writer, const std::vector<PixelInfo>& pixels)
 	if (pixelCount == 0)
 		return true;
 
-	// Ensure that the passed in pixels is equivalent to the desired size of the PPM image in pixels.
-	if (pixelCount != pixels.size())
+	// Ensure that the passed in framebuffer is equivalent to the desired size of the PPM image in pixels.
+	if (framebuffer.PixelSize().width != writer->width || framebuffer.PixelSize().height != writer->height)
 		return false;
 
 	// Write Out Pixels
+	const ColorRGB* pixels = framebuffer.Pixels();
 	for (size_t index = 0; index < pixelCount; index++) {
 		// Limit to 70 characters per line, so we'll just print
 		result = fprintf(writer->outputFile, "%d %d %d\n",
-						 pixels[index].pixel.red,
-						 pixels[index].pixel.green,
-						 pixels[index].pixel.blue);
+						 pixels[index].red,
+						 pixels[index].green,
+						 pixels[index].blue);
 		if (result < 0) {
 			fprintf(stderr, "Failed to write pixel out...Error: %d\n", result);
 			return false;
@@ -87,4 +89,25 @@ ppm_writer_write(PPMWriter* writer, const std::vector<PixelInfo>& pixels)
 	}
 
 	return true;
-}
\ No newline at end of file
+}
+
+bool
+ppm_writer_write_file(const char* outputName, const Framebuffer& framebuffer)
+{
+	PPMWriter writer{};
+
+	if (!ppm_writer_open(outputName, &writer))
+		return false;
+
+	ppm_writer_set_image_size(&writer, framebuffer.PixelSize());
+
+	// Write out the pixels in ASCII PPM format
+	if (!ppm_writer_write(&writer, framebuffer)) {
+		std::cerr << "Failed to write out pixels to the PPM file." << std::endl;
+		ppm_writer_close(&writer);
+		return false;
+	}
+
+	ppm_writer_close(&writer);
+	return true;
+}
@@ -7,6 +7,7 @@
 #include <cstdint>
 
 #include "core/TypeDefinitions.hpp"
+#include "Framebuffer.hpp"
 
 
 static const char* kPPMExtension = ".ppm";
@@ -27,6 +28,9 @@ bool ppm_writer_open(const char* outputFileName, PPMWriter* writer);
 void ppm_writer_close(PPMWriter* writer);
 
 void ppm_writer_set_image_size(PPMWriter* writer, Size imageSize);
-bool ppm_writer_write(PPMWriter* writer, const std::vector<PixelInfo>& pixels);
+bool ppm_writer_write(PPMWriter* writer, const Framebuffer& framebuffer);
+
+// Writes out framebuffer in ASCII PPM format to a file named outputName with ".ppm" appended, all in one go.
+bool ppm_writer_write_file(const char* outputName, const Framebuffer& framebuffer);
 
 #endif // PPM_WRITER_H
\ No newline at end of file
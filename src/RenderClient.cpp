@@ -0,0 +1,124 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "RenderClient.hpp"
+
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Framebuffer.hpp"
+#include "PpmWriter.hpp"
+#include "RenderJobProtocol.hpp"
+#include "SceneRenderer.hpp"
+
+RenderClient::RenderClient(TransportAddress serverAddress)
+	:
+	fServerAddress(std::move(serverAddress))
+{
+}
+
+bool
+RenderClient::Submit(const RenderOptions& options, std::ostream& log)
+{
+	// The server runs in its own working directory, so it's only ever sent absolute paths.
+	RenderJob job{ options, {}, {} };
+	if (options.inputFilePath == "-") {
+		job.options.inputFilePath.clear();
+		job.sceneText.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+		job.sceneDirectory = std::filesystem::current_path().string() + "/";
+	} else {
+		job.options.inputFilePath = std::filesystem::absolute(options.inputFilePath);
+	}
+
+	const std::filesystem::path outputName = options.outputName.empty() ? job.options.inputFilePath
+		: options.outputName;
+
+	std::unique_ptr<Connection> connection = Connection::Connect(fServerAddress);
+	if (!connection) {
+		std::cerr << "(Error) Couldn't connect to the render server at " << fServerAddress.ToString() << std::endl;
+		return false;
+	}
+
+	MessageWriter submission;
+	write_submitted_job(submission, job);
+	if (!connection->SendMessage(static_cast<uint32_t>(RenderJobMessage::SUBMIT), submission.Bytes())) {
+		std::cerr << "(Error) Lost the render server before the job could be submitted!" << std::endl;
+		return false;
+	}
+
+	uint32_t type = 0;
+	std::vector<uint8_t> payload;
+	while (connection->ReceiveMessage(type, payload)) {
+		MessageReader reader(payload);
+		switch (static_cast<RenderJobMessage>(type)) {
+			case RenderJobMessage::QUEUED:
+			{
+				log << "\tWaiting for the render server to finish its other jobs..." << std::endl;
+				break;
+			}
+
+			case RenderJobMessage::LOADED:
+			{
+				bool sceneWasCached = false;
+				double loadSeconds = 0.0;
+				Size imageSize{};
+				if (!reader.Get(sceneWasCached) || !reader.Get(loadSeconds) || !reader.Get(imageSize))
+					break;
+
+				log << "\tScene " << (sceneWasCached ? "was already loaded, found" : "loaded") << " in " << loadSeconds
+					<< "s, rendering " << imageSize.width << "x" << imageSize.height << " pixels" << std::endl;
+				break;
+			}
+
+			case RenderJobMessage::PROGRESS:
+			{
+				uint32_t tilesDone = 0;
+				uint32_t tileCount = 0;
+				if (reader.Get(tilesDone) && reader.Get(tileCount))
+					log << "\r\tRendered " << tilesDone << " of " << tileCount << " tiles" << std::flush;
+				break;
+			}
+
+			case RenderJobMessage::IMAGE:
+			{
+				double renderSeconds = 0.0;
+				TileRenderStats stats;
+				Size imageSize{};
+				if (!reader.Get(renderSeconds) || !read_render_stats(reader, stats) || !reader.Get(imageSize)) {
+					std::cerr << "(Error) The render server sent an image that couldn't be read!" << std::endl;
+					return false;
+				}
+
+				Framebuffer image(imageSize);
+				if (!reader.GetBytes(image.Row(0), image.PixelCount() * sizeof(ColorRGB))) {
+					std::cerr << "(Error) The render server sent an image that was cut short!" << std::endl;
+					return false;
+				}
+
+				log << "\n\tRendered in " << renderSeconds << "s" << std::endl;
+				SceneRenderer::PrintStats(log, stats, image.PixelCount(), options);
+
+				return ppm_writer_write_file(outputName.c_str(), image);
+			}
+
+			case RenderJobMessage::FAILED:
+			{
+				std::string reason;
+				reader.GetString(reason);
+				std::cerr << "(Error) The render server failed to render the scene: " << reason << std::endl;
+				return false;
+			}
+
+			default:
+			{
+				std::cerr << "(Error) The render server sent a message we didn't expect!" << std::endl;
+				return false;
+			}
+		}
+	}
+
+	std::cerr << "(Error) Lost the render server before the image was sent!" << std::endl;
+	return false;
+}
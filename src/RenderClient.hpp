@@ -0,0 +1,30 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef RENDER_CLIENT_H
+#define RENDER_CLIENT_H
+
+#include <ostream>
+
+#include "RenderOptions.hpp"
+#include "Transport.hpp"
+
+/** RenderClient */
+
+// Has a RenderServer render a scene, rather than rendering it in this process, and writes out the image it sends back.
+class RenderClient {
+public:
+	// Description: Creates a client for the render server listening at 'serverAddress'.
+	explicit RenderClient(TransportAddress serverAddress);
+
+	// Description: Submits the input file of 'options' to be rendered the way they say, or, if the input file is "-",
+	// the scene read from standard input, whose textures are looked for from the working directory. How the job's
+	// going is printed out to the stream 'log', and the image is written out under the output name of 'options', or
+	// else the input file's.
+	// Returns: true if the image was rendered and written out.
+	bool Submit(const RenderOptions& options, std::ostream& log);
+
+private:
+	TransportAddress fServerAddress;
+};
+
+#endif // RENDER_CLIENT_H
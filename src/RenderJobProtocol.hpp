@@ -0,0 +1,75 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef RENDER_JOB_PROTOCOL_H
+#define RENDER_JOB_PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+
+#include "RenderOptions.hpp"
+#include "TileProtocol.hpp"
+#include "Transport.hpp"
+
+/** Render Job Protocol */
+
+// What a RenderClient and a RenderServer say to each other. The client connects and SUBMITs a job: a scene, either the
+// path to its file or its text, and how to render it. If the server's busy rendering other jobs, it says the job's
+// QUEUED. Once the scene's LOADED, the server sends PROGRESS as the tiles are rendered, and then the IMAGE, cropped if
+// the job asked for it, or says the job FAILED at any point, and hangs up.
+// Values are sent in the byte order of the machine sending them, which is always the same one over a UNIX socket.
+enum struct RenderJobMessage : uint32_t {
+	SUBMIT = 1,
+	QUEUED,
+	LOADED,
+	PROGRESS,
+	IMAGE,
+	FAILED
+};
+
+// Sent along with SUBMIT, so a client from a different build isn't rendered for wrongly.
+static constexpr uint32_t kRenderJobProtocolVersion = 2;
+
+// A scene to render and how to render it. The scene is the file at the render options' input file path, or, if that's
+// empty, 'sceneText', as if it were read from a file in 'sceneDirectory'.
+struct RenderJob {
+	RenderOptions options;
+	std::string sceneText;
+	std::string sceneDirectory;
+};
+
+// Description: Writes 'job' into 'writer'.
+inline void
+write_submitted_job(MessageWriter& writer, const RenderJob& job)
+{
+	writer.Put(kRenderJobProtocolVersion);
+	write_render_job(writer, job.options);
+	writer.Put(job.options.tileSize);
+	writer.Put(job.options.cropWindow.has_value());
+	writer.Put(job.options.cropWindow.value_or(Tile{}));
+	writer.Put(job.options.fullFrameOutput);
+	writer.PutString(job.sceneText);
+	writer.PutString(job.sceneDirectory);
+}
+
+// Description: Reads the job written by write_submitted_job() out of 'reader' into 'job'. Its options still need to be
+// checked with RenderOptions::CheckRenderingChoices() before they're used.
+// Returns: false if the message was cut short, had a bool that was anything but 0 or 1, or came from a client speaking
+// another version of the protocol.
+inline bool
+read_submitted_job(MessageReader& reader, RenderJob& job)
+{
+	uint32_t version = 0;
+	bool cropped = false;
+	Tile cropWindow{};
+	if (!reader.Get(version) || version != kRenderJobProtocolVersion || !read_render_job(reader, job.options)
+		|| !reader.Get(job.options.tileSize) || !reader.Get(cropped) || !reader.Get(cropWindow)
+		|| !reader.Get(job.options.fullFrameOutput))
+		return false;
+
+	if (cropped)
+		job.options.cropWindow = cropWindow;
+
+	return reader.GetString(job.sceneText) && reader.GetString(job.sceneDirectory);
+}
+
+#endif // RENDER_JOB_PROTOCOL_H
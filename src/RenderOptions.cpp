@@ -0,0 +1,526 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "RenderOptions.hpp"
+
+#include <array>
+#include <charconv>
+#include <iostream>
+#include <string_view>
+
+#include "core/RayStats.hpp"
+
+// Description: Parses 'argument' as a whole number into 'parsedValue'.
+// Returns: true if the whole argument was a whole number.
+static bool
+parse_whole_number(std::string_view argument, uint32_t& parsedValue)
+{
+	uint32_t value = 0;
+	const auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), value);
+	if (error != std::errc() || end != argument.data() + argument.size())
+		return false;
+
+	parsedValue = value;
+	return true;
+}
+
+// Description: Parses 'argument' as a positive whole number into 'parsedValue'.
+// Returns: true if the whole argument was a positive whole number.
+static bool
+parse_positive_integer(std::string_view argument, uint32_t& parsedValue)
+{
+	uint32_t value = 0;
+	if (!parse_whole_number(argument, value) || value == 0)
+		return false;
+
+	parsedValue = value;
+	return true;
+}
+
+// Description: Parses 'argument' as a number from 0.0 to 1.0 into 'parsedValue'.
+// Returns: true if the whole argument was a number in that range.
+static bool
+parse_fraction(std::string_view argument, float& parsedValue)
+{
+	float value = 0.f;
+	const auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), value);
+	if (error != std::errc() || end != argument.data() + argument.size() || !(value >= 0.f && value <= 1.f))
+		return false;
+
+	parsedValue = value;
+	return true;
+}
+
+// Description: Parses 'argument' as a rectangle of pixels, written as "<x>,<y>,<width>,<height>", into 'parsedWindow'.
+// Returns: true if the whole argument was a rectangle with a positive width and height.
+static bool
+parse_crop_window(std::string_view argument, std::optional<Tile>& parsedWindow)
+{
+	std::array<uint32_t, 4> values{};
+	for (std::size_t index = 0; index < values.size(); index++) {
+		const std::size_t comma = argument.find(',');
+		const bool isLast = index + 1 == values.size();
+		if (isLast != (comma == std::string_view::npos) || !parse_whole_number(argument.substr(0, comma), values[index]))
+			return false;
+
+		argument.remove_prefix(isLast ? argument.size() : comma + 1);
+	}
+
+	const auto& [x, y, width, height] = values;
+	if (width == 0 || height == 0)
+		return false;
+
+	parsedWindow = Tile{ x, y, width, height };
+	return true;
+}
+
+// Description: Parses 'argument' as a transport address into 'parsedAddress'. The path of a UNIX domain socket is made
+// absolute, so it still means the same socket once the working directory changes.
+// Returns: true if the argument was an address.
+static bool
+parse_transport_address(std::string_view argument, std::optional<TransportAddress>& parsedAddress)
+{
+	std::optional<TransportAddress> address = TransportAddress::Parse(argument);
+	if (address && address->kind == TransportAddress::Kind::UNIX)
+		address = TransportAddress::Parse("unix:" + std::filesystem::absolute(address->path).string());
+
+	if (!address)
+		return false;
+
+	parsedAddress = std::move(address);
+	return true;
+}
+
+std::optional<RenderOptions>
+RenderOptions::FromArguments(int argc, char* argv[])
+{
+	RenderOptions options;
+
+	for (int index = 1; index < argc; index++) {
+		const std::string_view argument = argv[index];
+
+		if (argument == "--no-packets") {
+			options.packetTracing = false;
+			continue;
+		}
+
+		if (argument == "--wavefront") {
+			options.wavefrontRendering = true;
+			continue;
+		}
+
+		if (argument == "--depth") {
+			if (index + 1 >= argc || !parse_whole_number(argv[index + 1], options.depth)) {
+				std::cerr << "--depth needs a whole number of bounces!" << std::endl;
+				return {};
+			}
+
+			index++;
+			continue;
+		}
+
+		if (argument == "--progressive") {
+			options.progressiveRendering = true;
+			continue;
+		}
+
+		if (argument == "--max-samples") {
+			if (index + 1 >= argc || !parse_positive_integer(argv[index + 1], options.maxSamples)) {
+				std::cerr << "--max-samples needs a positive number of samples!" << std::endl;
+				return {};
+			}
+
+			index++;
+			continue;
+		}
+
+		if (argument == "--tile-size") {
+			if (index + 1 >= argc || !parse_positive_integer(argv[index + 1], options.tileSize)) {
+				std::cerr << "--tile-size needs a positive number of pixels!" << std::endl;
+				return {};
+			}
+
+			index++;
+			continue;
+		}
+
+		if (argument == "--crop") {
+			if (index + 1 >= argc || !parse_crop_window(argv[index + 1], options.cropWindow)) {
+				std::cerr << "--crop needs a rectangle of pixels, like <x>,<y>,<width>,<height>!" << std::endl;
+				return {};
+			}
+
+			index++;
+			continue;
+		}
+
+		if (argument == "--full-frame") {
+			options.fullFrameOutput = true;
+			continue;
+		}
+
+		if (argument == "--min-weight") {
+			if (index + 1 >= argc || !parse_fraction(argv[index + 1], options.minimumRayWeight)) {
+				std::cerr << "--min-weight needs a weight from 0.0 to 1.0!" << std::endl;
+				return {};
+			}
+
+			index++;
+			continue;
+		}
+
+		if (argument == "--russian-roulette") {
+			options.russianRoulette = true;
+			continue;
+		}
+
+		if (argument == "--batch" || argument == "--summary") {
+			if (index + 1 >= argc || argv[index + 1][0] == '\0') {
+				std::cerr << argument << " needs a path!" << std::endl;
+				return {};
+			}
+
+			(argument == "--batch" ? options.batchManifestPath : options.batchSummaryPath) = argv[index + 1];
+			index++;
+			continue;
+		}
+
+		if (argument == "--coordinator") {
+			if (index + 1 >= argc || !parse_transport_address(argv[index + 1], options.coordinatorAddress)) {
+				std::cerr << "--coordinator needs an address, like unix:<path> or tcp:<host>:<port>!" << std::endl;
+				return {};
+			}
+
+			index++;
+			continue;
+		}
+
+		if (argument == "--workers") {
+			if (index + 1 >= argc || !parse_whole_number(argv[index + 1], options.workerCount)) {
+				std::cerr << "--workers needs a whole number of processes!" << std::endl;
+				return {};
+			}
+
+			index++;
+			continue;
+		}
+
+		if (argument == "--worker-timeout") {
+			if (index + 1 >= argc || !parse_positive_integer(argv[index + 1], options.workerTimeoutSeconds)) {
+				std::cerr << "--worker-timeout needs a positive number of seconds!" << std::endl;
+				return {};
+			}
+
+			index++;
+			continue;
+		}
+
+		if (argument == "--worker") {
+			if (index + 1 >= argc || !parse_transport_address(argv[index + 1], options.workerAddress)) {
+				std::cerr << "--worker needs an address, like unix:<path> or tcp:<host>:<port>!" << std::endl;
+				return {};
+			}
+
+			index++;
+			continue;
+		}
+
+		if (argument == "--serve" || argument == "--submit") {
+			std::optional<TransportAddress>& address = argument == "--serve" ? options.serverAddress
+				: options.submitAddress;
+			if (index + 1 >= argc || !parse_transport_address(argv[index + 1], address)
+				|| address->kind != TransportAddress::Kind::UNIX) {
+				std::cerr << argument << " needs the address of a UNIX domain socket, like unix:<path>!" << std::endl;
+				return {};
+			}
+
+			index++;
+			continue;
+		}
+
+		if (argument == "--max-jobs") {
+			if (index + 1 >= argc || !parse_positive_integer(argv[index + 1], options.maxConcurrentJobs)) {
+				std::cerr << "--max-jobs needs a positive number of jobs!" << std::endl;
+				return {};
+			}
+
+			index++;
+			continue;
+		}
+
+		if (argument == "--output") {
+			if (index + 1 >= argc || argv[index + 1][0] == '\0') {
+				std::cerr << "--output needs a name!" << std::endl;
+				return {};
+			}
+
+			options.outputName = argv[index + 1];
+			index++;
+			continue;
+		}
+
+		if (argument == "--stats") {
+			if (index + 1 >= argc || argv[index + 1][0] == '\0') {
+				std::cerr << "--stats needs a path!" << std::endl;
+				return {};
+			}
+
+			options.rayStatsPath = argv[index + 1];
+			index++;
+			continue;
+		}
+
+		if (argument == "--trace") {
+			if (index + 1 >= argc || argv[index + 1][0] == '\0') {
+				std::cerr << "--trace needs a path!" << std::endl;
+				return {};
+			}
+
+			options.tracePath = argv[index + 1];
+			index++;
+			continue;
+		}
+
+		if (argument == "--heatmap") {
+			if (index + 1 >= argc || !(options.heatmapMetric = CostHeatmap::MetricNamed(argv[index + 1]))) {
+				std::cerr << "--heatmap needs one of cycles, rays, or tests!" << std::endl;
+				return {};
+			}
+
+			index++;
+			continue;
+		}
+
+		if (argument.starts_with("--")) {
+			std::cerr << "Unknown option: " << argument << std::endl;
+			return {};
+		}
+
+		// Anything else is the input file, of which there can only be one.
+		if (!options.inputFilePath.empty()) {
+			std::cerr << "Only one input file can be rendered at a time!" << std::endl;
+			return {};
+		}
+
+		options.inputFilePath = argument;
+	}
+
+	// A worker is told what to render by its coordinator.
+	if (options.workerAddress)
+		return options;
+
+	// A render server is told what to render, and how, by each job.
+	if (options.serverAddress) {
+		if (!options.inputFilePath.empty() || !options.batchManifestPath.empty() || options.coordinatorAddress
+			|| options.submitAddress) {
+			std::cerr << "--serve renders the jobs it's sent, and can't be combined with an input file or another mode!"
+				<< std::endl;
+			return {};
+		}
+
+		return options;
+	}
+
+	if (options.maxConcurrentJobs != 1) {
+		std::cerr << "--max-jobs is only for --serve!" << std::endl;
+		return {};
+	}
+
+	if (options.submitAddress) {
+		if (!options.batchManifestPath.empty() || options.coordinatorAddress) {
+			std::cerr << "--submit can't be combined with --batch or --coordinator!" << std::endl;
+			return {};
+		}
+
+		if (!options.CheckServerChoices(std::cerr))
+			return {};
+
+		if (options.inputFilePath == "-" && options.outputName.empty()) {
+			std::cerr << "--submit needs an --output name for a scene read from standard input!" << std::endl;
+			return {};
+		}
+	} else if (!options.outputName.empty()) {
+		std::cerr << "--output is only for --submit!" << std::endl;
+		return {};
+	}
+
+	if (!options.batchManifestPath.empty()) {
+		if (!options.inputFilePath.empty()) {
+			std::cerr << "--batch renders the scenes its manifest lists, not an input file!" << std::endl;
+			return {};
+		}
+
+		if (options.coordinatorAddress) {
+			std::cerr << "--batch can't be combined with --coordinator!" << std::endl;
+			return {};
+		}
+
+		if (options.batchSummaryPath.empty()) {
+			options.batchSummaryPath = options.batchManifestPath;
+			options.batchSummaryPath += ".json";
+		}
+	} else if (!options.batchSummaryPath.empty()) {
+		std::cerr << "--summary is only for --batch!" << std::endl;
+		return {};
+	} else if (options.inputFilePath.empty()) {
+		return {};
+	}
+
+	if (!options.CheckRenderingChoices(std::cerr))
+		return {};
+
+	if (options.progressiveRendering && options.coordinatorAddress) {
+		std::cerr << "--progressive can't be combined with --coordinator!" << std::endl;
+		return {};
+	}
+
+	if (options.workerTimeoutSeconds != kDefaultWorkerTimeout && !options.coordinatorAddress) {
+		std::cerr << "--worker-timeout is only for --coordinator!" << std::endl;
+		return {};
+	}
+
+	if (options.coordinatorAddress && options.coordinatorAddress->kind == TransportAddress::Kind::TCP
+		&& options.coordinatorAddress->port == 0 && options.workerCount == 0) {
+		std::cerr << "--coordinator needs a port for workers started elsewhere to connect to!" << std::endl;
+		return {};
+	}
+
+	if (!options.rayStatsPath.empty()) {
+		if (!RayStats::kEnabled) {
+			std::cerr << "--stats needs a build configured with -DRAYTRACER_STATS=ON!" << std::endl;
+			return {};
+		}
+
+		// Rays are only counted by the process that traces them.
+		if (!options.batchManifestPath.empty() || options.coordinatorAddress || options.submitAddress) {
+			std::cerr << "--stats can't be combined with --batch, --coordinator, or --submit!" << std::endl;
+			return {};
+		}
+	}
+
+	// Only a single scene rendered in this process is traced, though a coordinator's own phases are.
+	if (!options.tracePath.empty() && (!options.batchManifestPath.empty() || options.submitAddress)) {
+		std::cerr << "--trace can't be combined with --batch or --submit!" << std::endl;
+		return {};
+	}
+
+	if (options.heatmapMetric) {
+		if (!CostHeatmap::IsMeasurable(*options.heatmapMetric)) {
+			std::cerr << "--heatmap " << CostHeatmap::MetricName(*options.heatmapMetric)
+				<< " needs a build configured with -DRAYTRACER_STATS=ON!" << std::endl;
+			return {};
+		}
+
+		// Costs are measured pixel by pixel, in this process.
+		if (options.wavefrontRendering || options.progressiveRendering || !options.batchManifestPath.empty()
+			|| options.coordinatorAddress) {
+			std::cerr << "--heatmap can't be combined with --wavefront, --progressive, --batch, or --coordinator!"
+				<< std::endl;
+			return {};
+		}
+	}
+
+	return options;
+}
+
+bool
+RenderOptions::CheckRenderingChoices(std::ostream& errors) const
+{
+	if (depth > kMaxDepth) {
+		errors << "--depth can be at most " << kMaxDepth << " bounces!" << std::endl;
+		return false;
+	}
+
+	if (maxSamples == 0 || maxSamples > kMaxSamples) {
+		errors << "--max-samples needs from 1 to " << kMaxSamples << " samples!" << std::endl;
+		return false;
+	}
+
+	if (tileSize == 0 || tileSize > kMaxTileSize) {
+		errors << "--tile-size needs from 1 to " << kMaxTileSize << " pixels!" << std::endl;
+		return false;
+	}
+
+	if (cropWindow && (cropWindow->width == 0 || cropWindow->height == 0)) {
+		errors << "--crop needs a rectangle of pixels with a positive width and height!" << std::endl;
+		return false;
+	}
+
+	if (!(minimumRayWeight >= 0.f && minimumRayWeight <= 1.f)) {
+		errors << "--min-weight needs a weight from 0.0 to 1.0!" << std::endl;
+		return false;
+	}
+
+	if (progressiveRendering && maxSamples > 1) {
+		errors << "--progressive can't be combined with --max-samples!" << std::endl;
+		return false;
+	}
+
+	if (progressiveRendering && wavefrontRendering) {
+		errors << "--progressive can't be combined with --wavefront!" << std::endl;
+		return false;
+	}
+
+	if (fullFrameOutput && !cropWindow) {
+		errors << "--full-frame is only for --crop!" << std::endl;
+		return false;
+	}
+
+	if (russianRoulette && minimumRayWeight <= 0.f) {
+		errors << "--russian-roulette needs a --min-weight above 0!" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool
+RenderOptions::CheckServerChoices(std::ostream& errors) const
+{
+	// Progressive previews and heatmaps would be written out next to the scene, on the server's side.
+	if (progressiveRendering) {
+		errors << "--progressive can't be used for a job rendered by a render server!" << std::endl;
+		return false;
+	}
+
+	if (heatmapMetric) {
+		errors << "--heatmap can't be used for a job rendered by a render server!" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+void
+RenderOptions::PrintUsage(std::ostream& out, const char* programName)
+{
+	out << "Usage: " << programName << " [options] <Path to input file>" << std::endl;
+	out << "       " << programName << " [options] --batch <Path to manifest listing input files>" << std::endl;
+	out << "       " << programName << " --worker <address>" << std::endl;
+	out << "       " << programName << " --serve unix:<path> [--max-jobs <n>]" << std::endl;
+	out << "       " << programName << " [options] --submit unix:<path> [--output <name>] <Path to input file, or - for standard input>" << std::endl;
+	out << "Options:" << std::endl;
+	out << "\t--no-packets\tTrace every ray on its own, rather than in packets of coherent rays" << std::endl;
+	out << "\t--wavefront\tRender each tile a generation of rays at a time, rather than following each ray's bounces recursively" << std::endl;
+	out << "\t--depth <n>\tReflect and refract rays up to n times, at most " << kMaxDepth << " (default: 2)" << std::endl;
+	out << "\t--progressive\tRender in passes of 1/16, 1/4, then all of the pixels, writing out a preview after each of the first two" << std::endl;
+	out << "\t--max-samples <n>\tAntialias by giving pixels that contrast with their neighbours up to n samples, at most " << kMaxSamples << " (default: 1)" << std::endl;
+	out << "\t--tile-size <n>\tRender the image in tiles of n by n pixels, at most " << kMaxTileSize << " (default: 16)" << std::endl;
+	out << "\t--crop <x>,<y>,<w>,<h>\tOnly render the w by h pixels from (x, y), writing out just those" << std::endl;
+	out << "\t--full-frame\tWrite out the whole image when cropping, with the pixels outside the crop the background color" << std::endl;
+	out << "\t--min-weight <w>\tDon't trace reflected and refracted rays that add less than w, from 0.0 to 1.0, to their pixel (default: 0)" << std::endl;
+	out << "\t--russian-roulette\tTrace rays under the minimum weight with a chance in proportion to their weight, brightening the ones that are traced to make up for the rest" << std::endl;
+	out << "\t--batch <manifest>\tRender every scene listed in manifest, one per line, in this one process" << std::endl;
+	out << "\t--summary <path>\tWrite how long each scene in the batch took to path, as JSON (default: <manifest>.json)" << std::endl;
+	out << "\t--coordinator <address>\tHand tiles out to worker processes connecting at unix:<path> or tcp:<host>:<port>, rather than rendering them here" << std::endl;
+	out << "\t--workers <n>\tStart n worker processes on this machine for the coordinator (default: one per core)" << std::endl;
+	out << "\t--worker-timeout <s>\tHand a worker's tiles out again if it goes s seconds without finishing one (default: " << kDefaultWorkerTimeout << ")" << std::endl;
+	out << "\t--worker <address>\tRender tiles for the coordinator at address, until it's finished" << std::endl;
+	out << "\t--serve unix:<path>\tStay running, rendering the jobs submitted at the UNIX domain socket path" << std::endl;
+	out << "\t--max-jobs <n>\tRender up to n submitted jobs at once, sharing the cores between them (default: 1)" << std::endl;
+	out << "\t--submit unix:<path>\tHave the render server at path render the input file, rather than rendering it here" << std::endl;
+	out << "\t--output <name>\tWrite the submitted job's image to <name>.ppm (default: <input file>.ppm)" << std::endl;
+	out << "\t--stats <path>\tWrite how many rays were traced and intersection tests done to path, as JSON (builds with RAYTRACER_STATS only)" << std::endl;
+	out << "\t--trace <path>\tPrint how long each phase took, and write it and each tile to path, as a Chrome trace for chrome://tracing or Perfetto" << std::endl;
+	out << "\t--heatmap <metric>\tWrite a heatmap of what each pixel cost, in cycles, rays, or tests (builds with RAYTRACER_STATS only), to <input file>.heatmap.ppm" << std::endl;
+}
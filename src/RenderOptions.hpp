@@ -0,0 +1,152 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef RENDER_OPTIONS_H
+#define RENDER_OPTIONS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <thread>
+
+#include "CostHeatmap.hpp"
+#include "TileScheduler.hpp"
+#include "Transport.hpp"
+
+/** RenderOptions */
+
+// Everything about how to render a scene that comes from the command line, rather than from the scene definition.
+struct RenderOptions {
+	// The most bounces, samples per pixel, and pixels across a tile that can be asked for.
+	static constexpr uint32_t kMaxDepth = 64;
+	static constexpr uint32_t kMaxSamples = 1024;
+	static constexpr uint32_t kMaxTileSize = 1024;
+
+	// How many seconds a worker has to finish a tile before the coordinator gives up on it, unless told otherwise.
+	static constexpr uint32_t kDefaultWorkerTimeout = 60;
+
+	std::filesystem::path inputFilePath;
+
+	// A file listing scenes to render one after another, rather than the one input file.
+	std::filesystem::path batchManifestPath;
+
+	// Where to write out how long each scene in the batch took, as JSON.
+	std::filesystem::path batchSummaryPath;
+
+	// Trace primary rays, and the shadow rays towards directional lights, in packets rather than one at a time.
+	bool packetTracing;
+
+	// Render each tile a generation of rays at a time, rather than following each ray's bounces recursively.
+	bool wavefrontRendering;
+
+	// How many times rays are reflected and refracted.
+	uint32_t depth;
+
+	// Render in coarse to fine passes, writing out a preview image after each pass but the last.
+	bool progressiveRendering;
+
+	// The most samples any one pixel can be given when antialiasing, where 1 means no antialiasing at all.
+	uint32_t maxSamples;
+
+	// The width and height, in pixels, of the tiles the image is split into for rendering.
+	uint32_t tileSize;
+
+	// The only rectangle of pixels to render, if not the whole image.
+	std::optional<Tile> cropWindow;
+
+	// Write out the whole image, with the pixels outside the crop window left the background color, rather than only
+	// the pixels inside it.
+	bool fullFrameOutput;
+
+	// Reflected and refracted rays that add less than this much to their pixel aren't traced. 0 traces every ray.
+	float minimumRayWeight;
+
+	// Give rays under the minimum weight a chance of being traced anyway, rather than always cutting them off.
+	bool russianRoulette;
+
+	// Where to listen for worker processes to hand tiles out to, rather than rendering them in this one.
+	std::optional<TransportAddress> coordinatorAddress;
+
+	// How many worker processes the coordinator starts on this machine.
+	uint32_t workerCount;
+
+	// How many seconds a worker can go without finishing one of the tiles it's been sent, before the coordinator gives up
+	// on it and hands them out again.
+	uint32_t workerTimeoutSeconds;
+
+	// Where the coordinator to render tiles for is listening, when this process is a worker.
+	std::optional<TransportAddress> workerAddress;
+
+	// Where to listen for render jobs, when this process stays running as a render server.
+	std::optional<TransportAddress> serverAddress;
+
+	// How many jobs the render server renders at once.
+	uint32_t maxConcurrentJobs;
+
+	// Where the render server to hand the input file to is listening, rather than rendering it in this process.
+	std::optional<TransportAddress> submitAddress;
+
+	// The name to write the image out under, with ".ppm" appended, rather than the input file's.
+	std::filesystem::path outputName;
+
+	// Where to write out how many rays were traced and intersection tests done, as JSON. Only builds with
+	// RAYTRACER_STATS count them.
+	std::filesystem::path rayStatsPath;
+
+	// Where to write out how long each phase of rendering, and each tile, took, as a Chrome trace.
+	std::filesystem::path tracePath;
+
+	// What to measure each pixel's cost in, for a heatmap written out next to the image.
+	std::optional<CostHeatmap::Metric> heatmapMetric;
+
+public:
+	RenderOptions()
+		:
+		inputFilePath(),
+		batchManifestPath(),
+		batchSummaryPath(),
+		packetTracing(true),
+		wavefrontRendering(false),
+		depth(2),
+		progressiveRendering(false),
+		maxSamples(1),
+		tileSize(16),
+		cropWindow(),
+		fullFrameOutput(false),
+		minimumRayWeight(0.f),
+		russianRoulette(false),
+		coordinatorAddress(),
+		workerCount(std::max(1u, std::thread::hardware_concurrency())),
+		workerTimeoutSeconds(kDefaultWorkerTimeout),
+		workerAddress(),
+		serverAddress(),
+		maxConcurrentJobs(1),
+		submitAddress(),
+		outputName(),
+		rayStatsPath(),
+		tracePath(),
+		heatmapMetric()
+	{
+	}
+
+	// Description: Parses the command line arguments the program was started with.
+	// Returns: The parsed options, or nothing if the arguments are invalid.
+	static std::optional<RenderOptions> FromArguments(int argc, char* argv[]);
+
+	// Description: Checks that the choices of how to render the scene are in range and can be combined, printing out
+	// what's wrong with them to the stream 'errors'. Choices sent over by another process are checked the same way as
+	// those from the command line.
+	// Returns: true if they can be rendered.
+	[[nodiscard]] bool CheckRenderingChoices(std::ostream& errors) const;
+
+	// Description: Checks that a render server can honour the choices for a job submitted to it, printing out what it
+	// can't to the stream 'errors'. The server only sends back the image, so nothing else can be written out.
+	// Returns: true if the server can render the job.
+	[[nodiscard]] bool CheckServerChoices(std::ostream& errors) const;
+
+	// Description: Prints out how to use the program, called 'programName', to the stream 'out'.
+	static void PrintUsage(std::ostream& out, const char* programName);
+};
+
+#endif // RENDER_OPTIONS_H
@@ -0,0 +1,408 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "RenderServer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <omp.h>
+#include <poll.h>
+
+#include "Framebuffer.hpp"
+#include "SceneLoader.hpp"
+#include "SceneRenderer.hpp"
+#include "TextureCache.hpp"
+
+// How often a job's progress is sent to its client, at most.
+static constexpr auto kProgressInterval = std::chrono::milliseconds(100);
+
+// Set once the process has been interrupted or terminated.
+static volatile std::sig_atomic_t sStopRequested = 0;
+
+static void
+request_stop(int)
+{
+	sStopRequested = 1;
+}
+
+// Description: Returns how many seconds have passed since 'startTime'.
+static double
+seconds_since(std::chrono::steady_clock::time_point startTime)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+// Description: Returns the key the scene defined by 'sceneText', with textures in 'sceneDirectory', is kept under. How
+// rays are pruned is part of it too, as that's chosen on the scene itself, which can't change once it's shared.
+static std::string
+scene_key(const std::string& sceneText, const std::filesystem::path& sceneDirectory, const RenderOptions& options)
+{
+	std::string key = sceneDirectory.string();
+	key += '\0';
+	key += std::to_string(std::bit_cast<uint32_t>(options.minimumRayWeight));
+	key += options.russianRoulette ? "+roulette" : "";
+	key += '\0';
+	key += sceneText;
+	return key;
+}
+
+// Description: Returns when each texture file used by 'scene', which are found in 'sceneDirectory', was last written to.
+static std::map<std::filesystem::path, std::filesystem::file_time_type>
+texture_write_times(const SceneDefinition& scene, const std::filesystem::path& sceneDirectory)
+{
+	std::map<std::filesystem::path, std::filesystem::file_time_type> writeTimes;
+	const auto addTexture = [&](const SharedObject& object) {
+		if (object->texturePath.empty())
+			return;
+
+		const std::filesystem::path texturePath = TextureCache::TexturePath(sceneDirectory, object->texturePath);
+		std::error_code error;
+		writeTimes.emplace(texturePath, std::filesystem::last_write_time(texturePath, error));
+	};
+
+	for (const auto& object : scene.objectList)
+		addTexture(object);
+
+	for (const auto& [name, mesh] : scene.meshMap) {
+		for (const auto& triangle : mesh->Triangles())
+			addTexture(triangle);
+	}
+
+	return writeTimes;
+}
+
+RenderServer::RenderServer(std::unique_ptr<Listener> listener, uint32_t maxConcurrentJobs)
+	:
+	fListener(std::move(listener)),
+	fMaxConcurrentJobs(std::max(1u, maxConcurrentJobs)),
+	fRenderThreads(),
+	fQueueMutex(),
+	fQueueChanged(),
+	fQueue(),
+	fBusyThreads(0),
+	fJobCount(0),
+	fStopping(false),
+	fSceneMutex(),
+	fScenes(),
+	fSceneUseCount(0),
+	fLogMutex()
+{
+}
+
+RenderServer::~RenderServer()
+{
+	{
+		std::lock_guard lock(fQueueMutex);
+		fStopping = true;
+	}
+
+	fQueueChanged.notify_all();
+	for (std::thread& renderThread : fRenderThreads)
+		renderThread.join();
+}
+
+bool
+RenderServer::Run(std::ostream& log)
+{
+	// Without SA_RESTART, so that a signal wakes up poll() straight away.
+	struct sigaction stopAction{};
+	stopAction.sa_handler = request_stop;
+	sigemptyset(&stopAction.sa_mask);
+	sigaction(SIGINT, &stopAction, nullptr);
+	sigaction(SIGTERM, &stopAction, nullptr);
+
+	log << "Rendering jobs submitted at " << fListener->Address().ToString() << ", up to " << fMaxConcurrentJobs
+		<< " at once" << std::endl;
+
+	for (uint32_t index = 0; index < fMaxConcurrentJobs; index++)
+		fRenderThreads.emplace_back(&RenderServer::RenderThread_, this, std::ref(log));
+
+	bool stoppedOnRequest = true;
+	while (!sStopRequested) {
+		pollfd listenerPoll{ fListener->Descriptor(), POLLIN, 0 };
+		const int ready = poll(&listenerPoll, 1, kPollMilliseconds);
+		if (ready < 0 && errno != EINTR) {
+			std::cerr << "(Error) Render server failed to wait for clients: " << std::strerror(errno) << std::endl;
+			stoppedOnRequest = false;
+			break;
+		}
+
+		if (ready <= 0)
+			continue;
+
+		std::unique_ptr<Connection> connection = fListener->Accept();
+		if (!connection)
+			continue;
+
+		std::lock_guard lock(fQueueMutex);
+
+		// Let the client know it'll have to wait, if every render thread already has a job.
+		if (fBusyThreads + fQueue.size() >= fMaxConcurrentJobs)
+			connection->SendMessage(static_cast<uint32_t>(RenderJobMessage::QUEUED), {});
+
+		fQueue.push_back(std::move(connection));
+		fQueueChanged.notify_one();
+	}
+
+	{
+		std::lock_guard lock(fQueueMutex);
+		fStopping = true;
+		fQueue.clear();
+	}
+
+	fQueueChanged.notify_all();
+	for (std::thread& renderThread : fRenderThreads)
+		renderThread.join();
+	fRenderThreads.clear();
+
+	std::lock_guard lock(fLogMutex);
+	log << "Render server stopped after " << fJobCount << " jobs" << std::endl;
+	return stoppedOnRequest;
+}
+
+void
+RenderServer::RenderThread_(std::ostream& log)
+{
+	// Share the cores out between the render threads, rather than have each of them start a thread on every core.
+	omp_set_num_threads(std::max(1, omp_get_max_threads() / static_cast<int>(fMaxConcurrentJobs)));
+
+	while (true) {
+		std::unique_ptr<Connection> connection;
+		uint64_t jobNumber = 0;
+		{
+			std::unique_lock lock(fQueueMutex);
+			fQueueChanged.wait(lock, [this]() { return fStopping || !fQueue.empty(); });
+			if (fStopping)
+				return;
+
+			connection = std::move(fQueue.front());
+			fQueue.pop_front();
+			jobNumber = ++fJobCount;
+			fBusyThreads++;
+		}
+
+		RenderJob_(*connection, jobNumber, log);
+
+		std::lock_guard lock(fQueueMutex);
+		fBusyThreads--;
+	}
+}
+
+void
+RenderServer::RenderJob_(Connection& connection, uint64_t jobNumber, std::ostream& log)
+{
+	const auto fail = [&](const std::string& reason) {
+		MessageWriter failure;
+		failure.PutString(reason);
+		connection.SendMessage(static_cast<uint32_t>(RenderJobMessage::FAILED), failure.Bytes());
+
+		std::lock_guard lock(fLogMutex);
+		log << "Job " << jobNumber << ": failed, " << reason << std::endl;
+	};
+
+	// Don't let a client that never gets round to submitting its job hold up a render thread for good.
+	pollfd clientPoll{ connection.Descriptor(), POLLIN, 0 };
+	uint32_t type = 0;
+	std::vector<uint8_t> payload;
+	if (poll(&clientPoll, 1, kSubmitTimeoutMilliseconds) <= 0 || !connection.ReceiveMessage(type, payload)
+		|| type != static_cast<uint32_t>(RenderJobMessage::SUBMIT)) {
+		fail("no job was submitted");
+		return;
+	}
+
+	RenderJob job;
+	MessageReader jobReader(payload);
+	if (!read_submitted_job(jobReader, job)) {
+		fail("the job couldn't be read, or was submitted by a different version of the program");
+		return;
+	}
+
+	// The client's options are checked the same way as they would be on its own command line, and for anything that
+	// would be written out here, rather than sent back.
+	std::ostringstream optionErrors;
+	if (!job.options.CheckRenderingChoices(optionErrors) || !job.options.CheckServerChoices(optionErrors)) {
+		std::string reason = optionErrors.str();
+		reason.erase(reason.find_last_not_of('\n') + 1);
+		fail(reason);
+		return;
+	}
+
+	const auto loadStartTime = std::chrono::steady_clock::now();
+
+	// Scene files are read again for every job, so that they're loaded again once they've been edited.
+	const std::filesystem::path& inputFilePath = job.options.inputFilePath;
+	std::filesystem::path sceneDirectory = job.sceneDirectory;
+	if (!inputFilePath.empty()) {
+		std::ifstream sceneFile(inputFilePath, std::ios::binary);
+		if (sceneFile.fail()) {
+			fail("couldn't open the scene at " + inputFilePath.string());
+			return;
+		}
+
+		std::ostringstream contents;
+		contents << sceneFile.rdbuf();
+		job.sceneText = contents.str();
+		sceneDirectory = std::filesystem::path(inputFilePath).remove_filename();
+	}
+
+	const std::string key = scene_key(job.sceneText, sceneDirectory, job.options);
+	std::shared_ptr<const SceneDefinition> scene = FindScene_(key);
+	const bool sceneWasCached = scene != nullptr;
+	if (!sceneWasCached) {
+		auto loadedScene = std::make_shared<SceneDefinition>();
+		std::ostream quiet(nullptr);
+		if (!SceneLoader::LoadText(job.sceneText, sceneDirectory, *loadedScene, quiet)) {
+			fail("couldn't load the scene");
+			return;
+		}
+
+		SceneRenderer::ChoosePruning(*loadedScene, job.options);
+		scene = std::move(loadedScene);
+		KeepScene_(key, scene, sceneDirectory);
+	}
+
+	const double loadSeconds = seconds_since(loadStartTime);
+
+	// Only now that the scene's loaded is the size of its image known.
+	std::ostringstream cropErrors;
+	if (!SceneRenderer::CheckCropWindow(*scene, job.options, cropErrors)) {
+		std::string reason = cropErrors.str();
+		reason.erase(reason.find_last_not_of('\n') + 1);
+		fail(reason);
+		return;
+	}
+
+	MessageWriter loaded;
+	loaded.Put(sceneWasCached);
+	loaded.Put(loadSeconds);
+	loaded.Put(scene->imagePixelSize);
+	bool connected = connection.SendMessage(static_cast<uint32_t>(RenderJobMessage::LOADED), loaded.Bytes());
+
+	// Tell the client whenever another whole percent of the tiles are done. The threads rendering the tiles only note
+	// how many are done, and the progress is sent from a thread of its own, so that a client that's slow to read it
+	// can't hold them up.
+	std::atomic<std::size_t> tilesDone = 0;
+	std::atomic<std::size_t> tileCount = 0;
+	const auto noteProgress = [&](std::size_t tilesDoneSoFar, std::size_t totalTileCount) {
+		tileCount.store(totalTileCount, std::memory_order_relaxed);
+
+		// Tiles finished at the same time can be noted in either order.
+		std::size_t previousTilesDone = tilesDone.load(std::memory_order_relaxed);
+		while (previousTilesDone < tilesDoneSoFar
+			&& !tilesDone.compare_exchange_weak(previousTilesDone, tilesDoneSoFar, std::memory_order_relaxed)) {
+		}
+	};
+
+	uint32_t lastPercent = 0;
+	const auto sendProgress = [&]() {
+		const std::size_t totalTileCount = tileCount.load(std::memory_order_relaxed);
+		const std::size_t tilesDoneSoFar = tilesDone.load(std::memory_order_relaxed);
+		const uint32_t percent = totalTileCount != 0 ? static_cast<uint32_t>((tilesDoneSoFar * 100) / totalTileCount) : 0;
+		if (percent == lastPercent)
+			return true;
+
+		lastPercent = percent;
+		MessageWriter progress;
+		progress.Put(static_cast<uint32_t>(tilesDoneSoFar));
+		progress.Put(static_cast<uint32_t>(totalTileCount));
+		return connection.SendMessage(static_cast<uint32_t>(RenderJobMessage::PROGRESS), progress.Bytes());
+	};
+
+	std::mutex progressMutex;
+	std::condition_variable renderFinished;
+	bool rendering = true;
+	bool progressSent = connected;
+	std::thread progressThread([&]() {
+		std::unique_lock lock(progressMutex);
+		while (progressSent && !renderFinished.wait_for(lock, kProgressInterval, [&]() { return !rendering; })) {
+			lock.unlock();
+			const bool sent = sendProgress();
+			lock.lock();
+			progressSent = sent;
+		}
+	});
+
+	const auto renderStartTime = std::chrono::steady_clock::now();
+	Framebuffer framebuffer(scene->imagePixelSize);
+	TileRenderStats stats;
+	std::ostream quiet(nullptr);
+	const bool rendered = !connected
+		|| SceneRenderer::Render(*scene, job.options, inputFilePath, framebuffer, stats, quiet, noteProgress);
+
+	// The progress thread has to be done sending before anything else is.
+	{
+		std::lock_guard lock(progressMutex);
+		rendering = false;
+	}
+	renderFinished.notify_one();
+	progressThread.join();
+	connected = connected && progressSent && sendProgress();
+
+	if (!rendered) {
+		fail("the image couldn't be rendered");
+		return;
+	}
+
+	const double renderSeconds = seconds_since(renderStartTime);
+	const Framebuffer outputImage = SceneRenderer::OutputImage(std::move(framebuffer), job.options);
+
+	MessageWriter image;
+	image.Put(renderSeconds);
+	write_render_stats(image, stats);
+	image.Put(outputImage.PixelSize());
+	image.PutBytes(outputImage.Pixels(), outputImage.PixelCount() * sizeof(ColorRGB));
+	connected = connected && connection.SendMessage(static_cast<uint32_t>(RenderJobMessage::IMAGE), image.Bytes());
+
+	std::lock_guard lock(fLogMutex);
+	log << "Job " << jobNumber << ": " << (inputFilePath.empty() ? "scene text" : inputFilePath.string()) << ", "
+		<< scene->imagePixelSize.width << "x" << scene->imagePixelSize.height << ", "
+		<< (sceneWasCached ? "already loaded" : "loaded in " + std::to_string(loadSeconds) + "s") << ", rendered in "
+		<< renderSeconds << "s" << (connected ? "" : ", but the client went away") << std::endl;
+}
+
+std::shared_ptr<const SceneDefinition>
+RenderServer::FindScene_(const std::string& key)
+{
+	std::lock_guard lock(fSceneMutex);
+	auto found = fScenes.find(key);
+	if (found == fScenes.end())
+		return nullptr;
+
+	// A scene whose textures have changed since it was loaded has to be loaded again.
+	for (const auto& [texturePath, writeTime] : found->second.textureWriteTimes) {
+		std::error_code error;
+		if (std::filesystem::last_write_time(texturePath, error) != writeTime || error) {
+			fScenes.erase(found);
+			return nullptr;
+		}
+	}
+
+	found->second.lastUsed = ++fSceneUseCount;
+	return found->second.scene;
+}
+
+void
+RenderServer::KeepScene_(const std::string& key, const std::shared_ptr<const SceneDefinition>& scene,
+	const std::filesystem::path& sceneDirectory)
+{
+	CachedScene cachedScene{ scene, texture_write_times(*scene, sceneDirectory), 0 };
+
+	std::lock_guard lock(fSceneMutex);
+	cachedScene.lastUsed = ++fSceneUseCount;
+	fScenes.insert_or_assign(key, std::move(cachedScene));
+
+	while (fScenes.size() > kMaxCachedScenes) {
+		const auto leastRecentlyUsed = std::min_element(fScenes.begin(), fScenes.end(),
+			[](const auto& first, const auto& second) { return first.second.lastUsed < second.second.lastUsed; });
+		fScenes.erase(leastRecentlyUsed);
+	}
+}
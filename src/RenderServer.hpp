@@ -0,0 +1,92 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef RENDER_SERVER_H
+#define RENDER_SERVER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GraphicsEngine.hpp"
+#include "RenderJobProtocol.hpp"
+#include "Transport.hpp"
+
+/** RenderServer */
+
+// Stays running to render scenes for RenderClients, which connect to it over a UNIX domain socket, so that rendering a
+// small scene doesn't mean paying for starting a process, parsing the scene, and loading its textures every time.
+// Loaded scenes are kept, bounding volume hierarchies and all, and used again by jobs with the same scene text, as
+// long as none of their texture files have changed since. Textures stay in the TextureCache.
+// Jobs are rendered by a fixed number of render threads, each with its own share of the cores, so only that many are
+// rendered at once, and the rest wait their turn in the order they connected.
+class RenderServer {
+public:
+	// How many loaded scenes are kept around, after which the one used least recently is let go.
+	static constexpr std::size_t kMaxCachedScenes = 8;
+
+	// How long a client has to submit its job once it's connected, before it's hung up on.
+	static constexpr int kSubmitTimeoutMilliseconds = 5000;
+
+	// How long to wait for a client to connect, before checking whether the server's been asked to stop.
+	static constexpr int kPollMilliseconds = 250;
+
+public:
+	// Description: Creates a server that takes jobs from clients connecting to 'listener', rendering up to
+	// 'maxConcurrentJobs' of them at once.
+	RenderServer(std::unique_ptr<Listener> listener, uint32_t maxConcurrentJobs);
+	~RenderServer();
+
+	RenderServer(const RenderServer& other) = delete;
+	RenderServer& operator=(const RenderServer& other) = delete;
+
+	// Description: Takes jobs until the process is interrupted or terminated, printing out a line about each to the
+	// stream 'log'. Jobs being rendered when it's asked to stop are finished, and those still waiting are hung up on.
+	// Returns: true if it stopped because it was asked to.
+	bool Run(std::ostream& log);
+
+private:
+	// A loaded scene, and what it was loaded from.
+	struct CachedScene {
+		std::shared_ptr<const SceneDefinition> scene;
+
+		// When each texture file the scene uses was last written to, when it was loaded.
+		std::map<std::filesystem::path, std::filesystem::file_time_type> textureWriteTimes;
+
+		// When the scene was last used, counted in jobs.
+		uint64_t lastUsed;
+	};
+
+	void RenderThread_(std::ostream& log);
+	void RenderJob_(Connection& connection, uint64_t jobNumber, std::ostream& log);
+	std::shared_ptr<const SceneDefinition> FindScene_(const std::string& key);
+	void KeepScene_(const std::string& key, const std::shared_ptr<const SceneDefinition>& scene,
+		const std::filesystem::path& sceneDirectory);
+
+	std::unique_ptr<Listener> fListener;
+	uint32_t fMaxConcurrentJobs;
+	std::vector<std::thread> fRenderThreads;
+
+	// Clients waiting for a render thread, in the order they connected.
+	std::mutex fQueueMutex;
+	std::condition_variable fQueueChanged;
+	std::deque<std::unique_ptr<Connection>> fQueue;
+	uint32_t fBusyThreads;
+	uint64_t fJobCount;
+	bool fStopping;
+
+	std::mutex fSceneMutex;
+	std::map<std::string, CachedScene> fScenes;
+	uint64_t fSceneUseCount;
+
+	std::mutex fLogMutex;
+};
+
+#endif // RENDER_SERVER_H
@@ -0,0 +1,125 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "SceneLoader.hpp"
+
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include "InputFileParser.hpp"
+#include "PhaseTrace.hpp"
+#include "TextureCache.hpp"
+
+bool
+SceneLoader::Load(const std::filesystem::path& inputFilePath, SceneDefinition& scene, std::ostream& log)
+{
+	// (1) Start reading in the input file!
+	log << "=== Reading in Input File ===" << std::endl;
+
+	if (!std::filesystem::exists(inputFilePath)) {
+		std::cerr << "The provided filepath does not exist! Exiting..." << std::endl;
+		return false;
+	}
+
+	bool result = false;
+	{
+		ScopedPhaseTimer timer("Reading in Input File");
+		InputFileParser parser(inputFilePath);
+		result = parser.Parse(scene);
+		parser.Close();
+	}
+
+	if (!result) {
+		std::cerr << "Couldn't parse the input file! Did you format it correctly?" << std::endl;
+		return false;
+	}
+
+	return Prepare_(std::filesystem::path(inputFilePath).remove_filename(), scene, log);
+}
+
+bool
+SceneLoader::LoadText(const std::string& sceneText, const std::filesystem::path& sceneDirectory,
+	SceneDefinition& scene, std::ostream& log)
+{
+	log << "=== Reading in Scene Definition ===" << std::endl;
+
+	bool result = false;
+	{
+		ScopedPhaseTimer timer("Reading in Scene Definition");
+		std::istringstream input(sceneText);
+		InputFileParser parser;
+		result = parser.Parse(input, scene);
+	}
+
+	if (!result) {
+		std::cerr << "Couldn't parse the scene definition! Did you format it correctly?" << std::endl;
+		return false;
+	}
+
+	return Prepare_(sceneDirectory, scene, log);
+}
+
+bool
+SceneLoader::Prepare_(const std::filesystem::path& sceneDirectory, SceneDefinition& scene, std::ostream& log)
+{
+	// Print out Scene Definition
+	log << "Scene Definition Read:" << std::endl;
+	log << scene << std::endl;
+
+	// Build the acceleration structure used to find what each ray hits. Each mesh gets its own first, as the scene's
+	// is built over the bounds of the mesh instances.
+	log << "=== Building Bounding Volume Hierarchy ===" << std::endl;
+	{
+		ScopedPhaseTimer timer("Building Bounding Volume Hierarchy");
+		for (const auto& [name, mesh] : scene.meshMap) {
+			mesh->Build();
+			log << "\tBuilt " << mesh->Hierarchy().NodeCount() << " nodes over mesh " << name << "'s "
+				<< mesh->Hierarchy().ObjectCount() << " triangles!" << std::endl;
+		}
+
+		scene.objectHierarchy.Build(scene.objectList);
+	}
+	log << "\tBuilt " << scene.objectHierarchy.NodeCount() << " nodes over "
+		<< scene.objectHierarchy.ObjectCount() << " objects!" << std::endl;
+
+    // Pre-Load Texture Files, which are looked for next to the scene definition file. Each is only loaded once per
+    // scene, however many objects use it.
+    log << "=== Pre-Loading Texture Files ===" << std::endl;
+    ScopedPhaseTimer timer("Pre-Loading Texture Files");
+    std::map<std::filesystem::path, SharedTexture> sceneTextures;
+    const auto preloadTexture = [&](const SharedObject& object) {
+        if (object->texturePath.empty())
+            return true;
+
+        auto found = sceneTextures.find(object->texturePath);
+        if (found == sceneTextures.end()) {
+            SharedTexture texture;
+            if (!TextureCache::Instance().LoadTexture(sceneDirectory, object->texturePath, texture)) {
+                std::cerr << "(Error) Failed to start loading texture from file: " << object->texturePath << std::endl;
+                return false;
+            }
+
+            log << "\tLoaded Texture: " << object->texturePath << std::endl;
+            found = sceneTextures.emplace(object->texturePath, std::move(texture)).first;
+        }
+
+        object->texture = found->second;
+        return true;
+    };
+
+    for (const auto& object : scene.objectList) {
+        if (!preloadTexture(object))
+            return false;
+    }
+
+    for (const auto& [name, mesh] : scene.meshMap) {
+        for (const auto& triangle : mesh->Triangles()) {
+            if (!preloadTexture(triangle))
+                return false;
+        }
+    }
+
+    log << "\tFinished loading textures!" << std::endl;
+	return true;
+}
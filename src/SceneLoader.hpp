@@ -0,0 +1,37 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef SCENE_LOADER_H
+#define SCENE_LOADER_H
+
+#include <filesystem>
+#include <ostream>
+#include <string>
+
+#include "GraphicsEngine.hpp"
+
+/** SceneLoader */
+
+// Gets a scene definition file ready to be rendered: parses it, builds the bounding volume hierarchies over its meshes
+// and objects, and preloads the textures it uses.
+class SceneLoader {
+public:
+	SceneLoader() = delete;
+
+	// Description: Loads the scene defined in the file at 'inputFilePath' into 'scene', printing out what it's doing
+	// to the stream 'log'. Textures are looked for in the "texture" folder next to the file. Scenes can be loaded on
+	// any thread, even while another is being rendered.
+	// Returns: true if the scene is ready to be rendered.
+	static bool Load(const std::filesystem::path& inputFilePath, SceneDefinition& scene, std::ostream& log);
+
+	// Description: Loads the scene defined by 'sceneText', the contents of a scene definition file, into 'scene', as
+	// if it had been read from a file in 'sceneDirectory'.
+	// Returns: true if the scene is ready to be rendered.
+	static bool LoadText(const std::string& sceneText, const std::filesystem::path& sceneDirectory,
+		SceneDefinition& scene, std::ostream& log);
+
+private:
+	// Builds the bounding volume hierarchies of the parsed 'scene', and preloads its textures from 'sceneDirectory'.
+	static bool Prepare_(const std::filesystem::path& sceneDirectory, SceneDefinition& scene, std::ostream& log);
+};
+
+#endif // SCENE_LOADER_H
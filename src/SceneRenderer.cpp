@@ -0,0 +1,305 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "SceneRenderer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include "CameraRayGenerator.hpp"
+#include "JsonWriter.hpp"
+#include "PhaseTrace.hpp"
+#include "PpmWriter.hpp"
+#include "TileScheduler.hpp"
+
+/* Progressive Rendering */
+
+// How far apart the pixels traced in each pass are, across and down.
+static constexpr std::array<uint32_t, 3> kPassStrides = { 4, 2, 1 };
+
+// What each pass is called in traces.
+static constexpr std::array<const char*, 3> kPassNames = { "Pass 1", "Pass 2", "Pass 3" };
+
+// Description: Traces a ray through each pixel of 'tile' on the grid of every 'stride'th pixel from the top left corner
+// of 'region', writing the colors into 'tilePixels' row by row. Pixels already traced on the coarser grid of every
+// 'previousStride'th pixel, and pixels off the grid, are copied over from 'framebuffer' as they are. A 'previousStride'
+// of 0 means nothing has been traced yet.
+static void
+render_tile_progressively(const Tile& tile, const Tile& region, const CameraRayGenerator& camera,
+	const SceneDefinition& scene, uint32_t depth, uint32_t stride, uint32_t previousStride,
+	const Framebuffer& framebuffer, ColorRGB* tilePixels)
+{
+	const auto isOnGrid = [&region](uint32_t x, uint32_t y, uint32_t gridStride) {
+		return gridStride != 0 && (x - region.x) % gridStride == 0 && (y - region.y) % gridStride == 0;
+	};
+
+	for (uint32_t row = 0; row < tile.height; row++) {
+		for (uint32_t column = 0; column < tile.width; column++) {
+			const uint32_t x = tile.x + column;
+			const uint32_t y = tile.y + row;
+
+			ColorRGB& tilePixel = tilePixels[(row * tile.width) + column];
+			if (!isOnGrid(x, y, stride) || isOnGrid(x, y, previousStride)) {
+				tilePixel = framebuffer(x, y);
+				continue;
+			}
+
+			const Ray ray = camera.GenerateRay(static_cast<float>(x), static_cast<float>(y));
+			tilePixel = GraphicsEngine::TraceWithRay(ray, scene, scene.backgroundRefractionIndex, depth);
+		}
+	}
+}
+
+// Description: Fills 'preview' with 'framebuffer', where only the pixels of 'region' on the grid of every 'stride'th
+// pixel from its top left corner have been traced, by stretching each of those over the 'stride' by 'stride' block of
+// pixels below and to the right of it. Pixels outside of 'region' are copied over as they are.
+static void
+fill_preview(const Framebuffer& framebuffer, const Tile& region, uint32_t stride, Framebuffer& preview)
+{
+	const Size imageSize = framebuffer.PixelSize();
+
+	#pragma omp parallel for shared(framebuffer, region, stride, preview, imageSize) default(none)
+	for (uint32_t y = 0; y < imageSize.height; y++) {
+		ColorRGB* previewRow = preview.Row(y);
+		if (y < region.y || y >= region.y + region.height) {
+			std::copy_n(framebuffer.Row(y), imageSize.width, previewRow);
+			continue;
+		}
+
+		const ColorRGB* tracedRow = framebuffer.Row(y - ((y - region.y) % stride));
+		for (uint32_t x = 0; x < imageSize.width; x++) {
+			const bool inRegion = x >= region.x && x < region.x + region.width;
+			previewRow[x] = inRegion ? tracedRow[x - ((x - region.x) % stride)] : framebuffer(x, y);
+		}
+	}
+}
+
+// Description: Returns 'count' divided by 'total', or 0 if 'total' is.
+static double
+ratio(double count, double total)
+{
+	return total > 0.0 ? count / total : 0.0;
+}
+
+
+/* SceneRenderer */
+
+void
+SceneRenderer::ChoosePruning(SceneDefinition& scene, const RenderOptions& options)
+{
+	scene.pruning.minimumWeight = options.minimumRayWeight;
+	scene.pruning.russianRoulette = options.russianRoulette;
+}
+
+bool
+SceneRenderer::CheckCropWindow(const SceneDefinition& scene, const RenderOptions& options, std::ostream& errors)
+{
+	if (!options.cropWindow)
+		return true;
+
+	const Size imageSize = scene.imagePixelSize;
+	const Tile& crop = *options.cropWindow;
+	if (crop.x >= imageSize.width || crop.y >= imageSize.height || crop.width > imageSize.width - crop.x
+		|| crop.height > imageSize.height - crop.y) {
+		errors << "The crop window of " << crop.width << "x" << crop.height << " pixels from (" << crop.x << ", "
+			<< crop.y << ") doesn't fit in the " << imageSize.width << "x" << imageSize.height << " image!" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+std::optional<Tile>
+SceneRenderer::PrepareRegion(const SceneDefinition& scene, const RenderOptions& options, Framebuffer& framebuffer)
+{
+	const Size imageSize = scene.imagePixelSize;
+	if (!options.cropWindow)
+		return Tile{ 0, 0, imageSize.width, imageSize.height };
+
+	std::ostringstream cropErrors;
+	if (!CheckCropWindow(scene, options, cropErrors)) {
+		std::cerr << "(Error) " << cropErrors.str();
+		return {};
+	}
+
+	framebuffer.Fill(scene.backgroundColor);
+	return *options.cropWindow;
+}
+
+Framebuffer
+SceneRenderer::OutputImage(Framebuffer framebuffer, const RenderOptions& options)
+{
+	if (!options.cropWindow || options.fullFrameOutput)
+		return framebuffer;
+
+	const Tile& crop = *options.cropWindow;
+	Framebuffer croppedImage(Size{ crop.width, crop.height });
+	for (uint32_t row = 0; row < crop.height; row++)
+		std::copy_n(framebuffer.Row(crop.y + row) + crop.x, crop.width, croppedImage.Row(row));
+
+	return croppedImage;
+}
+
+bool
+SceneRenderer::Render(const SceneDefinition& scene, const RenderOptions& options,
+	const std::filesystem::path& inputFilePath, Framebuffer& framebuffer, TileRenderStats& stats, std::ostream& log,
+	const ProgressFunction& progress, CostHeatmap* heatmap)
+{
+	CameraRayGenerator camera(scene);
+
+	// The depth to use!
+	const uint32_t depthChoice = options.depth;
+
+	const std::optional<Tile> region = PrepareRegion(scene, options, framebuffer);
+	if (!region)
+		return false;
+
+	TileScheduler scheduler(*region, options.tileSize);
+	const std::size_t passCount = options.progressiveRendering ? kPassStrides.size() : 1;
+	const std::size_t tileCount = scheduler.Tiles().size() * passCount;
+
+	// What went into rendering each tile is added up as they're finished.
+	std::mutex statsMutex;
+	std::size_t tilesDone = 0;
+	const auto addRenderStats = [&](const TileRenderStats& tileStats) {
+		std::size_t tilesDoneSoFar = 0;
+		{
+			std::lock_guard lock(statsMutex);
+			stats += tileStats;
+			tilesDoneSoFar = ++tilesDone;
+		}
+
+		// Outside the lock, so however long it takes doesn't hold up the other threads.
+		if (progress)
+			progress(tilesDoneSoFar, tileCount);
+	};
+
+	if (!options.progressiveRendering) {
+		TileRenderer renderer(camera, scene, options, heatmap);
+
+		scheduler.Render([&](const Tile& tile, ColorRGB* tilePixels) {
+			addRenderStats(renderer.RenderTile(tile, tilePixels));
+		}, framebuffer);
+
+		scheduler.PrintReport(log);
+		return true;
+	}
+
+	// Trace every 4th pixel across and down (1/16 of them), then every 2nd (1/4), then the rest, writing out a
+	// preview after each pass but the last. Each pass only traces the pixels the passes before it didn't.
+	uint32_t previousStride = 0;
+	for (std::size_t pass = 0; pass < kPassStrides.size(); pass++) {
+		const uint32_t stride = kPassStrides[pass];
+		log << "\tPass " << (pass + 1) << ": tracing one pixel in every " << stride << "x" << stride << " block" << std::endl;
+		ScopedPhaseTimer timer(kPassNames[pass], "pass");
+
+		scheduler.Render([&](const Tile& tile, ColorRGB* tilePixels) {
+			render_tile_progressively(tile, *region, camera, scene, depthChoice, stride, previousStride, framebuffer,
+				tilePixels);
+			addRenderStats(TileRenderStats{ 0, GraphicsEngine::TakePruningCounters() });
+		}, framebuffer);
+
+		scheduler.PrintReport(log);
+		previousStride = stride;
+
+		if (stride == 1)
+			break;
+
+		Framebuffer preview(scene.imagePixelSize);
+		fill_preview(framebuffer, *region, stride, preview);
+
+		std::filesystem::path previewName = inputFilePath;
+		previewName += ".pass" + std::to_string(pass + 1);
+		if (!ppm_writer_write_file(previewName.c_str(), OutputImage(std::move(preview), options)))
+			return false;
+	}
+
+	return true;
+}
+
+void
+SceneRenderer::PrintStats(std::ostream& out, const TileRenderStats& stats, std::size_t pixelCount,
+	const RenderOptions& options)
+{
+	// Only the pixels in the crop window were rendered, if there was one.
+	if (options.cropWindow)
+		pixelCount = options.cropWindow->PixelCount();
+
+	if (options.maxSamples > 1) {
+		const double averageSamples = static_cast<double>(pixelCount + stats.addedSamples)
+			/ static_cast<double>(pixelCount);
+		out << "\tAntialiased with " << stats.addedSamples << " extra samples, " << averageSamples
+			<< " samples per pixel on average" << std::endl;
+	}
+
+	if (options.minimumRayWeight > 0.f) {
+		const PruningCounters& counters = stats.pruning;
+		const double prunedPercentage = counters.consideredRays == 0 ? 0.0
+			: 100.0 * static_cast<double>(counters.prunedRays) / static_cast<double>(counters.consideredRays);
+
+		out << "\tPruned " << counters.prunedRays << " of " << counters.consideredRays
+			<< " reflected and refracted rays (" << prunedPercentage << "%)";
+		if (counters.rouletteSurvivors > 0)
+			out << ", " << counters.rouletteSurvivors << " survived Russian roulette";
+		out << std::endl;
+	}
+}
+
+void
+SceneRenderer::PrintRayStats(std::ostream& out, const RayCounters& counters, double renderSeconds)
+{
+	const double rayCount = static_cast<double>(counters.TotalRays());
+	const double closestCount = static_cast<double>(counters.closestHits + counters.closestMisses);
+
+	out << "\tTraced " << counters.TotalRays() << " rays, " << ratio(rayCount, renderSeconds) << " a second: "
+		<< counters.primaryRays << " primary, " << counters.shadowRays << " shadow, " << counters.reflectedRays
+		<< " reflected, " << counters.refractedRays << " refracted" << std::endl;
+	out << "\t" << counters.closestHits << " rays hit something and " << counters.closestMisses << " missed ("
+		<< 100.0 * ratio(static_cast<double>(counters.closestHits), closestCount) << "% hit)" << std::endl;
+	out << "\tTested " << counters.boxTests << " bounding boxes, " << counters.sphereTests << " spheres, "
+		<< counters.cylinderTests << " cylinders, " << counters.triangleTests << " triangles, and "
+		<< counters.instanceTests << " mesh instances" << std::endl;
+	out << "\t" << ratio(static_cast<double>(counters.boxTests), rayCount) << " bounding box and "
+		<< ratio(static_cast<double>(counters.PrimitiveTests()), rayCount) << " primitive tests per ray" << std::endl;
+}
+
+bool
+SceneRenderer::WriteRayStats(const std::filesystem::path& statsPath, const RayCounters& counters, double renderSeconds)
+{
+	std::ofstream statsFile(statsPath);
+	if (statsFile.fail()) {
+		std::cerr << "(Error) Failed to open the ray stats for writing at path: " << statsPath << std::endl;
+		return false;
+	}
+
+	const double rayCount = static_cast<double>(counters.TotalRays());
+
+	JsonWriter json(statsFile);
+	json.BeginObject();
+	json.Field("renderSeconds", renderSeconds);
+	json.Field("primaryRays", counters.primaryRays);
+	json.Field("shadowRays", counters.shadowRays);
+	json.Field("reflectedRays", counters.reflectedRays);
+	json.Field("refractedRays", counters.refractedRays);
+	json.Field("totalRays", counters.TotalRays());
+	json.Field("closestHits", counters.closestHits);
+	json.Field("closestMisses", counters.closestMisses);
+	json.Field("boxTests", counters.boxTests);
+	json.Field("sphereTests", counters.sphereTests);
+	json.Field("cylinderTests", counters.cylinderTests);
+	json.Field("triangleTests", counters.triangleTests);
+	json.Field("instanceTests", counters.instanceTests);
+	json.Field("raysPerSecond", ratio(rayCount, renderSeconds));
+	json.Field("boxTestsPerRay", ratio(static_cast<double>(counters.boxTests), rayCount));
+	json.Field("primitiveTestsPerRay", ratio(static_cast<double>(counters.PrimitiveTests()), rayCount));
+	json.EndObject();
+
+	statsFile.close();
+	return !statsFile.fail();
+}
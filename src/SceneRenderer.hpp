@@ -0,0 +1,77 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef SCENE_RENDERER_H
+#define SCENE_RENDERER_H
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <ostream>
+
+#include "Framebuffer.hpp"
+#include "GraphicsEngine.hpp"
+#include "RenderOptions.hpp"
+#include "TileRenderer.hpp"
+#include "TileScheduler.hpp"
+#include "core/RayStats.hpp"
+
+/** SceneRenderer */
+
+// Renders a loaded scene in this process, across every OpenMP thread, the way the command line asked for: all at once,
+// or progressively in coarse to fine passes.
+class SceneRenderer {
+public:
+	// Told each time a tile's finished, from the thread that rendered it, how many of the image's tiles have been so far.
+	// Progressive rendering renders every tile once per pass, and counts each of those. Threads that finish tiles at the
+	// same time can call it at once, and in either order, so it must be safe to call from several threads.
+	using ProgressFunction = std::function<void(std::size_t tilesDone, std::size_t tileCount)>;
+
+public:
+	SceneRenderer() = delete;
+
+	// Description: Makes 'scene' prune rays the way 'options' asks for. Call before rendering it.
+	static void ChoosePruning(SceneDefinition& scene, const RenderOptions& options);
+
+	// Description: Checks that the crop window of 'options', if there is one, fits in the image of 'scene', printing out
+	// why not to the stream 'errors'.
+	// Returns: true if there's no crop window, or it fits.
+	[[nodiscard]] static bool CheckCropWindow(const SceneDefinition& scene, const RenderOptions& options,
+		std::ostream& errors);
+
+	// Description: Works out which pixels of 'scene' to render with 'options': those in the crop window, or else the
+	// whole image. When cropping, 'framebuffer', which must be the size of the image, is filled with the background
+	// color, so that the pixels outside the crop window are left that color.
+	// Returns: The region to render, or nothing if the crop window doesn't fit in the image.
+	static std::optional<Tile> PrepareRegion(const SceneDefinition& scene, const RenderOptions& options,
+		Framebuffer& framebuffer);
+
+	// Description: Returns the image to write out of the rendered 'framebuffer': just the pixels in the crop window of
+	// 'options', or else the whole of it.
+	static Framebuffer OutputImage(Framebuffer framebuffer, const RenderOptions& options);
+
+	// Description: Renders 'scene' into 'framebuffer', which must be the size of its image, with the choices made in
+	// 'options', printing out how it went to the stream 'log'. Only the pixels in the crop window are rendered, if
+	// there is one. Progressive previews are written out next to 'inputFilePath'. What went into rendering the image
+	// is added to 'stats', and 'progress', if given, is told as each tile's finished. What each pixel cost is added to
+	// 'heatmap', if given, which can't be used with progressive rendering.
+	// Returns: true if the image was rendered.
+	static bool Render(const SceneDefinition& scene, const RenderOptions& options,
+		const std::filesystem::path& inputFilePath, Framebuffer& framebuffer, TileRenderStats& stats, std::ostream& log,
+		const ProgressFunction& progress = {}, CostHeatmap* heatmap = nullptr);
+
+	// Description: Prints out what went into rendering an image of 'pixelCount' pixels with 'options', beyond one
+	// sample per pixel, 'stats', to the stream 'out'. Only the pixels in the crop window count, if there is one.
+	static void PrintStats(std::ostream& out, const TileRenderStats& stats, std::size_t pixelCount,
+		const RenderOptions& options);
+
+	// Description: Prints out how many rays of each kind were traced and intersection tests done, 'counters', along
+	// with how many rays were traced a second over 'renderSeconds', and how many tests each took, to the stream 'out'.
+	static void PrintRayStats(std::ostream& out, const RayCounters& counters, double renderSeconds);
+
+	// Description: Writes out the same as PrintRayStats() to 'statsPath', as JSON.
+	// Returns: true if the file was written.
+	static bool WriteRayStats(const std::filesystem::path& statsPath, const RayCounters& counters, double renderSeconds);
+};
+
+#endif // SCENE_RENDERER_H
@@ -3,8 +3,10 @@
 
 #include "TextureCache.hpp"
 
-#include <memory>
 #include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
 
 
 std::once_flag TextureCache::sInitTextureCache;
@@ -18,75 +20,117 @@ TextureCache::Instance()
 }
 
 
-//void
-//TextureCache::WaitForTextureLoad()
-//{
-//    for (auto& loader : fLoaderMap) {
-//        std::cout << "Waiting for texture to load from file: " << loader.first << std::endl;
-//        if (loader.second.joinable())
-//            loader.second.join();
-//    }
-//}
-
-
-bool
-TextureCache::HasTexture(const std::filesystem::path& texturePath) const
+// Description: Returns the 64-bit FNV-1a hash of 'contents'.
+static uint64_t
+hash_contents(const std::string& contents)
 {
-    return fResourceMap.contains(texturePath)/* || fLoaderMap.contains(texturePath)*/;
+    uint64_t hash = 14695981039346656037ull;
+    for (char character : contents) {
+        hash ^= static_cast<uint8_t>(character);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
 }
 
 
 bool
-TextureCache::GetTexture(const std::filesystem::path& texturePath, SharedTexture& resourceOut)
+TextureCache::LoadTexture(const std::filesystem::path& sceneDirectory, const std::filesystem::path& texturePath,
+    SharedTexture& textureOut)
 {
-    if (!HasTexture(texturePath))
+    // Check for the texture in a "texture" subfolder
+    const std::filesystem::path actualTexturePath = TexturePath(sceneDirectory, texturePath);
+    if (!std::filesystem::exists(actualTexturePath)) {
+        std::cerr << "(Error) The texture doesn't exist at path: " << absolute(actualTexturePath) << std::endl;
         return false;
+    }
 
-//    if (fLoaderMap.contains(texturePath))
-//        fLoaderMap.at(texturePath).get_future().wait();
+    std::ifstream fileReader(actualTexturePath, std::ios::binary);
+    if (fileReader.fail()) {
+        std::cerr << "(Error) Failed to open the texture for reading at path: " << absolute(actualTexturePath) << std::endl;
+        return false;
+    }
+
+    std::ostringstream contents;
+    contents << fileReader.rdbuf();
+    const std::string textureContents = contents.str();
+    const uint64_t contentHash = hash_contents(textureContents);
 
-    if (!fResourceMap.contains(texturePath))
+    {
+        std::lock_guard<std::mutex> lock(fResourceMutex);
+        fCounters.texturesLoaded++;
+
+        // If a texture with the same contents is already loaded, don't parse it again!
+        if (SharedTexture found = FindTexture_(contentHash, textureContents)) {
+            fCounters.texturesReused++;
+            textureOut = std::move(found);
+            return true;
+        }
+    }
+
+    SharedTexture texture;
+    if (!LoadTextureFromPPM_(textureContents, texture)) {
+        std::cerr << "(Error) Failed to load the texture at path: " << absolute(actualTexturePath) << std::endl;
         return false;
+    }
 
-    resourceOut = fResourceMap.at(texturePath);
+    // Another thread may have loaded the same contents in the meantime, in which case its texture is kept.
+    std::lock_guard<std::mutex> lock(fResourceMutex);
+    if (SharedTexture found = FindTexture_(contentHash, textureContents)) {
+        textureOut = std::move(found);
+        return true;
+    }
+
+    ForgetUnusedTextures_();
+    fResourceMap.emplace(contentHash, CachedTexture{ textureContents, texture });
+    textureOut = std::move(texture);
     return true;
 }
 
 
-bool
-TextureCache::LoadTexture(const std::filesystem::path& texturePath)
+SharedTexture
+TextureCache::FindTexture_(uint64_t contentHash, const std::string& contents) const
 {
-    // If the texture at texturePath is already loaded, don't load it again!
-    if (HasTexture(texturePath))
-        return true;
+    // Different contents can hash the same, so only those that are really the same count.
+    const auto [first, last] = fResourceMap.equal_range(contentHash);
+    for (auto cached = first; cached != last; ++cached) {
+        if (cached->second.contents == contents)
+            return cached->second.texture.lock();
+    }
 
-    // Check for the texture in a "texture" subfolder
-    std::filesystem::path actualTexturePath = kTextureSubfolder;
+    return nullptr;
+}
+
+
+void
+TextureCache::ForgetUnusedTextures_()
+{
+    std::erase_if(fResourceMap, [](const auto& entry) { return entry.second.texture.expired(); });
+}
+
+
+std::filesystem::path
+TextureCache::TexturePath(const std::filesystem::path& sceneDirectory, const std::filesystem::path& texturePath)
+{
+    std::filesystem::path actualTexturePath = sceneDirectory;
+    actualTexturePath /= kTextureSubfolder;
     actualTexturePath /= texturePath;
-    if (!std::filesystem::exists(actualTexturePath)) {
-        std::cerr << "(Error) The texture doesn't exist at path: " << absolute(actualTexturePath) << std::endl;
-        return false;
-    }
+    return actualTexturePath;
+}
 
-//    const auto [iterator, success] = fLoaderMap.emplace(
-//        texturePath, std::thread(&TextureCache::LoadTextureFromPPM_, this, texturePath));
 
-    return LoadTextureFromPPM_(texturePath);
+TextureCache::Counters
+TextureCache::GetCounters()
+{
+    std::lock_guard<std::mutex> lock(fResourceMutex);
+    return fCounters;
 }
 
 
 bool
-TextureCache::LoadTextureFromPPM_(const std::filesystem::path& texturePath)
+TextureCache::LoadTextureFromPPM_(const std::string& contents, SharedTexture& textureOut)
 {
-    // Look for texture in texture subfolder
-    std::filesystem::path actualTexturePath = kTextureSubfolder;
-    actualTexturePath /= texturePath.filename();
-
-    std::ifstream fileReader(actualTexturePath);
-    if (fileReader.fail()) {
-        std::cerr << "(Error) Failed to open the texture for reading at path: " << absolute(actualTexturePath) << std::endl;
-        return false;
-    }
+    std::istringstream fileReader(contents);
 
     constexpr std::string_view kP3Type = "P3";
 
@@ -137,24 +181,6 @@ TextureCache::LoadTextureFromPPM_(const std::filesystem::path& texturePath)
     texture->SetMaxColorValue(maxColorValue);
     texture->MovePixelsIntoTexture(std::move(pixelArray), pixelCount);
 
-    {
-//        std::lock_guard<std::mutex> lock(fResourceMutex);
-        auto [iterator, success] = fResourceMap.emplace(texturePath, std::move(texture));
-
-        if (!success) {
-            std::cerr << "(Error) Failed to move texture in resource map: " << texturePath << std::endl;
-            return false;
-        }
-    }
-
-//    {
-//        std::lock_guard<std::mutex> lock(fLoaderMutex);
-//        if (fLoaderMap.erase(texturePath) != 1) {
-//            std::cerr << "(FATAL ERROR) Failed to erase loader entry from loader map, in inconsistent state!"
-//                      << std::endl;
-//            std::abort();
-//        }
-//    }
-
+    textureOut = std::move(texture);
     return true;
 }
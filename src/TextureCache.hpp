@@ -3,15 +3,28 @@
 #ifndef TEXTURE_CACHE_H
 #define TEXTURE_CACHE_H
 
+#include <cstdint>
 #include <filesystem>
-#include <future>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <string>
 
 #include "core/Texture.hpp"
 
+// Keeps track of every texture that's loaded, along with its file's contents and keyed by a hash of them, so that a
+// texture used by many scenes, or copied into many directories, is only parsed once while any of them are loaded. A
+// texture is only shared with a file whose contents are exactly the same, not just one whose hash is. The cache doesn't
+// keep textures loaded on its own, and forgets them once the last scene using them is gone, so a process that stays
+// running, loading scene after scene, only holds onto the textures of the scenes it still has.
 class TextureCache {
+public:
+    // How many textures have been asked for, and how many of those were already in the cache.
+    struct Counters {
+        uint64_t texturesLoaded = 0;
+        uint64_t texturesReused = 0;
+    };
+
 public:
     TextureCache() = default;
     virtual ~TextureCache() = default;
@@ -21,14 +34,17 @@ public:
     // Global Instance
     static TextureCache& Instance();
 
-    [[nodiscard]] bool HasTexture(const std::filesystem::path& texturePath) const;
+    // Looks for the texture at texturePath in the "texture" subfolder of sceneDirectory, and hands it back in
+    // textureOut. The file is always read, so a texture that's changed on disk since is loaded again, but it's only
+    // parsed if no texture with the same contents has been before.
+    bool LoadTexture(const std::filesystem::path& sceneDirectory, const std::filesystem::path& texturePath,
+        SharedTexture& textureOut);
 
-    // Will block if Texture corresponding to the texture path is still loading.
-    bool GetTexture(const std::filesystem::path& texturePath, SharedTexture& resourceOut);
+    [[nodiscard]] Counters GetCounters();
 
-    // Asynchronous function that starts loading a texture from texturePath...
-    bool LoadTexture(const std::filesystem::path& texturePath);
-//    void WaitForTextureLoad();
+    // Returns where the texture at texturePath is looked for, in the "texture" subfolder of sceneDirectory.
+    static std::filesystem::path TexturePath(const std::filesystem::path& sceneDirectory,
+        const std::filesystem::path& texturePath);
 
 private:
     static constexpr std::string_view kTextureSubfolder = "texture/";
@@ -36,13 +52,24 @@ private:
     static std::once_flag sInitTextureCache;
     static std::unique_ptr<TextureCache> sTheTextureCache;
 
-//    std::mutex fLoaderMutex;
-//    std::map<std::filesystem::path, std::promise<Texture>> fLoaderMap;
+    // A parsed texture, as long as it's in use, and the contents of the file it was parsed from.
+    struct CachedTexture {
+        std::string contents;
+        std::weak_ptr<Texture> texture;
+    };
 
     std::mutex fResourceMutex;
-    std::map<std::filesystem::path, std::shared_ptr<Texture>> fResourceMap;
+    std::multimap<uint64_t, CachedTexture> fResourceMap;
+    Counters fCounters;
+
+    // Finds the texture parsed from a file with exactly 'contents', whose hash is 'contentHash', if it's still in use.
+    // Call with the resource mutex held.
+    [[nodiscard]] SharedTexture FindTexture_(uint64_t contentHash, const std::string& contents) const;
+
+    // Forgets every texture that's no longer in use, along with its contents. Call with the resource mutex held.
+    void ForgetUnusedTextures_();
 
-    bool LoadTextureFromPPM_(const std::filesystem::path& texturePath);
+    static bool LoadTextureFromPPM_(const std::string& contents, SharedTexture& textureOut);
 };
 
-#endif // TEXTURE_CACHE_H
\ No newline at end of file
+#endif // TEXTURE_CACHE_H
@@ -0,0 +1,308 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "TileCoordinator.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "TileProtocol.hpp"
+
+extern char** environ;
+
+TileCoordinator::TileCoordinator(std::unique_ptr<Listener> listener, RenderOptions options)
+	:
+	fListener(std::move(listener)),
+	fOptions(std::move(options)),
+	fRenderedTileCount(0),
+	fReassignedTileCount(0),
+	fWallSeconds(0.0)
+{
+}
+
+TileCoordinator::~TileCoordinator()
+{
+	// Hanging up on the workers makes them exit, if Render() didn't get to tell them it was finished, and so does no
+	// longer listening for the ones that haven't been let in yet.
+	fWorkers.clear();
+	fListener.reset();
+	ReapWorkers_(true);
+}
+
+bool
+TileCoordinator::SpawnWorkers(uint32_t count, const std::filesystem::path& programPath)
+{
+	const std::string program = programPath.string();
+	const std::string address = fListener->Address().ToString();
+
+	// Everything a worker is started with is put together before forking, as only async-signal-safe calls can be made
+	// in the child of a process that may have other threads running. Each worker renders one tile at a time, so there's
+	// no need for it to start up a thread per core.
+	const std::string threadCountName = "OMP_NUM_THREADS=";
+	const std::string threadCountVariable = threadCountName + "1";
+	std::vector<char*> environment;
+	for (char** variable = environ; *variable != nullptr; variable++) {
+		if (std::strncmp(*variable, threadCountName.c_str(), threadCountName.size()) != 0)
+			environment.push_back(*variable);
+	}
+	environment.push_back(const_cast<char*>(threadCountVariable.c_str()));
+	environment.push_back(nullptr);
+
+	const std::string workerOption = "--worker";
+	char* const arguments[] = { const_cast<char*>(program.c_str()), const_cast<char*>(workerOption.c_str()),
+		const_cast<char*>(address.c_str()), nullptr };
+	const std::string execFailure = "(Error) Couldn't run worker " + program + "\n";
+
+	for (uint32_t index = 0; index < count; index++) {
+		const pid_t processID = fork();
+		if (processID < 0) {
+			std::cerr << "(Error) Couldn't start worker #" << index << ": " << std::strerror(errno) << std::endl;
+			return false;
+		}
+
+		if (processID == 0) {
+			execve(program.c_str(), arguments, environment.data());
+			[[maybe_unused]] const ssize_t written = write(STDERR_FILENO, execFailure.data(), execFailure.size());
+			_exit(EXIT_FAILURE);
+		}
+
+		fSpawnedWorkers.push_back(processID);
+	}
+
+	return true;
+}
+
+bool
+TileCoordinator::Render(const std::vector<Tile>& tiles, Framebuffer& framebuffer)
+{
+	if (!fListener)
+		return false;
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	fPendingTiles.clear();
+	for (uint32_t tileIndex = 0; tileIndex < tiles.size(); tileIndex++)
+		fPendingTiles.push_back(tileIndex);
+
+	fTileRendered.assign(tiles.size(), 0);
+	fRenderedTileCount = 0;
+	fReassignedTileCount = 0;
+	fStats = TileRenderStats{};
+	fRecords.clear();
+	for (const Worker& worker : fWorkers)
+		fRecords.push_back(WorkerRecord{ worker.processID, 0, false });
+
+	const std::chrono::seconds workerTimeout(fOptions.workerTimeoutSeconds);
+	std::vector<pollfd> pollDescriptors;
+	while (fRenderedTileCount < tiles.size()) {
+		ReapWorkers_(false);
+		if (fWorkers.empty() && !fSpawnedWorkers.empty() && std::none_of(fSpawnedWorkers.begin(),
+				fSpawnedWorkers.end(), [](pid_t processID) { return processID > 0; })) {
+			std::cerr << "(Error) Every worker has gone away with " << (tiles.size() - fRenderedTileCount)
+				<< " tiles left to render!" << std::endl;
+			return false;
+		}
+
+		pollDescriptors.clear();
+		pollDescriptors.push_back(pollfd{ fListener->Descriptor(), POLLIN, 0 });
+		for (const Worker& worker : fWorkers)
+			pollDescriptors.push_back(pollfd{ worker.connection->Descriptor(), POLLIN, 0 });
+
+		if (poll(pollDescriptors.data(), pollDescriptors.size(), kPollMilliseconds) < 0 && errno != EINTR) {
+			std::cerr << "(Error) Couldn't wait on the workers: " << std::strerror(errno) << std::endl;
+			return false;
+		}
+
+		for (std::size_t index = 0; index < fWorkers.size(); index++) {
+			Worker& worker = fWorkers[index];
+			if (pollDescriptors[index + 1].revents != 0 && !HandleMessage_(worker, tiles, framebuffer))
+				worker.lost = true;
+			else if (worker.ready && !SendTiles_(worker, tiles))
+				worker.lost = true;
+		}
+
+		// A worker that's stopped finishing tiles without hanging up, because it's stuck or stopped, would otherwise keep
+		// its tiles forever.
+		const auto now = std::chrono::steady_clock::now();
+		for (Worker& worker : fWorkers) {
+			if (worker.lost || worker.tilesInFlight.empty() || now - worker.lastProgress < workerTimeout)
+				continue;
+
+			std::cerr << "\tWorker #" << worker.number << " hasn't finished a tile in " << workerTimeout.count()
+				<< "s, giving up on it" << std::endl;
+			StopWorker_(worker);
+			worker.lost = true;
+		}
+
+		// Hand the tiles lost workers had on the go back out first, as the image can't be finished without them.
+		for (Worker& worker : fWorkers) {
+			if (!worker.lost)
+				continue;
+
+			fRecords[worker.number].lost = true;
+			for (auto tileIndex = worker.tilesInFlight.rbegin(); tileIndex != worker.tilesInFlight.rend(); tileIndex++) {
+				fPendingTiles.push_front(*tileIndex);
+				fReassignedTileCount++;
+			}
+
+			std::cerr << "\tLost worker #" << worker.number << ", handing out its " << worker.tilesInFlight.size()
+				<< " unfinished tiles again" << std::endl;
+		}
+		std::erase_if(fWorkers, [](const Worker& worker) { return worker.lost; });
+
+		if ((pollDescriptors[0].revents & POLLIN) != 0) {
+			std::unique_ptr<Connection> connection = fListener->Accept();
+			if (connection) {
+				const auto number = static_cast<uint32_t>(fRecords.size());
+				fRecords.push_back(WorkerRecord{ 0, 0, false });
+				fWorkers.push_back(Worker{ std::move(connection), number, 0, false, false, {},
+					std::chrono::steady_clock::now() });
+			}
+		}
+	}
+
+	for (Worker& worker : fWorkers)
+		worker.connection->SendMessage(static_cast<uint32_t>(TileMessage::FINISH), {});
+
+	// Workers still waiting to be let in are turned away, so that they exit too.
+	fWorkers.clear();
+	fListener.reset();
+	ReapWorkers_(true);
+
+	fWallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	return true;
+}
+
+bool
+TileCoordinator::HandleMessage_(Worker& worker, const std::vector<Tile>& tiles, Framebuffer& framebuffer)
+{
+	uint32_t type = 0;
+	std::vector<uint8_t> payload;
+	if (!worker.connection->ReceiveMessage(type, payload))
+		return false;
+
+	MessageReader reader(payload);
+	switch (static_cast<TileMessage>(type)) {
+		case TileMessage::HELLO: {
+			uint32_t version = 0;
+			if (!reader.Get(version) || !reader.Get(worker.processID) || version != kTileProtocolVersion) {
+				std::cerr << "\tWorker #" << worker.number << " speaks a different protocol version!" << std::endl;
+				return false;
+			}
+
+			fRecords[worker.number].processID = worker.processID;
+
+			MessageWriter job;
+			write_render_job(job, fOptions);
+			return worker.connection->SendMessage(static_cast<uint32_t>(TileMessage::JOB), job.Bytes());
+		}
+
+		case TileMessage::READY:
+			worker.ready = true;
+			return true;
+
+		case TileMessage::FAILED: {
+			std::string reason;
+			reader.GetString(reason);
+			std::cerr << "\tWorker #" << worker.number << " failed: " << reason << std::endl;
+			return false;
+		}
+
+		case TileMessage::TILE_DONE: {
+			uint32_t tileIndex = 0;
+			TileRenderStats tileStats;
+			if (!read_rendered_tile_header(reader, tileIndex, tileStats) || tileIndex >= tiles.size())
+				return false;
+
+			const auto inFlight = std::find(worker.tilesInFlight.begin(), worker.tilesInFlight.end(), tileIndex);
+			if (inFlight == worker.tilesInFlight.end())
+				return false;
+			worker.tilesInFlight.erase(inFlight);
+			worker.lastProgress = std::chrono::steady_clock::now();
+
+			const Tile& tile = tiles[tileIndex];
+			std::vector<ColorRGB> tilePixels(tile.PixelCount());
+			if (!reader.GetBytes(tilePixels.data(), tilePixels.size() * sizeof(ColorRGB)))
+				return false;
+
+			for (uint32_t row = 0; row < tile.height; row++) {
+				std::copy_n(tilePixels.data() + (static_cast<std::size_t>(row) * tile.width), tile.width,
+					framebuffer.Row(tile.y + row) + tile.x);
+			}
+
+			fTileRendered[tileIndex] = 1;
+			fRenderedTileCount++;
+			fRecords[worker.number].tilesRendered++;
+			fStats += tileStats;
+			return true;
+		}
+
+		default:
+			std::cerr << "\tWorker #" << worker.number << " sent a message we didn't expect!" << std::endl;
+			return false;
+	}
+}
+
+bool
+TileCoordinator::SendTiles_(Worker& worker, const std::vector<Tile>& tiles)
+{
+	while (worker.tilesInFlight.size() < kTilesInFlight && !fPendingTiles.empty()) {
+		const uint32_t tileIndex = fPendingTiles.front();
+		fPendingTiles.pop_front();
+
+		if (worker.tilesInFlight.empty())
+			worker.lastProgress = std::chrono::steady_clock::now();
+		worker.tilesInFlight.push_back(tileIndex);
+
+		MessageWriter tileMessage;
+		tileMessage.Put(tileIndex);
+		tileMessage.Put(tiles[tileIndex]);
+		if (!worker.connection->SendMessage(static_cast<uint32_t>(TileMessage::TILE), tileMessage.Bytes()))
+			return false;
+	}
+
+	return true;
+}
+
+void
+TileCoordinator::StopWorker_(const Worker& worker)
+{
+	// One of ours is killed rather than left hanging, or the coordinator would wait on it forever once it's finished.
+	// Those started elsewhere are only hung up on.
+	const auto spawned = std::find(fSpawnedWorkers.begin(), fSpawnedWorkers.end(), worker.processID);
+	if (worker.processID > 0 && spawned != fSpawnedWorkers.end())
+		kill(*spawned, SIGKILL);
+}
+
+void
+TileCoordinator::ReapWorkers_(bool wait)
+{
+	// Workers we started that have exited are marked with a process ID of 0.
+	for (pid_t& processID : fSpawnedWorkers) {
+		if (processID > 0 && waitpid(processID, nullptr, wait ? 0 : WNOHANG) == processID)
+			processID = 0;
+	}
+}
+
+void
+TileCoordinator::PrintReport(std::ostream& out) const
+{
+	out << "\tRendered " << fTileRendered.size() << " tiles with " << fRecords.size() << " workers in " << fWallSeconds
+		<< "s, handing out " << fReassignedTileCount << " tiles again" << std::endl;
+
+	for (std::size_t number = 0; number < fRecords.size(); number++) {
+		const WorkerRecord& record = fRecords[number];
+		out << "\tWorker #" << number << " (process " << record.processID << "): " << record.tilesRendered << " tiles"
+			<< (record.lost ? ", lost" : "") << std::endl;
+	}
+}
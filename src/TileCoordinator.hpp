@@ -0,0 +1,105 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef TILE_COORDINATOR_H
+#define TILE_COORDINATOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "Framebuffer.hpp"
+#include "RenderOptions.hpp"
+#include "TileRenderer.hpp"
+#include "TileScheduler.hpp"
+#include "Transport.hpp"
+
+/** TileCoordinator */
+
+// Renders an image by handing its tiles out to TileWorker processes, which can be on this machine or any other that
+// can reach the address it listens on, and see the scene file at the same path.
+// Workers are sent a tile whenever they have fewer than kTilesInFlight of them on the go, so faster workers end up
+// rendering more of them. If a worker's connection is lost, or it goes longer than the options' worker timeout without
+// finishing a tile, the tiles it hadn't finished yet are handed out again to the others. Workers can join at any point,
+// including after the render's started.
+class TileCoordinator {
+public:
+	// How many tiles each worker is sent ahead of finishing them, so it's never left waiting on the next one.
+	static constexpr uint32_t kTilesInFlight = 2;
+
+	// How long to wait for a worker to say something, before checking whether the ones we started are still alive.
+	static constexpr int kPollMilliseconds = 1000;
+
+public:
+	// Description: Creates a coordinator that hands out tiles to workers connecting to 'listener', to render as
+	// 'options' says, where the input file path must be one the workers can open.
+	TileCoordinator(std::unique_ptr<Listener> listener, RenderOptions options);
+	~TileCoordinator();
+
+	TileCoordinator(const TileCoordinator& other) = delete;
+	TileCoordinator& operator=(const TileCoordinator& other) = delete;
+
+	// Description: Starts 'count' workers on this machine, by running the program at 'programPath' with "--worker".
+	// Returns: true if they were all started.
+	bool SpawnWorkers(uint32_t count, const std::filesystem::path& programPath);
+
+	// Description: Renders 'tiles' into 'framebuffer', which must be the size of the image. Once it's done, the workers
+	// are sent away and the coordinator stops listening, so it can only render one image.
+	// Returns: true if every tile was rendered. If every worker we started has gone away without another connecting,
+	// there's no one left to render the rest, and false is returned.
+	bool Render(const std::vector<Tile>& tiles, Framebuffer& framebuffer);
+
+	// Description: Returns what went into rendering the tiles of the last Render(), added up over every worker.
+	[[nodiscard]] const TileRenderStats& Stats() const { return fStats; }
+
+	// Description: Prints out how many tiles each worker rendered during the last Render() to the stream 'out'.
+	void PrintReport(std::ostream& out) const;
+
+private:
+	// A connected worker, the tiles it's been sent but hasn't sent back yet, and when it was last sent one while it had
+	// none on the go, or last finished one.
+	struct Worker {
+		std::unique_ptr<Connection> connection;
+		uint32_t number;
+		int32_t processID;
+		bool ready;
+		bool lost;
+		std::deque<uint32_t> tilesInFlight;
+		std::chrono::steady_clock::time_point lastProgress;
+	};
+
+	// What became of a worker, for the report.
+	struct WorkerRecord {
+		int32_t processID;
+		uint32_t tilesRendered;
+		bool lost;
+	};
+
+	bool HandleMessage_(Worker& worker, const std::vector<Tile>& tiles, Framebuffer& framebuffer);
+	bool SendTiles_(Worker& worker, const std::vector<Tile>& tiles);
+	void StopWorker_(const Worker& worker);
+	void ReapWorkers_(bool wait);
+
+	std::unique_ptr<Listener> fListener;
+	RenderOptions fOptions;
+
+	std::vector<pid_t> fSpawnedWorkers;
+	std::vector<Worker> fWorkers;
+	std::vector<WorkerRecord> fRecords;
+
+	// The tiles still to be handed out, and which of them have been rendered.
+	std::deque<uint32_t> fPendingTiles;
+	std::vector<uint8_t> fTileRendered;
+	std::size_t fRenderedTileCount;
+	std::size_t fReassignedTileCount;
+
+	TileRenderStats fStats;
+	double fWallSeconds;
+};
+
+#endif // TILE_COORDINATOR_H
@@ -0,0 +1,101 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef TILE_PROTOCOL_H
+#define TILE_PROTOCOL_H
+
+#include <cstdint>
+#include <vector>
+
+#include "core/ColorRGB.hpp"
+#include "RenderOptions.hpp"
+#include "TileRenderer.hpp"
+#include "TileScheduler.hpp"
+#include "Transport.hpp"
+
+/** Tile Protocol */
+
+// What a TileCoordinator and its TileWorkers say to each other. A worker connects and says HELLO, and is sent the JOB:
+// the path to the scene and how to render it. Once it's loaded the scene, it says it's READY, or that it FAILED, and
+// from then on it's sent a TILE at a time to render, answering each with TILE_DONE and the tile's pixels. When every
+// tile's been rendered, the coordinator says FINISH and the worker exits.
+// Values are sent in the byte order of the machine sending them, so the coordinator and workers must share it.
+enum struct TileMessage : uint32_t {
+	HELLO = 1,
+	JOB,
+	READY,
+	FAILED,
+	TILE,
+	TILE_DONE,
+	FINISH
+};
+
+// Sent along with HELLO, so a worker from a different build isn't handed work it would get wrong.
+static constexpr uint32_t kTileProtocolVersion = 1;
+
+// Description: Writes the parts of 'options' a worker needs to render tiles the same way into 'writer'.
+inline void
+write_render_job(MessageWriter& writer, const RenderOptions& options)
+{
+	writer.PutString(options.inputFilePath.string());
+	writer.Put(options.packetTracing);
+	writer.Put(options.wavefrontRendering);
+	writer.Put(options.depth);
+	writer.Put(options.maxSamples);
+	writer.Put(options.minimumRayWeight);
+	writer.Put(options.russianRoulette);
+}
+
+// Description: Reads the options written by write_render_job() out of 'reader' into 'options'. They still need to be
+// checked with RenderOptions::CheckRenderingChoices() before they're used.
+// Returns: false if the message was cut short, or a bool was anything but 0 or 1.
+inline bool
+read_render_job(MessageReader& reader, RenderOptions& options)
+{
+	std::string inputFilePath;
+	if (!reader.GetString(inputFilePath))
+		return false;
+
+	options.inputFilePath = inputFilePath;
+	return reader.Get(options.packetTracing) && reader.Get(options.wavefrontRendering) && reader.Get(options.depth)
+		&& reader.Get(options.maxSamples) && reader.Get(options.minimumRayWeight) && reader.Get(options.russianRoulette);
+}
+
+// Description: Writes what went into rendering an image, 'stats', into 'writer'.
+inline void
+write_render_stats(MessageWriter& writer, const TileRenderStats& stats)
+{
+	writer.Put(stats.addedSamples);
+	writer.Put(stats.pruning.consideredRays);
+	writer.Put(stats.pruning.prunedRays);
+	writer.Put(stats.pruning.rouletteSurvivors);
+}
+
+// Description: Reads the stats written by write_render_stats() out of 'reader' into 'stats'.
+// Returns: false if the message was cut short.
+inline bool
+read_render_stats(MessageReader& reader, TileRenderStats& stats)
+{
+	return reader.Get(stats.addedSamples) && reader.Get(stats.pruning.consideredRays)
+		&& reader.Get(stats.pruning.prunedRays) && reader.Get(stats.pruning.rouletteSurvivors);
+}
+
+// Description: Writes the rendered pixels of 'tile' at 'tilePixels', and what went into rendering them, 'stats', into
+// 'writer'.
+inline void
+write_rendered_tile(MessageWriter& writer, uint32_t tileIndex, const Tile& tile, const ColorRGB* tilePixels,
+	const TileRenderStats& stats)
+{
+	writer.Put(tileIndex);
+	write_render_stats(writer, stats);
+	writer.PutBytes(tilePixels, tile.PixelCount() * sizeof(ColorRGB));
+}
+
+// Description: Reads the header written by write_rendered_tile() out of 'reader', leaving the pixels to be read.
+// Returns: false if the message was cut short.
+inline bool
+read_rendered_tile_header(MessageReader& reader, uint32_t& tileIndex, TileRenderStats& stats)
+{
+	return reader.Get(tileIndex) && read_render_stats(reader, stats);
+}
+
+#endif // TILE_PROTOCOL_H
@@ -0,0 +1,83 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "TileRenderer.hpp"
+
+#include <array>
+
+#include "core/RayPacket.hpp"
+
+TileRenderer::TileRenderer(const CameraRayGenerator& camera, const SceneDefinition& scene, const RenderOptions& options,
+	CostHeatmap* heatmap)
+	:
+	fCamera(camera),
+	fScene(scene),
+	fDepth(options.depth),
+	fPacketTracing(options.packetTracing),
+	fWavefrontRendering(options.wavefrontRendering),
+	fHeatmap(heatmap),
+	fWavefront(camera, scene, options.depth),
+	fSampler(camera, scene, options.depth, options.maxSamples, options.packetTracing)
+{
+}
+
+TileRenderStats
+TileRenderer::RenderTile(const Tile& tile, ColorRGB* tilePixels) const
+{
+	if (fWavefrontRendering)
+		fWavefront.RenderTile(tile, tilePixels);
+	else if (fPacketTracing)
+		RenderTileWithPackets_(tile, tilePixels);
+	else
+		RenderTileWithRays_(tile, tilePixels);
+
+	TileRenderStats stats;
+	stats.addedSamples = fSampler.RefineTile(tile, tilePixels, fHeatmap);
+	stats.pruning = GraphicsEngine::TakePruningCounters();
+	return stats;
+}
+
+void
+TileRenderer::RenderTileWithRays_(const Tile& tile, ColorRGB* tilePixels) const
+{
+	for (uint32_t row = 0; row < tile.height; row++) {
+		for (uint32_t column = 0; column < tile.width; column++) {
+			const uint64_t costBefore = fHeatmap != nullptr ? fHeatmap->Measure() : 0;
+			const Ray ray = fCamera.GenerateRay(static_cast<float>(tile.x + column), static_cast<float>(tile.y + row));
+
+			tilePixels[(row * tile.width) + column] =
+				GraphicsEngine::TraceWithRay(ray, fScene, fScene.backgroundRefractionIndex, fDepth);
+
+			if (fHeatmap != nullptr)
+				fHeatmap->AddCost(tile.x + column, tile.y + row, static_cast<double>(fHeatmap->Measure() - costBefore));
+		}
+	}
+}
+
+void
+TileRenderer::RenderTileWithPackets_(const Tile& tile, ColorRGB* tilePixels) const
+{
+	const std::size_t pixelCount = tile.PixelCount();
+
+	for (std::size_t firstPixel = 0; firstPixel < pixelCount; firstPixel += kRayPacketSize) {
+		// Neighbouring pixels make for rays pointing in nearly the same direction.
+		const uint64_t costBefore = fHeatmap != nullptr ? fHeatmap->Measure() : 0;
+		RayPacket packet;
+		const std::size_t laneCount = fCamera.GeneratePacket(tile, firstPixel, packet);
+
+		std::array<ColorRGB, kRayPacketSize> colors;
+		GraphicsEngine::TraceWithPacket(packet, fScene, colors.data(), fScene.backgroundRefractionIndex, fDepth);
+
+		for (std::size_t lane = 0; lane < laneCount; lane++)
+			tilePixels[firstPixel + lane] = colors[lane];
+
+		// The packet's pixels were traced together, so they share what it cost.
+		if (fHeatmap != nullptr) {
+			const double laneCost = static_cast<double>(fHeatmap->Measure() - costBefore) / static_cast<double>(laneCount);
+			for (std::size_t lane = 0; lane < laneCount; lane++) {
+				const auto pixel = static_cast<uint32_t>(firstPixel + lane);
+				fHeatmap->AddCost(tile.x + (pixel % tile.width), tile.y + (pixel / tile.width), laneCost);
+			}
+		}
+	}
+}
@@ -0,0 +1,71 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef TILE_RENDERER_H
+#define TILE_RENDERER_H
+
+#include <cstdint>
+
+#include "AdaptiveSampler.hpp"
+#include "CameraRayGenerator.hpp"
+#include "core/ColorRGB.hpp"
+#include "CostHeatmap.hpp"
+#include "GraphicsEngine.hpp"
+#include "RenderOptions.hpp"
+#include "TileScheduler.hpp"
+#include "WavefrontRenderer.hpp"
+
+/** TileRenderStats */
+
+// What went into rendering some tiles, beyond the one sample per pixel every tile gets.
+struct TileRenderStats {
+	// How many antialiasing samples were added.
+	uint64_t addedSamples = 0;
+
+	// How many reflected and refracted rays were considered and pruned.
+	PruningCounters pruning;
+
+	TileRenderStats&
+	operator+=(const TileRenderStats& other)
+	{
+		addedSamples += other.addedSamples;
+		pruning += other.pruning;
+		return *this;
+	}
+};
+
+
+/** TileRenderer */
+
+// Renders whole tiles of a scene the way the command line asked for: traced recursively, one ray or one packet at a
+// time, or a generation of rays at a time with the WavefrontRenderer, and then antialiased by the AdaptiveSampler.
+class TileRenderer {
+public:
+	// Description: Creates a renderer for 'scene', seen through 'camera', with the choices made in 'options'. What each
+	// pixel cost is added to 'heatmap', if given, which can't be used with wavefront rendering.
+	TileRenderer(const CameraRayGenerator& camera, const SceneDefinition& scene, const RenderOptions& options,
+		CostHeatmap* heatmap = nullptr);
+
+	// Description: Returns how many samples are on each side of the grid antialiased pixels are given, which is 0 when
+	// antialiasing is off.
+	[[nodiscard]] uint32_t StrataPerSide() const { return fSampler.StrataPerSide(); }
+
+	// Description: Renders 'tile' into 'tilePixels', row by row.
+	// Returns: What went into rendering it, on top of its one sample per pixel.
+	TileRenderStats RenderTile(const Tile& tile, ColorRGB* tilePixels) const;
+
+private:
+	void RenderTileWithRays_(const Tile& tile, ColorRGB* tilePixels) const;
+	void RenderTileWithPackets_(const Tile& tile, ColorRGB* tilePixels) const;
+
+	const CameraRayGenerator& fCamera;
+	const SceneDefinition& fScene;
+	uint32_t fDepth;
+	bool fPacketTracing;
+	bool fWavefrontRendering;
+	CostHeatmap* fHeatmap;
+
+	WavefrontRenderer fWavefront;
+	AdaptiveSampler fSampler;
+};
+
+#endif // TILE_RENDERER_H
@@ -0,0 +1,183 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "TileScheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+#include <omp.h>
+
+#include "PhaseTrace.hpp"
+
+/* Tile Helpers */
+
+// Description: Interleaves the bits of 'x' and 'y', so that sorting by the result walks a Morton (Z-order) curve.
+static uint64_t
+morton_code(uint32_t x, uint32_t y)
+{
+	const auto spreadBits = [](uint64_t value) {
+		value = (value | (value << 16)) & 0x0000FFFF0000FFFFull;
+		value = (value | (value << 8)) & 0x00FF00FF00FF00FFull;
+		value = (value | (value << 4)) & 0x0F0F0F0F0F0F0F0Full;
+		value = (value | (value << 2)) & 0x3333333333333333ull;
+		value = (value | (value << 1)) & 0x5555555555555555ull;
+		return value;
+	};
+
+	return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+static double
+seconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+/* TileScheduler */
+
+TileScheduler::TileScheduler(const Size& imageSize, uint32_t tileSize)
+	:
+	TileScheduler(Tile{ 0, 0, imageSize.width, imageSize.height }, tileSize)
+{
+}
+
+TileScheduler::TileScheduler(const Tile& region, uint32_t tileSize)
+	:
+	fRegion(region),
+	fTileSize(std::max(tileSize, 1u)),
+	fTiles(),
+	fQueues(),
+	fStats(),
+	fWallSeconds(0.0)
+{
+	const uint32_t columns = (fRegion.width + fTileSize - 1) / fTileSize;
+	const uint32_t rows = (fRegion.height + fTileSize - 1) / fTileSize;
+
+	std::vector<std::pair<uint64_t, Tile>> codedTiles;
+	codedTiles.reserve(static_cast<std::size_t>(columns) * rows);
+	for (uint32_t row = 0; row < rows; row++) {
+		for (uint32_t column = 0; column < columns; column++) {
+			Tile tile{};
+			tile.x = fRegion.x + (column * fTileSize);
+			tile.y = fRegion.y + (row * fTileSize);
+			tile.width = std::min(fTileSize, fRegion.width - (column * fTileSize));
+			tile.height = std::min(fTileSize, fRegion.height - (row * fTileSize));
+			codedTiles.emplace_back(morton_code(column, row), tile);
+		}
+	}
+
+	std::sort(codedTiles.begin(), codedTiles.end(),
+		[](const auto& a, const auto& b) { return a.first < b.first; });
+
+	fTiles.reserve(codedTiles.size());
+	for (const auto& [code, tile] : codedTiles)
+		fTiles.push_back(tile);
+}
+
+std::optional<uint32_t>
+TileScheduler::TakeTile_(std::size_t threadIndex, bool& stolen)
+{
+	{
+		WorkQueue& ownQueue = *fQueues[threadIndex];
+		std::lock_guard<std::mutex> lock(ownQueue.mutex);
+		if (!ownQueue.tiles.empty()) {
+			const uint32_t tileIndex = ownQueue.tiles.front();
+			ownQueue.tiles.pop_front();
+			stolen = false;
+			return tileIndex;
+		}
+	}
+
+	// Nothing left of our own, so take from the far end of someone else's, which is the work they'd get to last.
+	// Tiles are never added back, so once every queue is empty, everything has been handed out.
+	for (std::size_t offset = 1; offset < fQueues.size(); offset++) {
+		WorkQueue& victimQueue = *fQueues[(threadIndex + offset) % fQueues.size()];
+		std::lock_guard<std::mutex> lock(victimQueue.mutex);
+		if (!victimQueue.tiles.empty()) {
+			const uint32_t tileIndex = victimQueue.tiles.back();
+			victimQueue.tiles.pop_back();
+			stolen = true;
+			return tileIndex;
+		}
+	}
+
+	return {};
+}
+
+void
+TileScheduler::Render(const RenderTileFunction& renderTile, Framebuffer& framebuffer)
+{
+	const auto threadCount = static_cast<std::size_t>(std::max(omp_get_max_threads(), 1));
+
+	// Give each thread an equal, contiguous run of the Morton order to start with.
+	fQueues.clear();
+	for (std::size_t threadIndex = 0; threadIndex < threadCount; threadIndex++)
+		fQueues.push_back(std::make_unique<WorkQueue>());
+
+	for (std::size_t tileIndex = 0; tileIndex < fTiles.size(); tileIndex++) {
+		const std::size_t owner = (tileIndex * threadCount) / fTiles.size();
+		fQueues[owner]->tiles.push_back(static_cast<uint32_t>(tileIndex));
+	}
+
+	fStats.assign(threadCount, ThreadStats{});
+
+	const auto renderStart = std::chrono::steady_clock::now();
+
+	#pragma omp parallel num_threads(static_cast<int>(threadCount))
+	{
+		const auto threadIndex = static_cast<std::size_t>(omp_get_thread_num());
+		ThreadStats& stats = fStats[threadIndex];
+
+		// Every tile this thread renders goes into the same buffer first, so that rendering a tile never touches the
+		// image, whose rows are shared with whatever other threads are rendering next to it.
+		std::vector<ColorRGB> tilePixels(static_cast<std::size_t>(fTileSize) * fTileSize);
+
+		bool stolen = false;
+		while (std::optional<uint32_t> tileIndex = TakeTile_(threadIndex, stolen)) {
+			const auto tileStart = std::chrono::steady_clock::now();
+
+			const Tile& tile = fTiles[*tileIndex];
+			ScopedPhaseTimer tileTimer("Tile", "tile");
+			tileTimer.AddArgument("x", tile.x);
+			tileTimer.AddArgument("y", tile.y);
+			tileTimer.AddArgument("width", tile.width);
+			tileTimer.AddArgument("height", tile.height);
+			tileTimer.AddArgument("stolen", stolen ? 1 : 0);
+
+			renderTile(tile, tilePixels.data());
+
+			for (uint32_t row = 0; row < tile.height; row++)
+				std::copy_n(tilePixels.data() + (row * tile.width), tile.width, framebuffer.Row(tile.y + row) + tile.x);
+
+			stats.busySeconds += seconds_since(tileStart);
+			stats.tilesRendered++;
+			stats.tilesStolen += stolen ? 1 : 0;
+		}
+	}
+
+	fWallSeconds = seconds_since(renderStart);
+
+	// Whatever time a thread wasn't rendering, it was looking for work or waiting on the others to finish.
+	for (auto& stats : fStats)
+		stats.idleSeconds = std::max(fWallSeconds - stats.busySeconds, 0.0);
+}
+
+void
+TileScheduler::PrintReport(std::ostream& out) const
+{
+	out << "\tRendered " << fTiles.size() << " tiles of up to " << fTileSize << "x" << fTileSize << " pixels with "
+		<< fStats.size() << " threads in " << fWallSeconds << "s" << std::endl;
+
+	for (std::size_t threadIndex = 0; threadIndex < fStats.size(); threadIndex++) {
+		const ThreadStats& stats = fStats[threadIndex];
+		const double busyPercentage = fWallSeconds > 0.0 ? (100.0 * stats.busySeconds / fWallSeconds) : 0.0;
+
+		out << "\tThread " << threadIndex << ": " << stats.tilesRendered << " tiles (" << stats.tilesStolen
+			<< " stolen), busy " << stats.busySeconds << "s, idle " << stats.idleSeconds << "s ("
+			<< std::fixed << std::setprecision(1) << busyPercentage << "% busy)" << std::defaultfloat
+			<< std::setprecision(6) << std::endl;
+	}
+}
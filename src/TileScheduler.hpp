@@ -0,0 +1,96 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef TILE_SCHEDULER_H
+#define TILE_SCHEDULER_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include "core/ColorRGB.hpp"
+#include "core/TypeDefinitions.hpp"
+#include "Framebuffer.hpp"
+
+/** Tile */
+
+// A rectangle of pixels in the image, which is rendered all together by a single thread.
+struct Tile {
+	uint32_t x;
+	uint32_t y;
+	uint32_t width;
+	uint32_t height;
+
+public:
+	// Description: Returns how many pixels are in this Tile.
+	[[nodiscard]] uint32_t PixelCount() const { return width * height; }
+};
+
+
+/** TileScheduler */
+
+// Splits an image into square tiles and renders them across every OpenMP thread.
+// The tiles are ordered along a Morton (Z-order) curve, so that tiles rendered one after another are next to each other
+// in the image and hit the same objects. Each thread starts out with its own contiguous run of that order, and once it
+// runs out, it steals tiles from the far end of another thread's run, so that expensive parts of the image don't
+// leave the other threads waiting.
+class TileScheduler {
+public:
+	// What one thread did during the last Render().
+	struct ThreadStats {
+		double busySeconds;
+		double idleSeconds;
+		uint32_t tilesRendered;
+		uint32_t tilesStolen;
+	};
+
+	// Renders 'tile' into 'tilePixels', which has room for the Tile's pixels, row by row.
+	using RenderTileFunction = std::function<void(const Tile& tile, ColorRGB* tilePixels)>;
+
+	static constexpr uint32_t kDefaultTileSize = 16;
+
+public:
+	// Description: Splits an image of 'imageSize' into tiles of 'tileSize' by 'tileSize' pixels, with the tiles along
+	// the right and bottom edges cut short.
+	TileScheduler(const Size& imageSize, uint32_t tileSize = kDefaultTileSize);
+
+	// Description: Splits only 'region' of the image into tiles, starting from its top left corner, so that nothing
+	// outside of it is rendered.
+	TileScheduler(const Tile& region, uint32_t tileSize);
+
+	// Description: Returns every tile, in the order they're handed out.
+	[[nodiscard]] const std::vector<Tile>& Tiles() const { return fTiles; }
+
+	// Description: Renders every tile with 'renderTile' into a buffer belonging to the thread rendering it, which is
+	// then copied into 'framebuffer', which must be the size of the image.
+	void Render(const RenderTileFunction& renderTile, Framebuffer& framebuffer);
+
+	// Description: Returns what each thread did during the last Render().
+	[[nodiscard]] const std::vector<ThreadStats>& Stats() const { return fStats; }
+
+	// Description: Prints out how busy each thread was during the last Render() to the stream 'out'.
+	void PrintReport(std::ostream& out) const;
+
+private:
+	// One thread's run of tiles, as indexes into 'fTiles'. The owner takes tiles from the front, thieves from the back.
+	struct WorkQueue {
+		std::mutex mutex;
+		std::deque<uint32_t> tiles;
+	};
+
+	std::optional<uint32_t> TakeTile_(std::size_t threadIndex, bool& stolen);
+
+	Tile fRegion;
+	uint32_t fTileSize;
+	std::vector<Tile> fTiles;
+
+	std::vector<std::unique_ptr<WorkQueue>> fQueues;
+	std::vector<ThreadStats> fStats;
+	double fWallSeconds;
+};
+
+#endif // TILE_SCHEDULER_H
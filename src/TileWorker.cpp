@@ -0,0 +1,91 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "TileWorker.hpp"
+
+#include <iostream>
+#include <vector>
+
+#include <unistd.h>
+
+#include "CameraRayGenerator.hpp"
+#include "GraphicsEngine.hpp"
+#include "SceneLoader.hpp"
+#include "SceneRenderer.hpp"
+#include "TileProtocol.hpp"
+#include "TileRenderer.hpp"
+
+TileWorker::TileWorker(TransportAddress coordinatorAddress)
+	:
+	fCoordinatorAddress(std::move(coordinatorAddress))
+{
+}
+
+bool
+TileWorker::Run()
+{
+	std::unique_ptr<Connection> connection = Connection::Connect(fCoordinatorAddress);
+	if (!connection) {
+		std::cerr << "(Error) Worker couldn't connect to the coordinator at " << fCoordinatorAddress.ToString() << std::endl;
+		return false;
+	}
+
+	MessageWriter hello;
+	hello.Put(kTileProtocolVersion);
+	hello.Put(static_cast<int32_t>(getpid()));
+	if (!connection->SendMessage(static_cast<uint32_t>(TileMessage::HELLO), hello.Bytes()))
+		return false;
+
+	// If the coordinator hangs up before sending a job, it finished the image before we got to help.
+	uint32_t type = 0;
+	std::vector<uint8_t> payload;
+	if (!connection->ReceiveMessage(type, payload) || type != static_cast<uint32_t>(TileMessage::JOB))
+		return false;
+
+	RenderOptions options;
+	MessageReader jobReader(payload);
+	if (!read_render_job(jobReader, options) || !options.CheckRenderingChoices(std::cerr)) {
+		std::cerr << "(Error) Worker was sent a job it couldn't read!" << std::endl;
+		return false;
+	}
+
+	SceneDefinition scene;
+	if (!SceneLoader::Load(options.inputFilePath, scene, std::cout)) {
+		MessageWriter failure;
+		failure.PutString("Couldn't load the scene at " + options.inputFilePath.string());
+		connection->SendMessage(static_cast<uint32_t>(TileMessage::FAILED), failure.Bytes());
+		return false;
+	}
+
+	SceneRenderer::ChoosePruning(scene, options);
+
+	CameraRayGenerator camera(scene);
+	TileRenderer renderer(camera, scene, options);
+	if (!connection->SendMessage(static_cast<uint32_t>(TileMessage::READY), {}))
+		return false;
+
+	std::vector<ColorRGB> tilePixels;
+	while (connection->ReceiveMessage(type, payload)) {
+		if (type == static_cast<uint32_t>(TileMessage::FINISH))
+			return true;
+
+		uint32_t tileIndex = 0;
+		Tile tile{};
+		MessageReader tileReader(payload);
+		if (type != static_cast<uint32_t>(TileMessage::TILE) || !tileReader.Get(tileIndex) || !tileReader.Get(tile)) {
+			std::cerr << "(Error) Worker was sent a message it didn't expect!" << std::endl;
+			return false;
+		}
+
+		tilePixels.resize(tile.PixelCount());
+		const TileRenderStats stats = renderer.RenderTile(tile, tilePixels.data());
+
+		MessageWriter renderedTile;
+		write_rendered_tile(renderedTile, tileIndex, tile, tilePixels.data(), stats);
+		if (!connection->SendMessage(static_cast<uint32_t>(TileMessage::TILE_DONE), renderedTile.Bytes()))
+			break;
+	}
+
+	std::cerr << "(Error) Worker lost its connection to the coordinator!" << std::endl;
+	return false;
+}
@@ -0,0 +1,25 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef TILE_WORKER_H
+#define TILE_WORKER_H
+
+#include "Transport.hpp"
+
+/** TileWorker */
+
+// A process that renders tiles for a TileCoordinator. It connects to the coordinator, is told which scene to load and
+// how to render it, and then renders one tile at a time for as long as the coordinator has tiles to hand out.
+class TileWorker {
+public:
+	// Description: Creates a worker for the coordinator listening at 'coordinatorAddress'.
+	explicit TileWorker(TransportAddress coordinatorAddress);
+
+	// Description: Connects to the coordinator and renders the tiles it hands out until it says it's finished.
+	// Returns: true if the coordinator finished with us, rather than us losing it or failing to load the scene.
+	bool Run();
+
+private:
+	TransportAddress fCoordinatorAddress;
+};
+
+#endif // TILE_WORKER_H
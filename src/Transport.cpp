@@ -0,0 +1,393 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "Transport.hpp"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/* TransportAddress */
+
+std::optional<TransportAddress>
+TransportAddress::Parse(std::string_view text)
+{
+	constexpr std::string_view kUnixPrefix = "unix:";
+	constexpr std::string_view kTCPPrefix = "tcp:";
+
+	TransportAddress address;
+	if (text.starts_with(kUnixPrefix)) {
+		address.kind = Kind::UNIX;
+		address.path = text.substr(kUnixPrefix.size());
+
+		// The path has to fit in a sockaddr_un, terminator and all.
+		if (address.path.empty() || address.path.size() >= sizeof(sockaddr_un::sun_path))
+			return {};
+
+		return address;
+	}
+
+	if (text.starts_with(kTCPPrefix)) {
+		const std::string_view hostAndPort = text.substr(kTCPPrefix.size());
+		const std::size_t colon = hostAndPort.rfind(':');
+		if (colon == std::string_view::npos || colon == 0)
+			return {};
+
+		address.kind = Kind::TCP;
+		address.host = hostAndPort.substr(0, colon);
+
+		const std::string_view port = hostAndPort.substr(colon + 1);
+		const auto [end, error] = std::from_chars(port.data(), port.data() + port.size(), address.port);
+		if (error != std::errc() || end != port.data() + port.size())
+			return {};
+
+		return address;
+	}
+
+	return {};
+}
+
+std::string
+TransportAddress::ToString() const
+{
+	switch (kind) {
+		case Kind::UNIX:
+			return "unix:" + path;
+		case Kind::TCP:
+			return "tcp:" + host + ":" + std::to_string(port);
+	}
+
+	// It "shouldn't" be possible to get here!
+	__builtin_unreachable();
+}
+
+
+/* Socket Helpers */
+
+// Description: Fills 'unixAddress' in with the path of 'address'.
+static void
+make_unix_address(const TransportAddress& address, sockaddr_un& unixAddress)
+{
+	unixAddress = {};
+	unixAddress.sun_family = AF_UNIX;
+	address.path.copy(unixAddress.sun_path, sizeof(unixAddress.sun_path) - 1);
+}
+
+// Description: Looks up the host and port of 'address', for listening on if 'passive' is true, or connecting to.
+// Returns: The list of candidate socket addresses, which must be freed with freeaddrinfo(), or nullptr on failure.
+static addrinfo*
+resolve_tcp_address(const TransportAddress& address, bool passive)
+{
+	addrinfo hints{};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = passive ? AI_PASSIVE : 0;
+
+	addrinfo* results = nullptr;
+	const int error = getaddrinfo(address.host.c_str(), std::to_string(address.port).c_str(), &hints, &results);
+	if (error != 0) {
+		std::cerr << "(Error) Couldn't resolve " << address.ToString() << ": " << gai_strerror(error) << std::endl;
+		return nullptr;
+	}
+
+	return results;
+}
+
+
+// Description: Removes the socket file at the path of 'address' if one was left behind by a process that didn't get to
+// clean up, so it can be bound to again. Anything else at the path, a socket a server is still listening on or a file
+// that isn't a socket at all, is left alone.
+// Returns: true if nothing is at the path anymore.
+static bool
+remove_stale_socket(const TransportAddress& address)
+{
+	struct stat status{};
+	if (lstat(address.path.c_str(), &status) != 0)
+		return errno == ENOENT;
+
+	if (!S_ISSOCK(status.st_mode))
+		return false;
+
+	const int descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (descriptor < 0)
+		return false;
+
+	sockaddr_un unixAddress{};
+	make_unix_address(address, unixAddress);
+	const bool serverAnswered = connect(descriptor, reinterpret_cast<const sockaddr*>(&unixAddress),
+		sizeof(unixAddress)) == 0;
+	close(descriptor);
+
+	return !serverAnswered && unlink(address.path.c_str()) == 0;
+}
+
+
+/* SocketConnection */
+
+// A Connection over a stream socket, which works the same whether it's a UNIX domain or TCP socket.
+class SocketConnection final : public Connection {
+public:
+	explicit SocketConnection(int descriptor)
+		:
+		fDescriptor(descriptor)
+	{
+	}
+
+	~SocketConnection() override
+	{
+		close(fDescriptor);
+	}
+
+	SocketConnection(const SocketConnection& other) = delete;
+	SocketConnection& operator=(const SocketConnection& other) = delete;
+
+	bool
+	Send(const void* data, std::size_t size) override
+	{
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		while (size > 0) {
+			// MSG_NOSIGNAL, so a process that's gone away gives us an error rather than a SIGPIPE.
+			const ssize_t sent = send(fDescriptor, bytes, size, MSG_NOSIGNAL);
+			if (sent < 0 && errno == EINTR)
+				continue;
+			if (sent <= 0)
+				return false;
+
+			bytes += sent;
+			size -= static_cast<std::size_t>(sent);
+		}
+
+		return true;
+	}
+
+	bool
+	Receive(void* data, std::size_t size) override
+	{
+		auto* bytes = static_cast<uint8_t*>(data);
+		while (size > 0) {
+			const ssize_t received = recv(fDescriptor, bytes, size, 0);
+			if (received < 0 && errno == EINTR)
+				continue;
+			if (received <= 0)
+				return false;
+
+			bytes += received;
+			size -= static_cast<std::size_t>(received);
+		}
+
+		return true;
+	}
+
+	[[nodiscard]] int Descriptor() const override { return fDescriptor; }
+
+private:
+	int fDescriptor;
+};
+
+
+/* SocketListener */
+
+// A Listener on a stream socket. A UNIX domain socket's file is removed again once it stops listening, as long as it's
+// still the one it bound, and hasn't been replaced by something else in the meantime.
+class SocketListener final : public Listener {
+public:
+	SocketListener(int descriptor, TransportAddress address)
+		:
+		fDescriptor(descriptor),
+		fAddress(std::move(address)),
+		fSocketFile()
+	{
+		if (fAddress.kind == TransportAddress::Kind::UNIX)
+			lstat(fAddress.path.c_str(), &fSocketFile);
+	}
+
+	~SocketListener() override
+	{
+		close(fDescriptor);
+		if (fAddress.kind != TransportAddress::Kind::UNIX)
+			return;
+
+		struct stat status{};
+		if (lstat(fAddress.path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode) && status.st_dev == fSocketFile.st_dev
+			&& status.st_ino == fSocketFile.st_ino)
+			unlink(fAddress.path.c_str());
+	}
+
+	SocketListener(const SocketListener& other) = delete;
+	SocketListener& operator=(const SocketListener& other) = delete;
+
+	std::unique_ptr<Connection>
+	Accept() override
+	{
+		int descriptor = -1;
+		do {
+			descriptor = accept(fDescriptor, nullptr, nullptr);
+		} while (descriptor < 0 && errno == EINTR);
+
+		if (descriptor < 0)
+			return nullptr;
+
+		if (fAddress.kind == TransportAddress::Kind::TCP) {
+			// Messages are small and answered right away, so don't hold them back waiting to fill a segment.
+			const int enable = 1;
+			setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+		}
+
+		return std::make_unique<SocketConnection>(descriptor);
+	}
+
+	[[nodiscard]] int Descriptor() const override { return fDescriptor; }
+
+	[[nodiscard]] TransportAddress Address() const override { return fAddress; }
+
+private:
+	int fDescriptor;
+	TransportAddress fAddress;
+	struct stat fSocketFile;
+};
+
+
+/* Connection */
+
+std::unique_ptr<Connection>
+Connection::Connect(const TransportAddress& address)
+{
+	if (address.kind == TransportAddress::Kind::UNIX) {
+		const int descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (descriptor < 0)
+			return nullptr;
+
+		sockaddr_un unixAddress{};
+		make_unix_address(address, unixAddress);
+		if (connect(descriptor, reinterpret_cast<const sockaddr*>(&unixAddress), sizeof(unixAddress)) != 0) {
+			close(descriptor);
+			return nullptr;
+		}
+
+		return std::make_unique<SocketConnection>(descriptor);
+	}
+
+	addrinfo* results = resolve_tcp_address(address, false);
+	if (results == nullptr)
+		return nullptr;
+
+	int descriptor = -1;
+	for (const addrinfo* result = results; result != nullptr; result = result->ai_next) {
+		descriptor = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+		if (descriptor < 0)
+			continue;
+
+		if (connect(descriptor, result->ai_addr, result->ai_addrlen) == 0)
+			break;
+
+		close(descriptor);
+		descriptor = -1;
+	}
+	freeaddrinfo(results);
+
+	if (descriptor < 0)
+		return nullptr;
+
+	const int enable = 1;
+	setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+	return std::make_unique<SocketConnection>(descriptor);
+}
+
+bool
+Connection::SendMessage(uint32_t type, const std::vector<uint8_t>& payload)
+{
+	const uint32_t header[2] = { type, static_cast<uint32_t>(payload.size()) };
+	return Send(header, sizeof(header)) && Send(payload.data(), payload.size());
+}
+
+bool
+Connection::ReceiveMessage(uint32_t& type, std::vector<uint8_t>& payload)
+{
+	uint32_t header[2] = {};
+	if (!Receive(header, sizeof(header)) || header[1] > kMaxPayloadSize)
+		return false;
+
+	type = header[0];
+	payload.resize(header[1]);
+	return Receive(payload.data(), payload.size());
+}
+
+
+/* Listener */
+
+std::unique_ptr<Listener>
+Listener::Listen(const TransportAddress& address)
+{
+	constexpr int kBacklog = 64;
+
+	if (address.kind == TransportAddress::Kind::UNIX) {
+		// A socket file left behind by a process that didn't get to clean up would stop us from binding. Anything else at
+		// the path is someone else's, and is never removed.
+		if (!remove_stale_socket(address)) {
+			std::cerr << "(Error) Couldn't listen on " << address.ToString() << ": address in use" << std::endl;
+			return nullptr;
+		}
+
+		const int descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (descriptor < 0)
+			return nullptr;
+
+		sockaddr_un unixAddress{};
+		make_unix_address(address, unixAddress);
+		if (bind(descriptor, reinterpret_cast<const sockaddr*>(&unixAddress), sizeof(unixAddress)) != 0
+			|| listen(descriptor, kBacklog) != 0) {
+			std::cerr << "(Error) Couldn't listen on " << address.ToString() << ": " << std::strerror(errno) << std::endl;
+			close(descriptor);
+			return nullptr;
+		}
+
+		return std::make_unique<SocketListener>(descriptor, address);
+	}
+
+	addrinfo* results = resolve_tcp_address(address, true);
+	if (results == nullptr)
+		return nullptr;
+
+	int descriptor = -1;
+	for (const addrinfo* result = results; result != nullptr; result = result->ai_next) {
+		descriptor = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+		if (descriptor < 0)
+			continue;
+
+		const int enable = 1;
+		setsockopt(descriptor, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+		if (bind(descriptor, result->ai_addr, result->ai_addrlen) == 0 && listen(descriptor, kBacklog) == 0)
+			break;
+
+		close(descriptor);
+		descriptor = -1;
+	}
+	freeaddrinfo(results);
+
+	if (descriptor < 0) {
+		std::cerr << "(Error) Couldn't listen on " << address.ToString() << std::endl;
+		return nullptr;
+	}
+
+	// Find out which port we got, in case any free one was asked for.
+	TransportAddress boundAddress = address;
+	sockaddr_storage socketAddress{};
+	socklen_t socketAddressSize = sizeof(socketAddress);
+	if (getsockname(descriptor, reinterpret_cast<sockaddr*>(&socketAddress), &socketAddressSize) == 0) {
+		if (socketAddress.ss_family == AF_INET)
+			boundAddress.port = ntohs(reinterpret_cast<const sockaddr_in&>(socketAddress).sin_port);
+		else if (socketAddress.ss_family == AF_INET6)
+			boundAddress.port = ntohs(reinterpret_cast<const sockaddr_in6&>(socketAddress).sin6_port);
+	}
+
+	return std::make_unique<SocketListener>(descriptor, boundAddress);
+}
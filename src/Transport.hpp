@@ -0,0 +1,208 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/** TransportAddress */
+
+// Where to listen for, or connect to, another process. Written as "unix:<path>" for a UNIX domain socket, or as
+// "tcp:<host>:<port>" for a TCP socket, where a port of 0 listens on any free port.
+struct TransportAddress {
+	enum struct Kind {
+		UNIX,
+		TCP
+	};
+
+	Kind kind = Kind::UNIX;
+
+	// UNIX domain sockets
+	std::string path;
+
+	// TCP sockets
+	std::string host;
+	uint16_t port = 0;
+
+public:
+	// Description: Parses 'text' as an address in one of the forms above.
+	// Returns: The address, or nothing if 'text' isn't one.
+	static std::optional<TransportAddress> Parse(std::string_view text);
+
+	// Description: Returns the address written out in the form Parse() takes.
+	[[nodiscard]] std::string ToString() const;
+};
+
+
+/** MessageWriter */
+
+// Builds up the payload of a message out of plain values, in the byte order of the machine writing it.
+class MessageWriter {
+public:
+	template<typename T>
+	void
+	Put(const T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		if constexpr (std::is_same_v<T, bool>) {
+			// A byte that's always 0 or 1, whatever a bool looks like in memory.
+			const uint8_t byte = value ? 1 : 0;
+			PutBytes(&byte, sizeof(byte));
+		} else {
+			PutBytes(&value, sizeof(T));
+		}
+	}
+
+	void
+	PutString(std::string_view text)
+	{
+		Put(static_cast<uint32_t>(text.size()));
+		PutBytes(text.data(), text.size());
+	}
+
+	void
+	PutBytes(const void* data, std::size_t size)
+	{
+		if (size == 0)
+			return;
+
+		const std::size_t offset = fBytes.size();
+		fBytes.resize(offset + size);
+		std::memcpy(fBytes.data() + offset, data, size);
+	}
+
+	[[nodiscard]] const std::vector<uint8_t>& Bytes() const { return fBytes; }
+
+private:
+	std::vector<uint8_t> fBytes;
+};
+
+
+/** MessageReader */
+
+// Reads the values a MessageWriter put into a payload back out, in the same order.
+class MessageReader {
+public:
+	explicit MessageReader(const std::vector<uint8_t>& bytes)
+		:
+		fBytes(bytes),
+		fOffset(0)
+	{
+	}
+
+	// Description: Reads the next value into 'value'.
+	// Returns: false if the payload ran out first, or a bool was anything but 0 or 1.
+	template<typename T>
+	bool
+	Get(T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		if constexpr (std::is_same_v<T, bool>) {
+			// Copying any other byte into a bool would be undefined.
+			uint8_t byte = 0;
+			if (!GetBytes(&byte, sizeof(byte)) || byte > 1)
+				return false;
+
+			value = byte == 1;
+			return true;
+		} else {
+			return GetBytes(&value, sizeof(T));
+		}
+	}
+
+	bool
+	GetString(std::string& text)
+	{
+		uint32_t size = 0;
+		if (!Get(size) || size > fBytes.size() - fOffset)
+			return false;
+
+		text.assign(reinterpret_cast<const char*>(fBytes.data() + fOffset), size);
+		fOffset += size;
+		return true;
+	}
+
+	bool
+	GetBytes(void* data, std::size_t size)
+	{
+		if (size > fBytes.size() - fOffset)
+			return false;
+
+		std::memcpy(data, fBytes.data() + fOffset, size);
+		fOffset += size;
+		return true;
+	}
+
+private:
+	const std::vector<uint8_t>& fBytes;
+	std::size_t fOffset;
+};
+
+
+/** Connection */
+
+// A reliable, ordered stream of bytes to another process, which messages are sent over as a type, a length, and then
+// a payload of that length.
+class Connection {
+public:
+	// The largest payload a message can have, so a corrupt length can't make us try to allocate the world.
+	static constexpr uint32_t kMaxPayloadSize = 256 * 1024 * 1024;
+
+public:
+	virtual ~Connection() = default;
+
+	// Description: Connects to whatever is listening at 'address'.
+	// Returns: The connection, or nothing if it couldn't be made.
+	static std::unique_ptr<Connection> Connect(const TransportAddress& address);
+
+	// Description: Sends all 'size' bytes at 'data'.
+	// Returns: false if the connection was lost.
+	virtual bool Send(const void* data, std::size_t size) = 0;
+
+	// Description: Waits for exactly 'size' bytes, reading them into 'data'.
+	// Returns: false if the connection was lost or closed first.
+	virtual bool Receive(void* data, std::size_t size) = 0;
+
+	// Description: Returns the file descriptor to poll() for when there's something to receive.
+	[[nodiscard]] virtual int Descriptor() const = 0;
+
+	// Description: Sends a message of type 'type' carrying 'payload'.
+	// Returns: false if the connection was lost.
+	bool SendMessage(uint32_t type, const std::vector<uint8_t>& payload);
+
+	// Description: Waits for the next message, reading its type into 'type' and its payload into 'payload'.
+	// Returns: false if the connection was lost or closed, or the message was too big.
+	bool ReceiveMessage(uint32_t& type, std::vector<uint8_t>& payload);
+};
+
+
+/** Listener */
+
+// Waits for other processes to connect at an address.
+class Listener {
+public:
+	virtual ~Listener() = default;
+
+	// Description: Starts listening at 'address'.
+	// Returns: The listener, or nothing if the address couldn't be listened on.
+	static std::unique_ptr<Listener> Listen(const TransportAddress& address);
+
+	// Description: Takes the next process waiting to connect.
+	// Returns: The connection to it, or nothing if it couldn't be accepted.
+	virtual std::unique_ptr<Connection> Accept() = 0;
+
+	// Description: Returns the file descriptor to poll() for when a process is waiting to connect.
+	[[nodiscard]] virtual int Descriptor() const = 0;
+
+	// Description: Returns the address being listened on, with the port filled in if any free port was asked for.
+	[[nodiscard]] virtual TransportAddress Address() const = 0;
+};
+
+#endif // TRANSPORT_H
@@ -0,0 +1,280 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "WavefrontRenderer.hpp"
+
+#include <array>
+#include <cmath>
+
+#include "core/RayPacket.hpp"
+#include "core/RayStats.hpp"
+
+/* Wavefront Helpers */
+
+// Description: Returns which of the 8 octants 'direction' points into, from the signs of its components.
+static uint32_t
+direction_octant(const Vector3D& direction)
+{
+	return (std::signbit(direction.dx) ? 1u : 0u) | (std::signbit(direction.dy) ? 2u : 0u)
+		| (std::signbit(direction.dz) ? 4u : 0u);
+}
+
+// Description: Returns 'color' scaled by 'weight', rounded the same way GraphicsEngine::ShadeWithRay() rounds what a
+// reflected or refracted ray found.
+static ColorRGB
+scale_color(const ColorRGB& color, float weight)
+{
+	const auto [red, green, blue] = color.ToFloat();
+	return ColorRGB(red * weight, green * weight, blue * weight);
+}
+
+
+/* WavefrontRenderer */
+
+WavefrontRenderer::WavefrontRenderer(const CameraRayGenerator& camera, const SceneDefinition& scene, uint32_t depth)
+	:
+	fCamera(camera),
+	fScene(scene),
+	fDepth(depth)
+{
+}
+
+void
+WavefrontRenderer::SortByOctant_(std::vector<QueuedRay>& rays, std::vector<QueuedRay>& scratch)
+{
+	// Rays pointing into the same octant take the same near to far order through the hierarchy's nodes, so packets of
+	// them split up less. A counting sort keeps rays from the same pixels together within each octant.
+	std::array<std::size_t, 9> octantStarts{};
+	for (const QueuedRay& queuedRay : rays)
+		octantStarts[direction_octant(queuedRay.ray.direction) + 1]++;
+
+	for (std::size_t octant = 1; octant < octantStarts.size(); octant++)
+		octantStarts[octant] += octantStarts[octant - 1];
+
+	scratch.resize(rays.size());
+	for (const QueuedRay& queuedRay : rays)
+		scratch[octantStarts[direction_octant(queuedRay.ray.direction)]++] = queuedRay;
+
+	rays.swap(scratch);
+}
+
+void
+WavefrontRenderer::IntersectRays_(const std::vector<QueuedRay>& rays, bool coherent, std::vector<HitRecord>& hits,
+	std::vector<Bounce>& bounces) const
+{
+	hits.assign(rays.size(), HitRecord{});
+
+	// Rays that have bounced around point every which way, and a packet of them ends up visiting the union of the nodes
+	// each would visit on its own, which is slower than just tracing them one at a time.
+	if (!coherent) {
+		for (std::size_t rayIndex = 0; rayIndex < rays.size(); rayIndex++) {
+			const QueuedRay& queuedRay = rays[rayIndex];
+
+			// The ray didn't hit any objects, oh well...
+			if (!fScene.objectHierarchy.IntersectClosest(queuedRay.ray, hits[rayIndex])) {
+				RAY_STATS_ADD(closestMisses, 1);
+				hits[rayIndex].object = nullptr;
+				bounces[queuedRay.bounce].color = fScene.backgroundColor;
+				continue;
+			}
+
+			RAY_STATS_ADD(closestHits, 1);
+		}
+
+		return;
+	}
+
+	for (std::size_t firstRay = 0; firstRay < rays.size(); firstRay += kRayPacketSize) {
+		const std::size_t laneCount = std::min(kRayPacketSize, rays.size() - firstRay);
+
+		RayPacket packet;
+		for (std::size_t lane = 0; lane < laneCount; lane++)
+			packet.SetRay(lane, rays[firstRay + lane].ray);
+
+		fScene.objectHierarchy.IntersectClosest(packet);
+
+		for (std::size_t lane = 0; lane < laneCount; lane++) {
+			const QueuedRay& queuedRay = rays[firstRay + lane];
+
+			// The ray didn't hit any objects, oh well...
+			if (packet.objectIndex[lane] == kNoObjectHit) {
+				RAY_STATS_ADD(closestMisses, 1);
+				bounces[queuedRay.bounce].color = fScene.backgroundColor;
+				continue;
+			}
+
+			RAY_STATS_ADD(closestHits, 1);
+			GraphicsEngine::FillPacketHitRecord(packet, lane, fScene, hits[firstRay + lane]);
+		}
+	}
+}
+
+void
+WavefrontRenderer::TraceShadows_(const std::vector<QueuedRay>& rays, const std::vector<HitRecord>& hits,
+	std::vector<float>& shadows) const
+{
+	const std::size_t lightCount = fScene.lightList.size();
+	shadows.assign(rays.size() * lightCount, 0.f);
+
+	std::vector<ShadowRay> shadowRays;
+	shadowRays.reserve(rays.size());
+
+	// Every shadow ray towards the same light is traced together. Shadow rays towards a directional light all point the
+	// same way, so they're traced in packets, but those towards a point light fan out, and are traced one at a time.
+	for (std::size_t lightIndex = 0; lightIndex < lightCount; lightIndex++) {
+		const SharedLight& light = fScene.lightList[lightIndex];
+		const bool coherent = light->Type() == Light::DIRECTIONAL_LIGHT;
+
+		shadowRays.clear();
+		for (std::size_t rayIndex = 0; rayIndex < rays.size(); rayIndex++) {
+			const HitRecord& hit = hits[rayIndex];
+			if (hit.object == nullptr)
+				continue;
+
+			// Same as GraphicsEngine::CalculateShadow()
+			const Point3D& startPoint = hit.position;
+			const Vector3D& surfaceNormal = hit.shadingNormal;
+			const std::optional<Vector3D> vectorL = light->CalculateL(startPoint);
+
+			ShadowRay shadowRay{};
+			shadowRay.selfShadow = 1.f;
+			shadowRay.shadowIndex = static_cast<uint32_t>((rayIndex * lightCount) + lightIndex);
+			if (vectorL.has_value() && std::isless(surfaceNormal.DotProduct(*vectorL), 0.0f)) {
+				shadowRay.selfShadow *= (1.f - hit.object->material.opacity);
+				if (shadowRay.selfShadow <= 0.f)
+					continue;
+
+				shadowRay.ignoredObject = hit.object;
+				shadowRay.ignoredInstance = hit.instance;
+			}
+
+			shadowRay.ray = light->GenerateShadowRay(startPoint, surfaceNormal);
+			shadowRay.maxTime = light->DistanceToLight(shadowRay.ray.origin);
+			shadowRays.push_back(shadowRay);
+		}
+
+		RAY_STATS_ADD(shadowRays, shadowRays.size());
+
+		if (!coherent) {
+			for (const ShadowRay& shadowRay : shadowRays) {
+				shadows[shadowRay.shadowIndex] = shadowRay.selfShadow * fScene.objectHierarchy.Transmittance(shadowRay.ray,
+					shadowRay.maxTime, shadowRay.ignoredObject, shadowRay.ignoredInstance);
+			}
+
+			continue;
+		}
+
+		for (std::size_t firstRay = 0; firstRay < shadowRays.size(); firstRay += kRayPacketSize) {
+			const std::size_t laneCount = std::min(kRayPacketSize, shadowRays.size() - firstRay);
+
+			RayPacket shadowPacket;
+			std::array<const Object*, kRayPacketSize> ignoredObjects{};
+			std::array<const Object*, kRayPacketSize> ignoredInstances{};
+			for (std::size_t lane = 0; lane < laneCount; lane++) {
+				const ShadowRay& shadowRay = shadowRays[firstRay + lane];
+				shadowPacket.SetRay(lane, shadowRay.ray, shadowRay.maxTime);
+				ignoredObjects[lane] = shadowRay.ignoredObject;
+				ignoredInstances[lane] = shadowRay.ignoredInstance;
+			}
+
+			std::array<float, kRayPacketSize> transmittances{};
+			fScene.objectHierarchy.Transmittance(shadowPacket, ignoredObjects.data(), ignoredInstances.data(),
+				transmittances.data());
+
+			for (std::size_t lane = 0; lane < laneCount; lane++) {
+				const ShadowRay& shadowRay = shadowRays[firstRay + lane];
+				shadows[shadowRay.shadowIndex] = shadowRay.selfShadow * transmittances[lane];
+			}
+		}
+	}
+}
+
+void
+WavefrontRenderer::RenderTile(const Tile& tile, ColorRGB* tilePixels) const
+{
+	const std::size_t pixelCount = tile.PixelCount();
+	const std::size_t lightCount = fScene.lightList.size();
+
+	// (1) Start off with a ray through every pixel of the tile, whose bounces come first, in the same order.
+	std::vector<Bounce> bounces(pixelCount, Bounce{ ColorRGB(), 1.f, 0 });
+	std::vector<QueuedRay> rays;
+	rays.reserve(pixelCount);
+	for (uint32_t row = 0; row < tile.height; row++) {
+		for (uint32_t column = 0; column < tile.width; column++) {
+			QueuedRay queuedRay{};
+			queuedRay.ray = fCamera.GenerateRay(static_cast<float>(tile.x + column), static_cast<float>(tile.y + row));
+			queuedRay.weight = 1.f;
+			queuedRay.previousRefractionIndex = fScene.backgroundRefractionIndex;
+			queuedRay.bounce = (row * tile.width) + column;
+			queuedRay.depth = fDepth;
+			rays.push_back(queuedRay);
+		}
+	}
+
+	std::vector<QueuedRay> nextRays;
+	std::vector<QueuedRay> refractedRays;
+	std::vector<QueuedRay> scratch;
+	std::vector<HitRecord> hits;
+	std::vector<float> shadows;
+	for (uint32_t bounce = 0; !rays.empty(); bounce++) {
+		// (2) Find what every ray hits, and (3) how much of each light reaches those hits. Only the rays from the eye
+		// start out pointing in nearly the same direction.
+		SortByOctant_(rays, scratch);
+		IntersectRays_(rays, bounce == 0, hits, bounces);
+		TraceShadows_(rays, hits, shadows);
+
+		// (4) Shade every hit, and queue up the rays they send on.
+		nextRays.clear();
+		refractedRays.clear();
+		for (std::size_t rayIndex = 0; rayIndex < rays.size(); rayIndex++) {
+			const QueuedRay& queuedRay = rays[rayIndex];
+			const HitRecord& hit = hits[rayIndex];
+			if (hit.object == nullptr)
+				continue;
+
+			SecondaryRays secondaryRays{};
+			bounces[queuedRay.bounce].color = GraphicsEngine::ShadeSurface(queuedRay.ray, hit, fScene,
+				queuedRay.previousRefractionIndex, shadows.data() + (rayIndex * lightCount), secondaryRays);
+
+			if (queuedRay.depth == 0)
+				continue;
+
+			// Same as GraphicsEngine::ShadeWithRay(), the rays sent on keep the refraction index of the incoming ray.
+			QueuedRay nextRay = queuedRay;
+			nextRay.depth = queuedRay.depth - 1;
+			const auto sendOn = [&](const Ray& ray, float weight, std::vector<QueuedRay>& queue) {
+				nextRay.ray = ray;
+				nextRay.weight = queuedRay.weight * weight;
+				nextRay.bounce = static_cast<uint32_t>(bounces.size());
+				bounces.push_back(Bounce{ ColorRGB(), weight, queuedRay.bounce });
+				queue.push_back(nextRay);
+			};
+
+			// Rays too light to be worth tracing are dropped here, just like GraphicsEngine::ShadeWithRay() would.
+			float compensation = 1.f;
+			if (secondaryRays.refracts && GraphicsEngine::KeepSecondaryRay(secondaryRays.refractedRay,
+					queuedRay.weight * secondaryRays.refractedWeight, fScene.pruning, compensation)) {
+				sendOn(secondaryRays.refractedRay, secondaryRays.refractedWeight * compensation, refractedRays);
+				RAY_STATS_ADD(refractedRays, 1);
+			}
+
+			if (GraphicsEngine::KeepSecondaryRay(secondaryRays.reflectedRay,
+					queuedRay.weight * secondaryRays.reflectedWeight, fScene.pruning, compensation)) {
+				sendOn(secondaryRays.reflectedRay, secondaryRays.reflectedWeight * compensation, nextRays);
+				RAY_STATS_ADD(reflectedRays, 1);
+			}
+		}
+
+		// Refracted rays go after all the reflected ones, so neighbouring pixels' rays of each kind stay together.
+		nextRays.insert(nextRays.end(), refractedRays.begin(), refractedRays.end());
+		rays.swap(nextRays);
+	}
+
+	// (5) Every ray was sent on after the one that sent it, so going backwards, each ray's color is complete by the time
+	// it's mixed into its parent's.
+	for (std::size_t bounce = bounces.size() - 1; bounce >= pixelCount; bounce--)
+		bounces[bounces[bounce].parent].color += scale_color(bounces[bounce].color, bounces[bounce].weight);
+
+	for (std::size_t pixel = 0; pixel < pixelCount; pixel++)
+		tilePixels[pixel] = bounces[pixel].color;
+}
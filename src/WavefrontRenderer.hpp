@@ -0,0 +1,74 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef WAVEFRONT_RENDERER_H
+#define WAVEFRONT_RENDERER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "CameraRayGenerator.hpp"
+#include "core/ColorRGB.hpp"
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "GraphicsEngine.hpp"
+#include "TileScheduler.hpp"
+
+/** WavefrontRenderer */
+
+// Renders a tile a whole generation of rays at a time, rather than following each ray's reflections and refractions
+// down before moving on to the next, like GraphicsEngine::TraceWithRay() does.
+// Each pass takes every ray waiting in the queue, sorts them by which octant they point into, and intersects them with
+// the scene in packets. Then the shadow rays for every hit are traced, again in packets and grouped by light. Finally,
+// each hit is shaded, and queues up the rays it reflects and refracts for the next pass.
+// Every ray's color is kept until the last pass is done, and then each is mixed into the color of the ray that sent it
+// on, last bounce first, rounding and clamping the same way GraphicsEngine::ShadeWithRay() does at every bounce, so
+// that images come out the same as the recursive renderer's.
+class WavefrontRenderer {
+public:
+	// Description: Creates a renderer for 'scene', following rays from 'camera' through 'depth' bounces.
+	WavefrontRenderer(const CameraRayGenerator& camera, const SceneDefinition& scene, uint32_t depth);
+
+	// Description: Renders 'tile' into 'tilePixels', row by row.
+	void RenderTile(const Tile& tile, ColorRGB* tilePixels) const;
+
+private:
+	// A ray waiting to be traced, along with how much of what it finds makes it to its pixel, and how many more bounces
+	// it can take after this one.
+	struct QueuedRay {
+		Ray ray;
+		float weight;
+		float previousRefractionIndex;
+		uint32_t bounce;
+		uint32_t depth;
+	};
+
+	// What a ray found: the color of the surface it hit, or the background, which the colors of the rays it sent on are
+	// mixed into, and how much of it makes it into the color of the ray that sent it, 'parent'.
+	struct Bounce {
+		ColorRGB color;
+		float weight;
+		uint32_t parent;
+	};
+
+	// A ray towards a light from a hit, which only needs to know how much light makes it through.
+	struct ShadowRay {
+		Ray ray;
+		float maxTime;
+		float selfShadow;
+		const Object* ignoredObject;
+		const Object* ignoredInstance;
+		uint32_t shadowIndex;
+	};
+
+	static void SortByOctant_(std::vector<QueuedRay>& rays, std::vector<QueuedRay>& scratch);
+	void IntersectRays_(const std::vector<QueuedRay>& rays, bool coherent, std::vector<HitRecord>& hits,
+		std::vector<Bounce>& bounces) const;
+	void TraceShadows_(const std::vector<QueuedRay>& rays, const std::vector<HitRecord>& hits,
+		std::vector<float>& shadows) const;
+
+	const CameraRayGenerator& fCamera;
+	const SceneDefinition& fScene;
+	uint32_t fDepth;
+};
+
+#endif // WAVEFRONT_RENDERER_H
@@ -0,0 +1,133 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef BOUNDING_BOX_H
+#define BOUNDING_BOX_H
+
+#include <algorithm>
+#include <limits>
+
+#include "Point.hpp"
+#include "Ray.hpp"
+#include "RayStats.hpp"
+#include "Vector3D.hpp"
+
+/** BoundingBox */
+
+// An axis aligned box enclosing some region of space.
+struct BoundingBox {
+	Point3D min;
+	Point3D max;
+
+public:
+	// Description: Constructs an empty box, which contains nothing until it's expanded.
+	BoundingBox()
+		:
+		min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()),
+		max(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max())
+	{
+	}
+
+	BoundingBox(const Point3D& min, const Point3D& max)
+		:
+		min(min),
+		max(max)
+	{
+	}
+
+	// Description: Returns true if this box doesn't contain any space.
+	[[nodiscard]] bool
+	Empty() const
+	{
+		return min.x > max.x || min.y > max.y || min.z > max.z;
+	}
+
+	// Description: Grows this box to contain 'point'.
+	void
+	Expand(const Point3D& point)
+	{
+		min.x = std::min(min.x, point.x);
+		min.y = std::min(min.y, point.y);
+		min.z = std::min(min.z, point.z);
+
+		max.x = std::max(max.x, point.x);
+		max.y = std::max(max.y, point.y);
+		max.z = std::max(max.z, point.z);
+	}
+
+	// Description: Grows this box to contain the box 'other'.
+	void
+	Expand(const BoundingBox& other)
+	{
+		if (other.Empty())
+			return;
+
+		Expand(other.min);
+		Expand(other.max);
+	}
+
+	// Description: Returns the point at the center of this box.
+	[[nodiscard]] Point3D
+	Centroid() const
+	{
+		return {(min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f};
+	}
+
+	// Description: Returns the component of 'point' along 'axis' (0 = x, 1 = y, 2 = z).
+	[[nodiscard]] static float
+	AxisValue(const Point3D& point, int axis)
+	{
+		return axis == 0 ? point.x : (axis == 1 ? point.y : point.z);
+	}
+
+	// Description: Returns the axis (0 = x, 1 = y, 2 = z) along which this box is the longest.
+	[[nodiscard]] int
+	LongestAxis() const
+	{
+		const Vector3D extent(min, max);
+		if (extent.dx >= extent.dy && extent.dx >= extent.dz)
+			return 0;
+
+		return extent.dy >= extent.dz ? 1 : 2;
+	}
+
+	// Description: Calculates the surface area of this box, which is what the surface area heuristic weighs
+	// the chance of a ray hitting this box with.
+	[[nodiscard]] float
+	SurfaceArea() const
+	{
+		if (Empty())
+			return 0.f;
+
+		const Vector3D extent(min, max);
+		return 2.f * ((extent.dx * extent.dy) + (extent.dy * extent.dz) + (extent.dz * extent.dx));
+	}
+
+	// Description: Slab test between this box and a ray starting at 'origin' with the reciprocal direction
+	// 'inverseDirection'. Only hits within the interval [0, 'maxTime'] are counted.
+	// Returns: true if the ray passes through the box, with the time it enters the box stored in 'entryTime'.
+	[[nodiscard]] bool
+	IntersectWith(const Point3D& origin, const Vector3D& inverseDirection, float maxTime, float& entryTime) const
+	{
+		RAY_STATS_ADD(boxTests, 1);
+
+		float tx1 = (min.x - origin.x) * inverseDirection.dx;
+		float tx2 = (max.x - origin.x) * inverseDirection.dx;
+		float tNear = std::min(tx1, tx2);
+		float tFar = std::max(tx1, tx2);
+
+		float ty1 = (min.y - origin.y) * inverseDirection.dy;
+		float ty2 = (max.y - origin.y) * inverseDirection.dy;
+		tNear = std::max(tNear, std::min(ty1, ty2));
+		tFar = std::min(tFar, std::max(ty1, ty2));
+
+		float tz1 = (min.z - origin.z) * inverseDirection.dz;
+		float tz2 = (max.z - origin.z) * inverseDirection.dz;
+		tNear = std::max(tNear, std::min(tz1, tz2));
+		tFar = std::min(tFar, std::max(tz1, tz2));
+
+		entryTime = tNear;
+		return tFar >= std::max(tNear, 0.f) && tNear <= maxTime;
+	}
+};
+
+#endif // BOUNDING_BOX_H
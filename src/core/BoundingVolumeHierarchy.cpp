@@ -0,0 +1,724 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "BoundingVolumeHierarchy.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <type_traits>
+
+#include "Mesh.hpp"
+#include "RayStats.hpp"
+
+/* Primitive Helpers */
+
+// Description: Intersects 'ray' with the primitive at 'index' in 'primitives', for finding the closest hit.
+// Returns: true if it was hit, along with the time of intersection, for MeshInstances, which of its Triangles, and for
+// Triangles, the barycentric coordinates of the hit.
+template<typename Primitives>
+static bool
+intersect_closest(const Primitives& primitives, std::size_t index, const Ray& ray, float& intersectionTime,
+	uint32_t& primitiveIndex, [[maybe_unused]] float& beta, [[maybe_unused]] float& gamma)
+{
+	primitiveIndex = 0;
+	return primitives.IntersectWith(index, ray, intersectionTime);
+}
+
+static bool
+intersect_closest(const TriangleArray& triangles, std::size_t index, const Ray& ray, float& intersectionTime,
+	uint32_t& primitiveIndex, float& beta, float& gamma)
+{
+	primitiveIndex = 0;
+	return triangles.IntersectWith(index, ray, intersectionTime, beta, gamma);
+}
+
+static bool
+intersect_closest(const InstanceArray& instances, std::size_t index, const Ray& ray, float& intersectionTime,
+	uint32_t& primitiveIndex, float& beta, float& gamma)
+{
+	return instances.IntersectWith(index, ray, intersectionTime, primitiveIndex, beta, gamma);
+}
+
+// Description: Same as intersect_closest(), for the lanes of 'packet' enabled in 'laneMask'.
+template<typename Primitives>
+static void
+intersect_closest(const Primitives& primitives, std::size_t index, const RayPacket& packet, const int32_t* laneMask,
+	float* intersectionTimes, int32_t* laneHits, uint32_t* primitiveIndexes, float* betas, float* gammas)
+{
+	std::fill(primitiveIndexes, primitiveIndexes + kRayPacketSize, 0);
+	std::fill(betas, betas + kRayPacketSize, 0.f);
+	std::fill(gammas, gammas + kRayPacketSize, 0.f);
+	primitives.IntersectWith(index, packet, laneMask, intersectionTimes, laneHits);
+}
+
+static void
+intersect_closest(const TriangleArray& triangles, std::size_t index, const RayPacket& packet, const int32_t* laneMask,
+	float* intersectionTimes, int32_t* laneHits, uint32_t* primitiveIndexes, float* betas, float* gammas)
+{
+	std::fill(primitiveIndexes, primitiveIndexes + kRayPacketSize, 0);
+	triangles.IntersectWith(index, packet, laneMask, intersectionTimes, laneHits, betas, gammas);
+}
+
+static void
+intersect_closest(const InstanceArray& instances, std::size_t index, const RayPacket& packet, const int32_t* laneMask,
+	float* intersectionTimes, int32_t* laneHits, uint32_t* primitiveIndexes, float* betas, float* gammas)
+{
+	instances.IntersectWith(index, packet, laneMask, intersectionTimes, laneHits, primitiveIndexes, betas, gammas);
+}
+
+// Description: Finds how much light the primitive at 'index' in 'primitives' lets through along 'ray', if it's in the
+// way before 'maxTime'. Refer to BoundingVolumeHierarchy::Transmittance() for 'ignoredObject' and 'ignoredInstance'.
+template<typename Primitives>
+static float
+primitive_transmittance(const Primitives& primitives, std::size_t index, const Ray& ray, float maxTime,
+	const Object* ignoredObject, [[maybe_unused]] const Object* ignoredInstance)
+{
+	if (primitives.objects[index] == ignoredObject)
+		return 1.f;
+
+	float intersectionTime = 0.f;
+	if (!primitives.IntersectWith(index, ray, intersectionTime))
+		return 1.f;
+
+	// Only things between the start of the ray and 'maxTime' are in the way.
+	if (!std::isgreater(intersectionTime, 0.f) || !std::isless(intersectionTime, maxTime))
+		return 1.f;
+
+	return 1.f - primitives.opacity[index];
+}
+
+static float
+primitive_transmittance(const InstanceArray& instances, std::size_t index, const Ray& ray, float maxTime,
+	const Object* ignoredObject, const Object* ignoredInstance)
+{
+	return instances.Transmittance(index, ray, maxTime, instances.objects[index] == ignoredInstance ? ignoredObject : nullptr);
+}
+
+// Description: Same as primitive_transmittance(), for the lanes of 'packet' enabled in 'laneMask', with each lane's
+// transmittance stored into 'laneTransmittances'.
+template<typename Primitives>
+static void
+primitive_transmittance(const Primitives& primitives, std::size_t index, const RayPacket& packet, const int32_t* laneMask,
+	const Object* const* ignoredObjects, [[maybe_unused]] const Object* const* ignoredInstances,
+	float* laneTransmittances)
+{
+	const Object* object = primitives.objects[index];
+
+	alignas(64) int32_t objectMask[kRayPacketSize];
+	for (std::size_t lane = 0; lane < kRayPacketSize; lane++)
+		objectMask[lane] = laneMask[lane] & (ignoredObjects[lane] != object ? 1 : 0);
+
+	alignas(64) float times[kRayPacketSize];
+	alignas(64) int32_t hits[kRayPacketSize];
+	primitives.IntersectWith(index, packet, objectMask, times, hits);
+
+	for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+		// Only things between the start of the ray and 'maxTime' are in the way.
+		const bool inTheWay = hits[lane] != 0 && std::isgreater(times[lane], 0.f) && std::isless(times[lane], packet.maxTime[lane]);
+		laneTransmittances[lane] = inTheWay ? 1.f - primitives.opacity[index] : 1.f;
+	}
+}
+
+static void
+primitive_transmittance(const InstanceArray& instances, std::size_t index, const RayPacket& packet, const int32_t* laneMask,
+	const Object* const* ignoredObjects, const Object* const* ignoredInstances, float* laneTransmittances)
+{
+	for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+		laneTransmittances[lane] = 1.f;
+		if (laneMask[lane] != 0) {
+			laneTransmittances[lane] = primitive_transmittance(instances, index, packet.GetRay(lane), packet.maxTime[lane],
+				ignoredObjects[lane], ignoredInstances[lane]);
+		}
+	}
+}
+
+
+/* BoundingVolumeHierarchy */
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+	:
+	fNodes(),
+	fLeaves(),
+	fSpheres(),
+	fTriangles(),
+	fCylinders(),
+	fInstances()
+{
+}
+
+void
+BoundingVolumeHierarchy::Build(const std::vector<SharedObject>& objects)
+{
+	fNodes.clear();
+	fLeaves.clear();
+	fSpheres.Clear();
+	fTriangles.Clear();
+	fCylinders.Clear();
+	fInstances.Clear();
+
+	std::vector<BuildEntry> entries;
+	entries.reserve(objects.size());
+	for (std::size_t index = 0; index < objects.size(); index++) {
+		BoundingBox bounds = objects[index]->Bounds();
+
+		// Nothing can ever hit an Object without any volume...
+		if (bounds.Empty())
+			continue;
+
+		entries.push_back({bounds, bounds.Centroid(), static_cast<uint32_t>(index)});
+	}
+
+	if (entries.empty())
+		return;
+
+	// A binary tree with n leaves has 2n - 1 nodes.
+	fNodes.reserve(2 * entries.size());
+	BuildRecursive_(entries, 0, static_cast<uint32_t>(entries.size()), 0);
+
+	// Copy each leaf's Objects into the arrays for their type, so that every leaf refers to a contiguous range of
+	// each array.
+	for (Node& node : fNodes) {
+		if (node.count == 0)
+			continue;
+
+		Leaf leaf{};
+		leaf.sphereStart = static_cast<uint32_t>(fSpheres.Size());
+		leaf.triangleStart = static_cast<uint32_t>(fTriangles.Size());
+		leaf.cylinderStart = static_cast<uint32_t>(fCylinders.Size());
+		leaf.instanceStart = static_cast<uint32_t>(fInstances.Size());
+
+		for (uint32_t index = node.offset; index < node.offset + node.count; index++) {
+			const uint32_t objectIndex = entries[index].objectIndex;
+			const Object& object = *objects[objectIndex];
+			switch (object.Type()) {
+				case Object::OBJ_SPHERE:
+					fSpheres.Add(static_cast<const Sphere&>(object), objectIndex);
+					break;
+
+				case Object::OBJ_TRIANGLE:
+					fTriangles.Add(static_cast<const Triangle&>(object), objectIndex);
+					break;
+
+				case Object::OBJ_CYLINDER:
+					fCylinders.Add(static_cast<const Cylinder&>(object), objectIndex);
+					break;
+
+				case Object::OBJ_MESH_INSTANCE:
+					fInstances.Add(static_cast<const MeshInstance&>(object), objectIndex);
+					break;
+			}
+		}
+
+		leaf.sphereCount = static_cast<uint32_t>(fSpheres.Size()) - leaf.sphereStart;
+		leaf.triangleCount = static_cast<uint32_t>(fTriangles.Size()) - leaf.triangleStart;
+		leaf.cylinderCount = static_cast<uint32_t>(fCylinders.Size()) - leaf.cylinderStart;
+		leaf.instanceCount = static_cast<uint32_t>(fInstances.Size()) - leaf.instanceStart;
+
+		node.offset = static_cast<uint32_t>(fLeaves.size());
+		fLeaves.push_back(leaf);
+	}
+}
+
+// Description: Calls 'visitor' with the array and index of each of the Objects in 'leaf', a type at a time, so that
+// each call is to code for that one type. 'visitor' returns false to stop early.
+// Returns: false if 'visitor' stopped early.
+template<typename Visitor>
+bool
+BoundingVolumeHierarchy::VisitLeaf_(const Leaf& leaf, Visitor&& visitor) const
+{
+	for (uint32_t index = leaf.sphereStart; index < leaf.sphereStart + leaf.sphereCount; index++) {
+		if (!visitor(fSpheres, index))
+			return false;
+	}
+
+	for (uint32_t index = leaf.triangleStart; index < leaf.triangleStart + leaf.triangleCount; index++) {
+		if (!visitor(fTriangles, index))
+			return false;
+	}
+
+	for (uint32_t index = leaf.cylinderStart; index < leaf.cylinderStart + leaf.cylinderCount; index++) {
+		if (!visitor(fCylinders, index))
+			return false;
+	}
+
+	for (uint32_t index = leaf.instanceStart; index < leaf.instanceStart + leaf.instanceCount; index++) {
+		if (!visitor(fInstances, index))
+			return false;
+	}
+
+	return true;
+}
+
+// Description: Builds the subtree containing 'entries' from 'start' up to 'end', reordering them so that every leaf
+// refers to a contiguous range.
+// Returns: The index of the subtree's root node.
+uint32_t
+BoundingVolumeHierarchy::BuildRecursive_(std::vector<BuildEntry>& entries, uint32_t start, uint32_t end, uint32_t depth)
+{
+	const auto nodeIndex = static_cast<uint32_t>(fNodes.size());
+	fNodes.push_back({});
+
+	BoundingBox bounds;
+	BoundingBox centroidBounds;
+	for (uint32_t index = start; index < end; index++) {
+		bounds.Expand(entries[index].bounds);
+		centroidBounds.Expand(entries[index].centroid);
+	}
+
+	const uint32_t count = end - start;
+	const auto makeLeaf = [&]() -> uint32_t {
+		fNodes[nodeIndex] = {bounds, start, count};
+		return nodeIndex;
+	};
+
+	if (count <= 2 || depth >= kMaxDepth)
+		return makeLeaf();
+
+	const int axis = centroidBounds.LongestAxis();
+	const float axisMin = BoundingBox::AxisValue(centroidBounds.min, axis);
+	const float axisExtent = BoundingBox::AxisValue(centroidBounds.max, axis) - axisMin;
+
+	// Every centroid is in the same spot, so there's nothing to split along.
+	if (axisExtent <= 0.f)
+		return makeLeaf();
+
+	// Bin the centroids along the chosen axis.
+	struct Bin {
+		BoundingBox bounds;
+		uint32_t count = 0;
+	};
+	std::array<Bin, kBinCount> bins{};
+
+	const float binScale = static_cast<float>(kBinCount) / axisExtent;
+	const auto binIndexFor = [&](const BuildEntry& entry) -> uint32_t {
+		const float offset = BoundingBox::AxisValue(entry.centroid, axis) - axisMin;
+		return std::min(kBinCount - 1, static_cast<uint32_t>(offset * binScale));
+	};
+
+	for (uint32_t index = start; index < end; index++) {
+		Bin& bin = bins[binIndexFor(entries[index])];
+		bin.bounds.Expand(entries[index].bounds);
+		bin.count++;
+	}
+
+	// Sweep from both directions to get the area and count on either side of each of the bin boundaries.
+	std::array<float, kBinCount - 1> leftAreas{};
+	std::array<uint32_t, kBinCount - 1> leftCounts{};
+	BoundingBox runningBounds;
+	uint32_t runningCount = 0;
+	for (uint32_t split = 0; split < kBinCount - 1; split++) {
+		runningBounds.Expand(bins[split].bounds);
+		runningCount += bins[split].count;
+		leftAreas[split] = runningBounds.SurfaceArea();
+		leftCounts[split] = runningCount;
+	}
+
+	float bestCost = std::numeric_limits<float>::max();
+	uint32_t bestSplit = 0;
+	runningBounds = {};
+	runningCount = 0;
+	for (uint32_t split = kBinCount - 1; split > 0; split--) {
+		runningBounds.Expand(bins[split].bounds);
+		runningCount += bins[split].count;
+
+		const float cost = (leftAreas[split - 1] * static_cast<float>(leftCounts[split - 1]))
+			+ (runningBounds.SurfaceArea() * static_cast<float>(runningCount));
+		if (leftCounts[split - 1] != 0 && runningCount != 0 && cost < bestCost) {
+			bestCost = cost;
+			bestSplit = split - 1;
+		}
+	}
+
+	// SAH: Traversing costs about as much as one intersection test, and each child is only visited as often as
+	// its surface area relative to ours implies.
+	const float parentArea = bounds.SurfaceArea();
+	const float splitCost = 1.f + (parentArea > 0.f ? bestCost / parentArea : 0.f);
+	const auto leafCost = static_cast<float>(count);
+
+	uint32_t middle;
+	if (bestCost == std::numeric_limits<float>::max() || (splitCost >= leafCost && count <= kMaxLeafSize)) {
+		if (count <= kMaxLeafSize)
+			return makeLeaf();
+
+		// Too many Objects to leave in one leaf, so fall back to splitting them in half.
+		middle = start + (count / 2);
+		std::nth_element(entries.begin() + start, entries.begin() + middle, entries.begin() + end,
+			[axis](const BuildEntry& a, const BuildEntry& b) {
+				return BoundingBox::AxisValue(a.centroid, axis) < BoundingBox::AxisValue(b.centroid, axis);
+			});
+	} else {
+		const auto partitionPoint = std::partition(entries.begin() + start, entries.begin() + end,
+			[&](const BuildEntry& entry) { return binIndexFor(entry) <= bestSplit; });
+		middle = static_cast<uint32_t>(partitionPoint - entries.begin());
+	}
+
+	BuildRecursive_(entries, start, middle, depth + 1);
+	const uint32_t secondChild = BuildRecursive_(entries, middle, end, depth + 1);
+
+	fNodes[nodeIndex] = {bounds, secondChild, 0};
+	return nodeIndex;
+}
+
+bool
+BoundingVolumeHierarchy::IntersectClosest(const Ray& ray, HitRecord& hit) const
+{
+	if (!FindClosest(ray, hit))
+		return false;
+
+	hit.object->FillHitRecord(ray, hit);
+	return true;
+}
+
+bool
+BoundingVolumeHierarchy::FindClosest(const Ray& ray, HitRecord& hit) const
+{
+	if (fNodes.empty())
+		return false;
+
+	const Vector3D inverseDirection(1.f / ray.direction.dx, 1.f / ray.direction.dy, 1.f / ray.direction.dz);
+
+	float closestTime = std::numeric_limits<float>::max();
+	uint32_t closestObject = 0;
+	uint32_t closestPrimitive = 0;
+	float closestBeta = 0.f;
+	float closestGamma = 0.f;
+	const Object* closestObjectHit = nullptr;
+	bool hitSomething = false;
+
+	float entryTime = 0.f;
+	if (!fNodes[0].bounds.IntersectWith(ray.origin, inverseDirection, closestTime, entryTime))
+		return false;
+
+	std::array<uint32_t, kMaxDepth + 2> stack{};
+	uint32_t stackSize = 0;
+	uint32_t nodeIndex = 0;
+	while (true) {
+		const Node& node = fNodes[nodeIndex];
+		if (node.count != 0) {
+			const Leaf& leaf = fLeaves[node.offset];
+			const auto keepIfCloser = [&](const auto& primitives, uint32_t index, float currentTime, uint32_t currentPrimitive,
+				float currentBeta, float currentGamma) {
+				// Ties go to whichever Object came first in the scene, same as a plain linear search would pick.
+				const uint32_t currentIndex = primitives.objectIndexes[index];
+				const bool closer = std::isless(currentTime, closestTime)
+					|| (hitSomething && currentTime == closestTime && currentIndex < closestObject);
+				if (closer) {
+					closestTime = currentTime;
+					closestObject = currentIndex;
+					closestPrimitive = currentPrimitive;
+					closestBeta = currentBeta;
+					closestGamma = currentGamma;
+					closestObjectHit = primitives.objects[index];
+					hitSomething = true;
+				}
+			};
+
+			// The leaf's Spheres are tested a batch at a time, with one Sphere per vector lane.
+			const uint32_t sphereEnd = leaf.sphereStart + leaf.sphereCount;
+			for (uint32_t batchStart = leaf.sphereStart; batchStart < sphereEnd; batchStart += kSphereBatchSize) {
+				const uint32_t batchCount = std::min(kSphereBatchSize, sphereEnd - batchStart);
+
+				alignas(64) float times[kSphereBatchSize];
+				alignas(64) int32_t hits[kSphereBatchSize];
+				fSpheres.IntersectWith(batchStart, batchCount, ray, times, hits);
+
+				for (uint32_t sphere = 0; sphere < batchCount; sphere++) {
+					if (hits[sphere] != 0)
+						keepIfCloser(fSpheres, batchStart + sphere, times[sphere], 0, 0.f, 0.f);
+				}
+			}
+
+			VisitLeaf_(leaf, [&](const auto& primitives, uint32_t index) {
+				// The Spheres were already tested above.
+				if constexpr (std::is_same_v<std::decay_t<decltype(primitives)>, SphereArray>) {
+					return true;
+				} else {
+					float currentTime = 0.f;
+					uint32_t currentPrimitive = 0;
+					float currentBeta = 0.f;
+					float currentGamma = 0.f;
+					if (intersect_closest(primitives, index, ray, currentTime, currentPrimitive, currentBeta, currentGamma))
+						keepIfCloser(primitives, index, currentTime, currentPrimitive, currentBeta, currentGamma);
+
+					return true;
+				}
+			});
+		} else {
+			// Visit the nearer child first, so that hits found in it can cull the farther one.
+			uint32_t firstChild = nodeIndex + 1;
+			uint32_t secondChild = node.offset;
+
+			float firstTime = 0.f;
+			float secondTime = 0.f;
+			bool hitFirst = fNodes[firstChild].bounds.IntersectWith(ray.origin, inverseDirection, closestTime, firstTime);
+			bool hitSecond = fNodes[secondChild].bounds.IntersectWith(ray.origin, inverseDirection, closestTime, secondTime);
+
+			if (hitFirst && hitSecond) {
+				if (secondTime < firstTime)
+					std::swap(firstChild, secondChild);
+
+				stack[stackSize++] = secondChild;
+				nodeIndex = firstChild;
+				continue;
+			}
+
+			if (hitFirst) {
+				nodeIndex = firstChild;
+				continue;
+			}
+
+			if (hitSecond) {
+				nodeIndex = secondChild;
+				continue;
+			}
+		}
+
+		// Pop off nodes until we find one that could still contain something closer than what we've got.
+		bool foundNode = false;
+		while (stackSize > 0) {
+			nodeIndex = stack[--stackSize];
+			if (fNodes[nodeIndex].bounds.IntersectWith(ray.origin, inverseDirection, closestTime, entryTime)) {
+				foundNode = true;
+				break;
+			}
+		}
+
+		if (!foundNode)
+			break;
+	}
+
+	if (hitSomething) {
+		hit.time = closestTime;
+		hit.objectIndex = closestObject;
+		hit.primitiveIndex = closestPrimitive;
+		hit.beta = closestBeta;
+		hit.gamma = closestGamma;
+		hit.object = closestObjectHit;
+	}
+
+	return hitSomething;
+}
+
+
+float
+BoundingVolumeHierarchy::Transmittance(const Ray& ray, float maxTime, const Object* ignoredObject, const Object* ignoredInstance) const
+{
+	if (fNodes.empty())
+		return 1.f;
+
+	const Vector3D inverseDirection(1.f / ray.direction.dx, 1.f / ray.direction.dy, 1.f / ray.direction.dz);
+
+	float transmittance = 1.f;
+	float entryTime = 0.f;
+
+	std::array<uint32_t, kMaxDepth + 2> stack{};
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const Node& node = fNodes[stack[--stackSize]];
+		if (!node.bounds.IntersectWith(ray.origin, inverseDirection, maxTime, entryTime))
+			continue;
+
+		if (node.count == 0) {
+			stack[stackSize++] = node.offset;
+			stack[stackSize++] = static_cast<uint32_t>(&node - fNodes.data()) + 1;
+			continue;
+		}
+
+		const bool keepGoing = VisitLeaf_(fLeaves[node.offset], [&](const auto& primitives, uint32_t index) {
+			const float primitiveTransmittance = primitive_transmittance(primitives, index, ray, maxTime, ignoredObject, ignoredInstance);
+			if (primitiveTransmittance < 1.f)
+				transmittance *= primitiveTransmittance;
+
+			return transmittance > 0.f;
+		});
+
+		if (!keepGoing)
+			return 0.f;
+	}
+
+	return transmittance;
+}
+
+
+// Description: Slab test between 'box' and the lanes of 'packet' enabled in 'laneMask', same as BoundingBox::IntersectWith.
+// Returns: true if any lane passes through the box.
+bool
+BoundingVolumeHierarchy::IntersectPacketWithBox_(const BoundingBox& box, const RayPacket& packet, const int32_t* laneMask,
+	float* entryTimes, int32_t* laneHits)
+{
+	RAY_STATS_ADD(boxTests, RayStats::CountLanes(laneMask));
+
+	int32_t anyHit = 0;
+
+	#pragma omp simd reduction(|:anyHit)
+	for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+		float tx1 = (box.min.x - packet.originX[lane]) * packet.inverseDirectionX[lane];
+		float tx2 = (box.max.x - packet.originX[lane]) * packet.inverseDirectionX[lane];
+		float tNear = std::min(tx1, tx2);
+		float tFar = std::max(tx1, tx2);
+
+		float ty1 = (box.min.y - packet.originY[lane]) * packet.inverseDirectionY[lane];
+		float ty2 = (box.max.y - packet.originY[lane]) * packet.inverseDirectionY[lane];
+		tNear = std::max(tNear, std::min(ty1, ty2));
+		tFar = std::min(tFar, std::max(ty1, ty2));
+
+		float tz1 = (box.min.z - packet.originZ[lane]) * packet.inverseDirectionZ[lane];
+		float tz2 = (box.max.z - packet.originZ[lane]) * packet.inverseDirectionZ[lane];
+		tNear = std::max(tNear, std::min(tz1, tz2));
+		tFar = std::min(tFar, std::max(tz1, tz2));
+
+		entryTimes[lane] = tNear;
+		laneHits[lane] = laneMask[lane] & (tFar >= std::max(tNear, 0.f)) & (tNear <= packet.maxTime[lane]);
+		anyHit |= laneHits[lane];
+	}
+
+	return anyHit != 0;
+}
+
+void
+BoundingVolumeHierarchy::IntersectClosest(RayPacket& packet) const
+{
+	if (fNodes.empty())
+		return;
+
+	alignas(64) float times[kRayPacketSize];
+	alignas(64) int32_t hits[kRayPacketSize];
+
+	std::array<uint32_t, kMaxDepth + 2> stack{};
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const uint32_t nodeIndex = stack[--stackSize];
+		const Node& node = fNodes[nodeIndex];
+
+		// Lanes that already found something closer than this box don't need to look inside of it.
+		if (!IntersectPacketWithBox_(node.bounds, packet, packet.active, times, hits))
+			continue;
+
+		if (node.count == 0) {
+			// Visit the child the packet reaches first, first, by pushing it last. Lanes are re-tested against each
+			// child when it's popped, as they might have found something closer by then.
+			float firstTime = std::numeric_limits<float>::max();
+			float secondTime = std::numeric_limits<float>::max();
+			alignas(64) float childTimes[kRayPacketSize];
+			alignas(64) int32_t childHits[kRayPacketSize];
+
+			const bool hitFirst = IntersectPacketWithBox_(fNodes[nodeIndex + 1].bounds, packet, hits, childTimes, childHits);
+			for (std::size_t lane = 0; lane < kRayPacketSize; lane++)
+				firstTime = childHits[lane] != 0 ? std::min(firstTime, childTimes[lane]) : firstTime;
+
+			const bool hitSecond = IntersectPacketWithBox_(fNodes[node.offset].bounds, packet, hits, childTimes, childHits);
+			for (std::size_t lane = 0; lane < kRayPacketSize; lane++)
+				secondTime = childHits[lane] != 0 ? std::min(secondTime, childTimes[lane]) : secondTime;
+
+			if (secondTime < firstTime) {
+				if (hitFirst)
+					stack[stackSize++] = nodeIndex + 1;
+				if (hitSecond)
+					stack[stackSize++] = node.offset;
+			} else {
+				if (hitSecond)
+					stack[stackSize++] = node.offset;
+				if (hitFirst)
+					stack[stackSize++] = nodeIndex + 1;
+			}
+			continue;
+		}
+
+		alignas(64) int32_t laneMask[kRayPacketSize];
+		std::copy(std::begin(hits), std::end(hits), laneMask);
+
+		VisitLeaf_(fLeaves[node.offset], [&](const auto& primitives, uint32_t index) {
+			alignas(64) uint32_t primitiveIndexes[kRayPacketSize];
+			alignas(64) float betas[kRayPacketSize];
+			alignas(64) float gammas[kRayPacketSize];
+			intersect_closest(primitives, index, packet, laneMask, times, hits, primitiveIndexes, betas, gammas);
+
+			// Ties go to whichever Object came first in the scene, same as a plain linear search would pick.
+			const auto currentIndex = static_cast<int64_t>(primitives.objectIndexes[index]);
+			for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+				if (hits[lane] == 0)
+					continue;
+
+				const bool closer = std::isless(times[lane], packet.maxTime[lane])
+					|| (packet.objectIndex[lane] != kNoObjectHit && times[lane] == packet.maxTime[lane]
+						&& currentIndex < packet.objectIndex[lane]);
+				if (!closer)
+					continue;
+
+				packet.maxTime[lane] = times[lane];
+				packet.objectIndex[lane] = currentIndex;
+				packet.primitiveIndex[lane] = primitiveIndexes[lane];
+				packet.beta[lane] = betas[lane];
+				packet.gamma[lane] = gammas[lane];
+			}
+
+			return true;
+		});
+	}
+}
+
+void
+BoundingVolumeHierarchy::Transmittance(const RayPacket& packet, const Object* const* ignoredObjects, const Object* const* ignoredInstances,
+	float* laneTransmittances) const
+{
+	alignas(64) int32_t laneActive[kRayPacketSize];
+	for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+		laneTransmittances[lane] = 1.f;
+		laneActive[lane] = packet.active[lane];
+	}
+
+	if (fNodes.empty())
+		return;
+
+	alignas(64) float times[kRayPacketSize];
+	alignas(64) int32_t hits[kRayPacketSize];
+
+	// Same visiting order as the single ray version, so each lane multiplies its blockers together in the same order.
+	std::array<uint32_t, kMaxDepth + 2> stack{};
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const uint32_t nodeIndex = stack[--stackSize];
+		const Node& node = fNodes[nodeIndex];
+		if (!IntersectPacketWithBox_(node.bounds, packet, laneActive, times, hits))
+			continue;
+
+		if (node.count == 0) {
+			stack[stackSize++] = node.offset;
+			stack[stackSize++] = nodeIndex + 1;
+			continue;
+		}
+
+		alignas(64) int32_t laneMask[kRayPacketSize];
+		VisitLeaf_(fLeaves[node.offset], [&](const auto& primitives, uint32_t index) {
+			for (std::size_t lane = 0; lane < kRayPacketSize; lane++)
+				laneMask[lane] = hits[lane] & laneActive[lane];
+
+			alignas(64) float primitiveTransmittances[kRayPacketSize];
+			primitive_transmittance(primitives, index, packet, laneMask, ignoredObjects, ignoredInstances, primitiveTransmittances);
+
+			for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+				if (laneMask[lane] == 0 || primitiveTransmittances[lane] >= 1.f)
+					continue;
+
+				laneTransmittances[lane] *= primitiveTransmittances[lane];
+				if (laneTransmittances[lane] <= 0.f) {
+					laneTransmittances[lane] = 0.f;
+					laneActive[lane] = 0;
+				}
+			}
+
+			return true;
+		});
+
+		int32_t anyActive = 0;
+		for (std::size_t lane = 0; lane < kRayPacketSize; lane++)
+			anyActive |= laneActive[lane];
+
+		if (anyActive == 0)
+			break;
+	}
+}
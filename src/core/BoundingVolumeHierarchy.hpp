@@ -0,0 +1,130 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef BOUNDING_VOLUME_HIERARCHY_H
+#define BOUNDING_VOLUME_HIERARCHY_H
+
+#include <cstdint>
+#include <vector>
+
+#include "BoundingBox.hpp"
+#include "GeometryArrays.hpp"
+#include "Object.hpp"
+#include "Ray.hpp"
+#include "RayPacket.hpp"
+
+/** BoundingVolumeHierarchy */
+
+// A binary tree of bounding boxes over every Object in a scene, split using the surface area heuristic (SAH).
+// Rays only test the Objects in the leaves whose boxes they pass through, so finding the closest hit costs about
+// log(n) box tests rather than n Object tests. The Objects' geometry is copied out into one array per type of Object,
+// in leaf order, so the tests in a leaf run over contiguous memory without any virtual calls.
+// MeshInstances make this the top level of a two level hierarchy, with each Mesh having its own hierarchy over its
+// Triangles that rays are transformed into.
+class BoundingVolumeHierarchy {
+public:
+	BoundingVolumeHierarchy();
+
+	// Description: Throws away any previous hierarchy and builds a new one over 'objects'.
+	void Build(const std::vector<SharedObject>& objects);
+
+	// Description: Returns true if the hierarchy has nothing in it.
+	[[nodiscard]] bool Empty() const { return fNodes.empty(); }
+
+	[[nodiscard]] std::size_t NodeCount() const { return fNodes.size(); }
+	[[nodiscard]] std::size_t ObjectCount() const
+	{
+		return fSpheres.Size() + fTriangles.Size() + fCylinders.Size() + fInstances.Size();
+	}
+
+	// Description: Returns the box enclosing everything in the hierarchy.
+	[[nodiscard]] BoundingBox Bounds() const { return fNodes.empty() ? BoundingBox() : fNodes[0].bounds; }
+
+	// Description: Finds the closest Object that intersects with 'ray'.
+	// Returns: true if an Object was hit, with everything about the hit filled into 'hit', where 'objectIndex' is the
+	// index of the Object in the list the hierarchy was built from. Otherwise, false is returned.
+	bool IntersectClosest(const Ray& ray, HitRecord& hit) const;
+
+	// Description: Same as IntersectClosest(), except only the time, 'objectIndex', 'primitiveIndex', the barycentric
+	// coordinates, and the Object from the list are filled into 'hit'. The Object's FillHitRecord() fills in the rest,
+	// which only needs doing once the search is over.
+	bool FindClosest(const Ray& ray, HitRecord& hit) const;
+
+	// Description: Finds how much light makes it along 'ray' up until 'maxTime', with every Object in the way
+	// letting through as much as its opacity allows. Any Object will do, so the search stops as soon as nothing can
+	// make it through. 'ignoredObject' is never tested, which can be nullptr. When 'ignoredInstance' is set,
+	// 'ignoredObject' is one of the Triangles in its mesh, and is only ignored within that MeshInstance.
+	// Returns: 1.0 if nothing is in the way, down to 0.0 if everything is blocked.
+	[[nodiscard]] float Transmittance(const Ray& ray, float maxTime, const Object* ignoredObject = nullptr,
+		const Object* ignoredInstance = nullptr) const;
+
+	// Description: Returns true if nothing at all makes it along 'ray' before 'maxTime'.
+	[[nodiscard]] bool Occluded(const Ray& ray, float maxTime, const Object* ignoredObject = nullptr,
+		const Object* ignoredInstance = nullptr) const
+	{
+		return Transmittance(ray, maxTime, ignoredObject, ignoredInstance) <= 0.f;
+	}
+
+	// Description: Finds the closest Object that intersects with each active lane of 'packet', which share every box test.
+	// Each lane's 'maxTime', 'objectIndex', 'primitiveIndex', 'beta', and 'gamma' are updated with its closest hit, with
+	// 'objectIndex' left as kNoObjectHit for lanes that missed. The results are the same as calling FindClosest() for
+	// each lane.
+	void IntersectClosest(RayPacket& packet) const;
+
+	// Description: Finds the transmittance along each active lane of 'packet', up until the lane's 'maxTime', which is
+	// stored into 'laneTransmittances'. Lanes drop out once nothing makes it through. 'ignoredObjects' and
+	// 'ignoredInstances' hold what to skip for each lane. The results are the same as calling Transmittance() for each lane.
+	void Transmittance(const RayPacket& packet, const Object* const* ignoredObjects, const Object* const* ignoredInstances,
+		float* laneTransmittances) const;
+
+private:
+	// Interior nodes keep their first child directly after themselves, and their second child at 'offset'.
+	// Leaf nodes keep 'count' Objects, described by the Leaf at 'offset'.
+	struct Node {
+		BoundingBox bounds;
+		uint32_t offset;
+		uint32_t count;
+	};
+
+	// Where a leaf's Objects are in each of the arrays.
+	struct Leaf {
+		uint32_t sphereStart;
+		uint32_t sphereCount;
+		uint32_t triangleStart;
+		uint32_t triangleCount;
+		uint32_t cylinderStart;
+		uint32_t cylinderCount;
+		uint32_t instanceStart;
+		uint32_t instanceCount;
+	};
+
+	struct BuildEntry {
+		BoundingBox bounds;
+		Point3D centroid;
+		uint32_t objectIndex;
+	};
+
+	static constexpr uint32_t kBinCount = 16;
+	static constexpr uint32_t kMaxLeafSize = 8;
+	static constexpr uint32_t kMaxDepth = 64;
+
+	// How many of a leaf's Spheres are tested against a single ray at once, enough to fill an AVX-512 register.
+	static constexpr uint32_t kSphereBatchSize = 16;
+
+	uint32_t BuildRecursive_(std::vector<BuildEntry>& entries, uint32_t start, uint32_t end, uint32_t depth);
+
+	template<typename Visitor>
+	bool VisitLeaf_(const Leaf& leaf, Visitor&& visitor) const;
+	static bool IntersectPacketWithBox_(const BoundingBox& box, const RayPacket& packet, const int32_t* laneMask,
+		float* entryTimes, int32_t* laneHits);
+
+	std::vector<Node> fNodes;
+	std::vector<Leaf> fLeaves;
+
+	// Every Object's geometry in leaf order, split up by type.
+	SphereArray fSpheres;
+	TriangleArray fTriangles;
+	CylinderArray fCylinders;
+	InstanceArray fInstances;
+};
+
+#endif // BOUNDING_VOLUME_HIERARCHY_H
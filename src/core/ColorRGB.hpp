@@ -3,9 +3,11 @@
 #ifndef COLOR_RGB_H
 #define COLOR_RGB_H
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <string>
+#include <tuple>
 
 struct ColorRGB {
 	uint8_t red;
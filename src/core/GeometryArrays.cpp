@@ -0,0 +1,68 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "GeometryArrays.hpp"
+
+#include "Mesh.hpp"
+
+/* InstanceArray */
+
+void
+InstanceArray::Clear()
+{
+	instances.clear();
+	ClearObjects_();
+}
+
+void
+InstanceArray::Add(const MeshInstance& instance, uint32_t objectIndex)
+{
+	instances.push_back(&instance);
+	AddObject_(instance, objectIndex);
+}
+
+bool
+InstanceArray::IntersectWith(std::size_t index, const Ray& ray, float& intersectionTime) const
+{
+	uint32_t triangleIndex = 0;
+	float beta = 0.f;
+	float gamma = 0.f;
+	return IntersectWith(index, ray, intersectionTime, triangleIndex, beta, gamma);
+}
+
+bool
+InstanceArray::IntersectWith(std::size_t index, const Ray& ray, float& intersectionTime, uint32_t& triangleIndex,
+	float& beta, float& gamma) const
+{
+	RAY_STATS_ADD(instanceTests, 1);
+
+	HitRecord hit;
+	if (!instances[index]->FindClosest(ray, hit))
+		return false;
+
+	intersectionTime = hit.time;
+	triangleIndex = static_cast<uint32_t>(hit.primitiveIndex);
+	beta = hit.beta;
+	gamma = hit.gamma;
+	return true;
+}
+
+void
+InstanceArray::IntersectWith(std::size_t index, const RayPacket& packet, const int32_t* laneMask, float* intersectionTimes,
+	int32_t* laneHits, uint32_t* triangleIndexes, float* betas, float* gammas) const
+{
+	for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+		laneHits[lane] = 0;
+		if (laneMask[lane] != 0) {
+			laneHits[lane] = IntersectWith(index, packet.GetRay(lane), intersectionTimes[lane], triangleIndexes[lane],
+				betas[lane], gammas[lane]) ? 1 : 0;
+		}
+	}
+}
+
+float
+InstanceArray::Transmittance(std::size_t index, const Ray& ray, float maxTime, const Object* ignoredTriangle) const
+{
+	RAY_STATS_ADD(instanceTests, 1);
+	return instances[index]->Transmittance(ray, maxTime, ignoredTriangle);
+}
@@ -0,0 +1,327 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef GEOMETRY_ARRAYS_H
+#define GEOMETRY_ARRAYS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Object.hpp"
+#include "Ray.hpp"
+#include "RayPacket.hpp"
+#include "RayStats.hpp"
+
+class MeshInstance;
+
+/** PrimitiveArray */
+
+// What every kind of primitive array keeps besides its geometry: what shadow rays need to know about each primitive,
+// and which Object it came from.
+struct PrimitiveArray {
+	std::vector<float> opacity;
+
+	// The Object each primitive was copied from, only ever compared against and never dereferenced.
+	std::vector<const Object*> objects;
+
+	// The index of that Object in the list the primitives were gathered from.
+	std::vector<uint32_t> objectIndexes;
+
+public:
+	// Description: Returns how many primitives are in this array.
+	[[nodiscard]] std::size_t Size() const { return objects.size(); }
+
+protected:
+	void
+	AddObject_(const Object& object, uint32_t objectIndex)
+	{
+		opacity.push_back(object.material.opacity);
+		objects.push_back(&object);
+		objectIndexes.push_back(objectIndex);
+	}
+
+	void
+	ClearObjects_()
+	{
+		opacity.clear();
+		objects.clear();
+		objectIndexes.clear();
+	}
+};
+
+
+/** SphereArray */
+
+// Spheres kept as one array per property, so that testing a run of them only touches what the test needs, without
+// going through a shared_ptr and a virtual call for each one. Only the radius squared is ever needed for tests.
+struct SphereArray : public PrimitiveArray {
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> radiusSquared;
+
+public:
+	// Description: Removes every Sphere from this array.
+	void
+	Clear()
+	{
+		centerX.clear();
+		centerY.clear();
+		centerZ.clear();
+		radiusSquared.clear();
+		ClearObjects_();
+	}
+
+	// Description: Appends a copy of 'sphere', which is at 'objectIndex' in the scene's list of Objects.
+	void
+	Add(const Sphere& sphere, uint32_t objectIndex)
+	{
+		centerX.push_back(sphere.center.x);
+		centerY.push_back(sphere.center.y);
+		centerZ.push_back(sphere.center.z);
+		radiusSquared.push_back(sphere.radius * sphere.radius);
+		AddObject_(sphere, objectIndex);
+	}
+
+	// Description: Same as Sphere::IntersectWith(), for the Sphere at 'index'.
+	[[nodiscard]] bool
+	IntersectWith(std::size_t index, const Ray& ray, float& intersectionTime) const
+	{
+		return Sphere::IntersectWith(Point3D(centerX[index], centerY[index], centerZ[index]), radiusSquared[index], ray,
+			intersectionTime);
+	}
+
+	// Description: Intersects 'ray' with the 'count' Spheres from 'start' onwards all at once, one Sphere per vector
+	// lane, doing the same math as Sphere::IntersectWith(). Each Sphere's time of intersection is stored in
+	// 'intersectionTimes', with 'hits' set to 1 if it was hit and 0 otherwise.
+	void
+	IntersectWith(std::size_t start, std::size_t count, const Ray& ray, float* intersectionTimes, int32_t* hits) const
+	{
+		RAY_STATS_ADD(sphereTests, count);
+
+		const float* __restrict sphereX = centerX.data() + start;
+		const float* __restrict sphereY = centerY.data() + start;
+		const float* __restrict sphereZ = centerZ.data() + start;
+		const float* __restrict sphereRadiusSquared = radiusSquared.data() + start;
+
+		#pragma omp simd
+		for (std::size_t sphere = 0; sphere < count; sphere++) {
+			const float ocX = ray.origin.x - sphereX[sphere];
+			const float ocY = ray.origin.y - sphereY[sphere];
+			const float ocZ = ray.origin.z - sphereZ[sphere];
+
+			const float halfB = ray.direction.dx * ocX + ray.direction.dy * ocY + ray.direction.dz * ocZ;
+			const float c = ocX * ocX + ocY * ocY + ocZ * ocZ - sphereRadiusSquared[sphere];
+			const float discriminant = (halfB * halfB) - c;
+
+			// Spheres the ray misses get a NaN time from a negative discriminant, but they aren't hits anyway.
+			const float t = (halfB * -1.f) - sqrtf(discriminant);
+
+			intersectionTimes[sphere] = t;
+			hits[sphere] = (discriminant >= 0.f) & !std::signbit(t);
+		}
+	}
+
+	// Description: Same as Sphere::IntersectWith() for packets, for the Sphere at 'index'.
+	void
+	IntersectWith(std::size_t index, const RayPacket& packet, const int32_t* laneMask, float* intersectionTimes,
+		int32_t* laneHits) const
+	{
+		Sphere::IntersectWith(Point3D(centerX[index], centerY[index], centerZ[index]), radiusSquared[index], packet, laneMask,
+			intersectionTimes, laneHits);
+	}
+};
+
+
+/** TriangleArray */
+
+// Triangles kept as one array per component of what Triangle::Precompute() works out for intersection tests.
+struct TriangleArray : public PrimitiveArray {
+	std::vector<float> vertexAX;
+	std::vector<float> vertexAY;
+	std::vector<float> vertexAZ;
+
+	std::vector<float> edgeABX;
+	std::vector<float> edgeABY;
+	std::vector<float> edgeABZ;
+
+	std::vector<float> edgeACX;
+	std::vector<float> edgeACY;
+	std::vector<float> edgeACZ;
+
+public:
+	// Description: Removes every Triangle from this array.
+	void
+	Clear()
+	{
+		vertexAX.clear();
+		vertexAY.clear();
+		vertexAZ.clear();
+		edgeABX.clear();
+		edgeABY.clear();
+		edgeABZ.clear();
+		edgeACX.clear();
+		edgeACY.clear();
+		edgeACZ.clear();
+		ClearObjects_();
+	}
+
+	// Description: Appends a copy of the already precomputed 'triangle', which is at 'objectIndex' in the scene's list
+	// of Objects.
+	void
+	Add(const Triangle& triangle, uint32_t objectIndex)
+	{
+		const Triangle::IntersectionData& data = triangle.Intersection();
+		vertexAX.push_back(data.vertexA.x);
+		vertexAY.push_back(data.vertexA.y);
+		vertexAZ.push_back(data.vertexA.z);
+		edgeABX.push_back(data.edgeAB.dx);
+		edgeABY.push_back(data.edgeAB.dy);
+		edgeABZ.push_back(data.edgeAB.dz);
+		edgeACX.push_back(data.edgeAC.dx);
+		edgeACY.push_back(data.edgeAC.dy);
+		edgeACZ.push_back(data.edgeAC.dz);
+		AddObject_(triangle, objectIndex);
+	}
+
+	// Description: Returns the intersection data of the Triangle at 'index'.
+	[[nodiscard]] Triangle::IntersectionData
+	Get(std::size_t index) const
+	{
+		return {
+			Point3D(vertexAX[index], vertexAY[index], vertexAZ[index]),
+			Vector3D(edgeABX[index], edgeABY[index], edgeABZ[index]),
+			Vector3D(edgeACX[index], edgeACY[index], edgeACZ[index])
+		};
+	}
+
+	// Description: Same as Triangle::IntersectWith(), for the Triangle at 'index'.
+	[[nodiscard]] bool
+	IntersectWith(std::size_t index, const Ray& ray, float& intersectionTime) const
+	{
+		float beta = 0.f;
+		float gamma = 0.f;
+		return IntersectWith(index, ray, intersectionTime, beta, gamma);
+	}
+
+	[[nodiscard]] bool
+	IntersectWith(std::size_t index, const Ray& ray, float& intersectionTime, float& beta, float& gamma) const
+	{
+		return Triangle::IntersectWith(Get(index), ray, intersectionTime, beta, gamma);
+	}
+
+	// Description: Same as Triangle::IntersectWith() for packets, for the Triangle at 'index'.
+	void
+	IntersectWith(std::size_t index, const RayPacket& packet, const int32_t* laneMask, float* intersectionTimes,
+		int32_t* laneHits) const
+	{
+		alignas(64) float betas[kRayPacketSize];
+		alignas(64) float gammas[kRayPacketSize];
+		IntersectWith(index, packet, laneMask, intersectionTimes, laneHits, betas, gammas);
+	}
+
+	void
+	IntersectWith(std::size_t index, const RayPacket& packet, const int32_t* laneMask, float* intersectionTimes,
+		int32_t* laneHits, float* betas, float* gammas) const
+	{
+		Triangle::IntersectWith(Get(index), packet, laneMask, intersectionTimes, laneHits, betas, gammas);
+	}
+};
+
+
+/** CylinderArray */
+
+// Cylinders kept as one array per property.
+struct CylinderArray : public PrimitiveArray {
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> radius;
+	std::vector<float> directionX;
+	std::vector<float> directionY;
+	std::vector<float> directionZ;
+	std::vector<float> length;
+
+public:
+	// Description: Removes every Cylinder from this array.
+	void
+	Clear()
+	{
+		centerX.clear();
+		centerY.clear();
+		centerZ.clear();
+		radius.clear();
+		directionX.clear();
+		directionY.clear();
+		directionZ.clear();
+		length.clear();
+		ClearObjects_();
+	}
+
+	// Description: Appends a copy of 'cylinder', which is at 'objectIndex' in the scene's list of Objects.
+	void
+	Add(const Cylinder& cylinder, uint32_t objectIndex)
+	{
+		centerX.push_back(cylinder.center.x);
+		centerY.push_back(cylinder.center.y);
+		centerZ.push_back(cylinder.center.z);
+		radius.push_back(cylinder.radius);
+		directionX.push_back(cylinder.direction.dx);
+		directionY.push_back(cylinder.direction.dy);
+		directionZ.push_back(cylinder.direction.dz);
+		length.push_back(cylinder.length);
+		AddObject_(cylinder, objectIndex);
+	}
+
+	// Description: Same as Cylinder::IntersectWith(), for the Cylinder at 'index'.
+	[[nodiscard]] bool
+	IntersectWith(std::size_t index, const Ray& ray, float& intersectionTime) const
+	{
+		return Cylinder::IntersectWith(Point3D(centerX[index], centerY[index], centerZ[index]), radius[index],
+			Vector3D(directionX[index], directionY[index], directionZ[index]), length[index], ray, intersectionTime);
+	}
+
+	// Description: Tests each lane of 'packet' enabled in 'laneMask' against the Cylinder at 'index', one at a time.
+	void
+	IntersectWith(std::size_t index, const RayPacket& packet, const int32_t* laneMask, float* intersectionTimes,
+		int32_t* laneHits) const
+	{
+		for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+			laneHits[lane] = 0;
+			if (laneMask[lane] != 0)
+				laneHits[lane] = IntersectWith(index, packet.GetRay(lane), intersectionTimes[lane]) ? 1 : 0;
+		}
+	}
+};
+
+
+/** InstanceArray */
+
+// MeshInstances, which are tested by transforming a ray into their mesh's object space and searching the mesh's own
+// hierarchy. Each one stands in for however many Triangles its mesh has.
+struct InstanceArray : public PrimitiveArray {
+	std::vector<const MeshInstance*> instances;
+
+public:
+	// Description: Removes every MeshInstance from this array.
+	void Clear();
+
+	// Description: Appends 'instance', which is at 'objectIndex' in the scene's list of Objects.
+	void Add(const MeshInstance& instance, uint32_t objectIndex);
+
+	// Description: Same as MeshInstance::FindClosest(), for the MeshInstance at 'index', along with the index of the
+	// Triangle hit and its barycentric coordinates.
+	[[nodiscard]] bool IntersectWith(std::size_t index, const Ray& ray, float& intersectionTime) const;
+	[[nodiscard]] bool IntersectWith(std::size_t index, const Ray& ray, float& intersectionTime, uint32_t& triangleIndex,
+		float& beta, float& gamma) const;
+
+	// Description: Tests each lane of 'packet' enabled in 'laneMask' against the MeshInstance at 'index', one at a
+	// time, storing the index of the Triangle each lane hit and its barycentric coordinates into 'triangleIndexes',
+	// 'betas', and 'gammas'.
+	void IntersectWith(std::size_t index, const RayPacket& packet, const int32_t* laneMask, float* intersectionTimes,
+		int32_t* laneHits, uint32_t* triangleIndexes, float* betas, float* gammas) const;
+
+	// Description: Same as MeshInstance::Transmittance(), for the MeshInstance at 'index'.
+	[[nodiscard]] float Transmittance(std::size_t index, const Ray& ray, float maxTime, const Object* ignoredTriangle) const;
+};
+
+#endif // GEOMETRY_ARRAYS_H
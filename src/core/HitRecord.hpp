@@ -0,0 +1,47 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef HIT_RECORD_H
+#define HIT_RECORD_H
+
+#include <cstddef>
+#include <limits>
+
+#include "Point.hpp"
+#include "TypeDefinitions.hpp"
+#include "Vector3D.hpp"
+
+class Object;
+class MeshInstance;
+
+/** HitRecord */
+
+// Everything about where a ray hit an Object that shading needs, worked out once when the hit is found, so that shading
+// never has to go back to the Object to recalculate any of it.
+struct HitRecord {
+	// How far along the ray the hit is, and the point of intersection.
+	float time = std::numeric_limits<float>::max();
+	Point3D position;
+
+	// The unit normal of the surface itself, and the unit normal to shade with, which only differs from it for smooth
+	// shaded Triangles. Neither is flipped to face the ray.
+	Vector3D geometricNormal;
+	Vector3D shadingNormal;
+
+	// The barycentric coordinates of the hit on a Triangle, for vertex B and vertex C.
+	float beta = 0.f;
+	float gamma = 0.f;
+
+	// Where to sample the Object's texture, if it has one.
+	TextureCoordinate textureCoordinate{};
+
+	// The index of the Object hit in the list it was searched in, and for MeshInstances, the index of the Triangle hit
+	// in its mesh.
+	std::size_t objectIndex = 0;
+	std::size_t primitiveIndex = 0;
+
+	// The Object hit, which is the Triangle when it's hit through a MeshInstance, and that MeshInstance, or nullptr.
+	const Object* object = nullptr;
+	const MeshInstance* instance = nullptr;
+};
+
+#endif // HIT_RECORD_H
@@ -3,6 +3,8 @@
 #ifndef LIGHT_H
 #define LIGHT_H
 
+#include <limits>
+
 #include "TypeDefinitions.hpp"
 #include "Object.hpp"
 #include "Ray.hpp"
@@ -28,9 +30,9 @@ public:
 	[[nodiscard]] virtual std::optional<Vector3D> CalculateL(std::optional<Point3D> surfacePos) const = 0;
 	[[nodiscard]] virtual Ray GenerateShadowRay(const Point3D& startPoint, const Vector3D& surfaceNormal) const = 0;
 
-	// Description: Returns true if 'object' is between the origin of 'shadowRay' and this light,
-	// and false otherwise.
-	[[nodiscard]] virtual bool IntersectionBeforeLight(const Ray& shadowRay, const SharedObject& object) const = 0;
+	// Description: Returns how far along a shadow ray starting at 'point' this light is. Anything farther away than
+	// this can't block the light.
+	[[nodiscard]] virtual float DistanceToLight(const Point3D& point) const = 0;
 
 	virtual void Print(std::ostream& out) const = 0;
 
@@ -95,16 +97,11 @@ public:
 		return shadowRay;
 	}
 
-	[[nodiscard]] bool
-	IntersectionBeforeLight(const Ray& shadowRay, const SharedObject& object) const override
+	[[nodiscard]] float
+	DistanceToLight([[maybe_unused]] const Point3D& point) const override
 	{
-		// Get point at which the ray intersects the object.
-		float intersectionTime = 0.f;
-		std::optional<Point3D> maybeIntersection = object->IntersectWith(shadowRay, &intersectionTime);
-		if (!maybeIntersection.has_value())
-			return false;
-
-		return std::isgreater(intersectionTime, 0.0f);
+		// Directional lights are infinitely far away.
+		return std::numeric_limits<float>::infinity();
 	}
 
 	void
@@ -154,16 +151,10 @@ public:
 		return shadowRay;
 	}
 
-	[[nodiscard]] bool
-	IntersectionBeforeLight(const Ray& shadowRay, const SharedObject& object) const override
+	[[nodiscard]] float
+	DistanceToLight(const Point3D& point) const override
 	{
-		// Check whether the ray intersects the object and what time the intersection occurs at.
-		float intersectionTime = 0.f;
-		std::optional<Point3D> maybeIntersection = object->IntersectWith(shadowRay, &intersectionTime);
-		if (!maybeIntersection.has_value())
-			return false;
-
-		return std::isgreater(intersectionTime, 0.0f);
+		return Vector3D(point, position).Length();
 	}
 
 	void
@@ -0,0 +1,138 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "Mesh.hpp"
+
+#include <utility>
+
+/* Mesh */
+
+Mesh::Mesh(std::string name)
+	:
+	fName(std::move(name)),
+	fTriangles(),
+	fHierarchy()
+{
+}
+
+void
+Mesh::AddTriangle(const std::shared_ptr<Triangle>& triangle)
+{
+	fTriangles.push_back(triangle);
+}
+
+void
+Mesh::Build()
+{
+	fHierarchy.Build(fTriangles);
+}
+
+BoundingBox
+Mesh::Bounds() const
+{
+	if (!fHierarchy.Empty())
+		return fHierarchy.Bounds();
+
+	BoundingBox bounds;
+	for (const auto& triangle : fTriangles)
+		bounds.Expand(triangle->Bounds());
+
+	return bounds;
+}
+
+
+/* MeshInstance */
+
+MeshInstance::MeshInstance(SharedMesh mesh, const Transform& objectToWorld, const Transform& worldToObject)
+	:
+	Object(OBJ_MESH_INSTANCE),
+	mesh(std::move(mesh)),
+	objectToWorld(objectToWorld),
+	worldToObject(worldToObject)
+{
+}
+
+void
+MeshInstance::Print(std::ostream& out) const
+{
+	out << "Mesh Instance:\n";
+	out << "\tMesh: " << mesh->Name() << " (" << mesh->Triangles().size() << " triangles)\n";
+	out << "\tTransform:\n" << objectToWorld << '\n';
+}
+
+std::optional<Point3D>
+MeshInstance::IntersectWith(const Ray& ray, float* intersectionTime) const
+{
+	HitRecord hit;
+	if (!FindClosest(ray, hit))
+		return {};
+
+	if (intersectionTime != nullptr)
+		*intersectionTime = hit.time;
+
+	return ray.origin + (ray.direction * hit.time);
+}
+
+bool
+MeshInstance::IntersectWith(const Ray& ray, HitRecord& hit) const
+{
+	if (!FindClosest(ray, hit))
+		return false;
+
+	FillHitRecord(ray, hit);
+	return true;
+}
+
+bool
+MeshInstance::FindClosest(const Ray& ray, HitRecord& hit) const
+{
+	// The transformed direction isn't normalized, so times along it are the same as times along 'ray'.
+	if (!mesh->Hierarchy().FindClosest(worldToObject.TransformRay(ray), hit))
+		return false;
+
+	hit.primitiveIndex = hit.objectIndex;
+	return true;
+}
+
+void
+MeshInstance::FillHitRecord(const Ray& ray, HitRecord& hit) const
+{
+	// The Triangle fills in everything in object space, where it is, and then it's moved back out into the world.
+	TriangleAt(hit.primitiveIndex)->FillHitRecord(worldToObject.TransformRay(ray), hit);
+
+	hit.position = ray.origin + (ray.direction * hit.time);
+	hit.geometricNormal = NormalToWorld(hit.geometricNormal);
+	hit.shadingNormal = NormalToWorld(hit.shadingNormal);
+	hit.instance = this;
+}
+
+float
+MeshInstance::Transmittance(const Ray& ray, float maxTime, const Object* ignoredTriangle) const
+{
+	return mesh->Hierarchy().Transmittance(worldToObject.TransformRay(ray), maxTime, ignoredTriangle);
+}
+
+std::optional<Vector3D>
+MeshInstance::SurfaceNormal([[maybe_unused]] const std::optional<Point3D>& surfacePoint) const
+{
+	return {};
+}
+
+BoundingBox
+MeshInstance::Bounds() const
+{
+	return objectToWorld.TransformBox(mesh->Bounds());
+}
+
+ColorRGB
+MeshInstance::GetIntrinsicColor([[maybe_unused]] const HitRecord& hit) const
+{
+	return {};
+}
+
+Vector3D
+MeshInstance::NormalToWorld(const Vector3D& objectNormal) const
+{
+	// Normals go through the inverse transpose, so they stay perpendicular to scaled and sheared surfaces.
+	return worldToObject.TransposeTransformVector(objectNormal).Normalize();
+}
@@ -0,0 +1,110 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef MESH_H
+#define MESH_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BoundingBox.hpp"
+#include "BoundingVolumeHierarchy.hpp"
+#include "Object.hpp"
+#include "Ray.hpp"
+#include "Transform.hpp"
+
+/** Mesh */
+
+// A named group of Triangles, declared once in a scene and then placed any number of times by MeshInstances.
+// The Triangles, and the hierarchy over them, are in the mesh's own object space and shared by every instance.
+class Mesh {
+public:
+	explicit Mesh(std::string name);
+
+	// Description: Returns the name the scene refers to this mesh by.
+	[[nodiscard]] const std::string& Name() const { return fName; }
+
+	// Description: Adds 'triangle', which must already be precomputed. Meshes only hold Triangles.
+	void AddTriangle(const std::shared_ptr<Triangle>& triangle);
+
+	// Description: Returns every Triangle in this mesh.
+	[[nodiscard]] const std::vector<SharedObject>& Triangles() const { return fTriangles; }
+
+	// Description: Builds the hierarchy over this mesh's Triangles, which must be done before it's intersected.
+	void Build();
+
+	// Description: Returns the hierarchy over this mesh's Triangles.
+	[[nodiscard]] const BoundingVolumeHierarchy& Hierarchy() const { return fHierarchy; }
+
+	// Description: Returns the box enclosing every Triangle in this mesh.
+	[[nodiscard]] BoundingBox Bounds() const;
+
+private:
+	std::string fName;
+	std::vector<SharedObject> fTriangles;
+	BoundingVolumeHierarchy fHierarchy;
+};
+
+MAKE_SHARED_NAME(Mesh);
+
+
+/** MeshInstance */
+
+// One placement of a Mesh in the scene, moved into place by an affine transform. Rays are transformed into the mesh's
+// object space to be intersected with it, so every instance shares its mesh's Triangles and hierarchy.
+class MeshInstance : public Object {
+public:
+	SharedMesh mesh;
+
+public:
+	// Description: Constructs an instance of 'mesh', placed with 'objectToWorld', whose inverse is 'worldToObject'.
+	MeshInstance(SharedMesh mesh, const Transform& objectToWorld, const Transform& worldToObject);
+
+	// Description: Prints out information about this MeshInstance to the output stream 'out'.
+	void Print(std::ostream& out) const override;
+
+	// Description: Refer to the Object struct.
+	[[nodiscard]] std::optional<Point3D> IntersectWith(const Ray& ray, float* intersectionTime) const override;
+
+	// Description: Refer to the Object struct.
+	[[nodiscard]] bool IntersectWith(const Ray& ray, HitRecord& hit) const override;
+
+	// Description: Finds the closest of the mesh's Triangles that intersects with 'ray'.
+	// Returns: true if one was hit, with only the time of intersection, the index of the Triangle in the mesh
+	// ('primitiveIndex'), and its barycentric coordinates filled into 'hit'. FillHitRecord() fills in the rest.
+	bool FindClosest(const Ray& ray, HitRecord& hit) const;
+
+	// Description: Fills in 'hit' from the Triangle at 'hit.primitiveIndex', with everything transformed back into
+	// world space.
+	void FillHitRecord(const Ray& ray, HitRecord& hit) const override;
+
+	// Description: Same as BoundingVolumeHierarchy::Transmittance() for this instance's mesh, with 'ray' given in
+	// world space. 'ignoredTriangle' is one of the mesh's Triangles, or nullptr.
+	[[nodiscard]] float Transmittance(const Ray& ray, float maxTime, const Object* ignoredTriangle) const;
+
+	// Description: A MeshInstance is made up of its mesh's Triangles, so there's no normal without knowing which one
+	// was hit. Use the HitRecord from IntersectWith() instead.
+	[[nodiscard]] std::optional<Vector3D> SurfaceNormal(const std::optional<Point3D>& surfacePoint) const override;
+
+	// Description: Refer to the Object struct.
+	[[nodiscard]] BoundingBox Bounds() const override;
+
+	// Description: Same as SurfaceNormal(), there's no color without knowing which Triangle was hit. The HitRecord
+	// from IntersectWith() has the Triangle as its Object.
+	[[nodiscard]] ColorRGB GetIntrinsicColor(const HitRecord& hit) const override;
+
+	// Description: Returns the Triangle at 'triangleIndex' in the mesh.
+	[[nodiscard]] const SharedObject& TriangleAt(std::size_t triangleIndex) const { return mesh->Triangles()[triangleIndex]; }
+
+	// Description: Transforms 'objectNormal', a surface normal in the mesh's object space, into world space.
+	// Returns: The normal as a unit vector.
+	[[nodiscard]] Vector3D NormalToWorld(const Vector3D& objectNormal) const;
+
+private:
+	Transform objectToWorld;
+	Transform worldToObject;
+};
+
+MAKE_SHARED_NAME(MeshInstance);
+
+#endif // MESH_H
@@ -3,18 +3,43 @@
 
 #include "Object.hpp"
 
-#include "../TextureCache.hpp"
+std::atomic<uint32_t> Object::sNextID = 0;
 
-uint32_t Object::sNextID = 0;
+// Description: Looks up the color at 'textureCoordinate' in 'objectTexture'.
+// Returns: The color, or black if the texture wasn't loaded.
+static ColorRGB
+sample_texture(const SharedTexture& objectTexture, const TextureCoordinate& textureCoordinate)
+{
+	if (!objectTexture)
+		return {};
+
+	ColorRGB pixelOut;
+	if (!objectTexture->GetPixelWithTextureCoordinate(textureCoordinate.u, textureCoordinate.v, pixelOut))
+		return {};
+
+	return pixelOut;
+}
 
 // Description: Refer to the Object struct.
-[[nodiscard]] ColorRGB
-Sphere::GetIntrinsicColorAtSurfacePoint(const Point3D& surfacePoint) const
+void
+Sphere::FillHitRecord(const Ray& ray, HitRecord& hit) const
 {
+	hit.position = ray.origin + (ray.direction * hit.time);
+
+	// Dividing by the radius only gets close to a unit vector, as the point of intersection is rounded.
+	Vector3D N(center, hit.position);
+	N /= radius;
+	N.NormalizeSelf();
+
+	hit.geometricNormal = N;
+	hit.shadingNormal = N;
+	hit.object = this;
+	hit.instance = nullptr;
+
+	// Only textured spheres need their spherical coordinates.
 	if (texturePath.empty())
-		return material.intrinsicColor;
+		return;
 
-	Vector3D N = *SurfaceNormal(surfacePoint);
 	float phi = std::acos(N.dz);
 	float theta = std::atan2(N.dy, N.dx);
 
@@ -24,42 +49,52 @@ Sphere::GetIntrinsicColorAtSurfacePoint(const Point3D& surfacePoint) const
 	else
 		u = (theta + (2.f * std::numbers::pi_v<float>)) * 0.5f * std::numbers::inv_pi_v<float>;
 
-	float v = phi * std::numbers::inv_pi_v<float>;
+	hit.textureCoordinate.u = u;
+	hit.textureCoordinate.v = phi * std::numbers::inv_pi_v<float>;
+}
 
-	SharedTexture objectTexture;
-	if (!TextureCache::Instance().GetTexture(texturePath, objectTexture))
-		return {};
+// Description: Refer to the Object struct.
+[[nodiscard]] ColorRGB
+Sphere::GetIntrinsicColor(const HitRecord& hit) const
+{
+	if (texturePath.empty())
+		return material.intrinsicColor;
 
-	ColorRGB pixelOut;
-	if (!objectTexture->GetPixelWithTextureCoordinate(u, v, pixelOut))
-		return {};
+	return sample_texture(texture, hit.textureCoordinate);
+}
 
-	return pixelOut;
+// Description: Refer to the Object struct.
+void
+Triangle::FillHitRecord(const Ray& ray, HitRecord& hit) const
+{
+	hit.position = ray.origin + (ray.direction * hit.time);
+
+	const float alpha = 1.f - hit.beta - hit.gamma;
+
+	hit.geometricNormal = FlatShadeSurfaceNormal();
+	if (SmoothShaded()) {
+		hit.shadingNormal = (*vertexNormalA * alpha) + (*vertexNormalB * hit.beta) + (*vertexNormalC * hit.gamma);
+		hit.shadingNormal.NormalizeSelf();
+	} else {
+		hit.shadingNormal = hit.geometricNormal;
+	}
+
+	hit.object = this;
+	hit.instance = nullptr;
+
+	if (texturePath.empty() || !Textured())
+		return;
+
+	hit.textureCoordinate.u = (alpha * textureCoordinateA->u) + (hit.beta * textureCoordinateB->u) + (hit.gamma * textureCoordinateC->u);
+	hit.textureCoordinate.v = (alpha * textureCoordinateA->v) + (hit.beta * textureCoordinateB->v) + (hit.gamma * textureCoordinateC->v);
 }
 
 // Description: Refer to the Object struct.`
 [[nodiscard]] ColorRGB
-Triangle::GetIntrinsicColorAtSurfacePoint(const Point3D& surfacePoint) const
+Triangle::GetIntrinsicColor(const HitRecord& hit) const
 {
 	if (texturePath.empty() || !Textured())
 		return material.intrinsicColor;
 
-	float alpha = 0.f;
-	float beta = 0.f;
-	float gamma = 0.f;
-	if (!CalculateBarycentricCoordinates(surfacePoint, alpha, beta, gamma))
-		return {};
-
-	float u = (alpha * textureCoordinateA->u) + (beta * textureCoordinateB->u) + (gamma * textureCoordinateC->u);
-	float v = (alpha * textureCoordinateA->v) + (beta * textureCoordinateB->v) + (gamma * textureCoordinateC->v);
-
-	SharedTexture objectTexture;
-	if (!TextureCache::Instance().GetTexture(texturePath, objectTexture))
-		return {};
-
-	ColorRGB pixelOut;
-	if (!objectTexture->GetPixelWithTextureCoordinate(u, v, pixelOut))
-		return {};
-
-	return pixelOut;
-}
\ No newline at end of file
+	return sample_texture(texture, hit.textureCoordinate);
+}
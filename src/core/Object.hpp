@@ -3,10 +3,16 @@
 #ifndef OBJECT_H
 #define OBJECT_H
 
+#include <atomic>
 #include <filesystem>
 #include <memory>
 
+#include "BoundingBox.hpp"
+#include "HitRecord.hpp"
 #include "Ray.hpp"
+#include "RayPacket.hpp"
+#include "RayStats.hpp"
+#include "Texture.hpp"
 #include "TypeDefinitions.hpp"
 #include "Vector3D.hpp"
 
@@ -16,10 +22,14 @@ public:
 	MaterialProps material;
     std::filesystem::path texturePath;
 
+    // The texture at 'texturePath', once it's been loaded, so shading doesn't have to look it up.
+    SharedTexture texture;
+
 	enum ObjectType {
 		OBJ_SPHERE = 0,
 		OBJ_CYLINDER,
-        OBJ_TRIANGLE
+        OBJ_TRIANGLE,
+        OBJ_MESH_INSTANCE
 	};
 
 public:
@@ -41,12 +51,23 @@ public:
     // Otherwise, nothing is returned.
 	[[nodiscard]] virtual std::optional<Point3D> IntersectWith(const Ray& ray, float* intersectionTime) const = 0;
 
+	// Description: Finds the intersection between 'ray' and this Object, if there is one.
+	// Returns: true if there's an intersection, with everything about it filled into 'hit'.
+	[[nodiscard]] virtual bool IntersectWith(const Ray& ray, HitRecord& hit) const = 0;
+
+	// Description: Fills in the rest of 'hit', where 'ray' hit this Object, once its time (and for Triangles, its
+	// barycentric coordinates) has been found.
+	virtual void FillHitRecord(const Ray& ray, HitRecord& hit) const = 0;
+
 	// Description: Calculates the vector N that originates at 'surfacePoint' and is perpendicular to this Object's surface.
 	[[nodiscard]] virtual std::optional<Vector3D> SurfaceNormal(const std::optional<Point3D>& surfacePoint) const = 0;
 
-    // Description: Retrieves the intrinsic color at the point 'surfacePoint' on the object's surface/
-	// This can
-    [[nodiscard]] virtual ColorRGB GetIntrinsicColorAtSurfacePoint(const Point3D& surfacePoint) const = 0;
+	// Description: Calculates the smallest axis aligned box that fully encloses this Object.
+	[[nodiscard]] virtual BoundingBox Bounds() const = 0;
+
+    // Description: Retrieves the intrinsic color at 'hit' on this Object's surface, which comes from its texture if
+    // it has one.
+    [[nodiscard]] virtual ColorRGB GetIntrinsicColor(const HitRecord& hit) const = 0;
 
     // Description: Checks if the ID of this Object is equivalent to the ID of Object 'other'.
 	bool operator==(const Object& other) const
@@ -70,7 +91,7 @@ protected:
 	}
 
 private:
-    static uint32_t sNextID;
+    static std::atomic<uint32_t> sNextID;
 };
 
 MAKE_SHARED_NAME(Object);
@@ -116,38 +137,89 @@ public:
 	[[nodiscard]] std::optional<Point3D>
 	IntersectWith(const Ray& ray, float* intersectionTime) const override
 	{
-		float b = 2.f * (ray.direction.dx * (ray.origin.x - center.x) + ray.direction.dy * (ray.origin.y - this->center.y) + ray.direction.dz * (ray.origin.z - this->center.z));
-		float c = powf(ray.origin.x - this->center.x, 2.f) + powf(ray.origin.y - this->center.y, 2.f) + powf(ray.origin.z - this->center.z, 2.f) - powf(this->radius, 2.f);
+		float t = 0.f;
+		if (!IntersectWith(center, radius * radius, ray, t))
+			return {};
+
+		if (intersectionTime != nullptr)
+			*intersectionTime = t;
+
+		return ray.origin + (ray.direction * t);
+	}
 
-		float discriminant = (b * b) - (4.f * c);
+    // Description: Refer to the Object struct.
+	[[nodiscard]] bool
+	IntersectWith(const Ray& ray, HitRecord& hit) const override
+	{
+		if (!IntersectWith(center, radius * radius, ray, hit.time))
+			return false;
+
+		FillHitRecord(ray, hit);
+		return true;
+	}
+
+    // Description: Refer to the Object struct.
+	void FillHitRecord(const Ray& ray, HitRecord& hit) const override;
+
+    // Description: Intersection test between 'ray', whose direction must be a unit vector, and the sphere at
+    // 'sphereCenter' whose radius squared is 'sphereRadiusSquared'. This doesn't need a Sphere to exist, so that Spheres
+    // can be tested straight out of a SphereArray.
+    // Returns: true if the nearer of the two points where 'ray' crosses the sphere is in front of its origin, along with
+    // the time of intersection. A ray starting inside of the sphere doesn't hit it.
+	[[nodiscard]] static bool
+	IntersectWith(const Point3D& sphereCenter, float sphereRadiusSquared, const Ray& ray, float& intersectionTime)
+	{
+		RAY_STATS_ADD(sphereTests, 1);
+
+		const float ocX = ray.origin.x - sphereCenter.x;
+		const float ocY = ray.origin.y - sphereCenter.y;
+		const float ocZ = ray.origin.z - sphereCenter.z;
+
+		// With a unit direction and b = 2 * halfB, the quadratic formula's 2s and 4s cancel out.
+		const float halfB = ray.direction.dx * ocX + ray.direction.dy * ocY + ray.direction.dz * ocZ;
+		const float c = ocX * ocX + ocY * ocY + ocZ * ocZ - sphereRadiusSquared;
+
+		const float discriminant = (halfB * halfB) - c;
 
 		// Check if discriminant is negative; This implies no intersection!
 		if (std::signbit(discriminant) && std::fpclassify(discriminant) != FP_ZERO) {
-			return {};
+			return false;
 		}
 
-		const float sqrtDiscrim = sqrtf(discriminant);
-		const float negB = b * -1.f;
-		float t1 = ((negB) + sqrtDiscrim) / 2.f;
-		float t2 = ((negB) - sqrtDiscrim) / 2.f;
-
-		// Check for smallest positive t, which indicates the intersection we care about!
-		Vector3D tempVector = ray.direction;
-		if (!std::signbit(t1) && std::isless(t1, t2)) {
-			// t1 is the viewable point!
-			tempVector *= t1;
-			if (intersectionTime != nullptr)
-				*intersectionTime = t1;
-		} else if (!std::signbit(t2)) {
-			// t2 is the viewable point!
-			tempVector *= t2;
-			if (intersectionTime != nullptr)
-				*intersectionTime = t2;
-		} else {
-            return {};
-        }
+		// The nearer root is the viewable point, as long as it's not behind the ray.
+		const float t = (halfB * -1.f) - sqrtf(discriminant);
+		if (std::signbit(t))
+			return false;
+
+		intersectionTime = t;
+		return true;
+	}
+
+    // Description: Intersects every lane of 'packet' enabled in 'laneMask' with the sphere at 'sphereCenter' whose
+    // radius squared is 'sphereRadiusSquared' at once, doing the same math as the single ray version. Each lane's time
+    // of intersection is stored in 'intersectionTimes', with 'laneHits' set to 1 if it hit and 0 otherwise.
+	static void
+	IntersectWith(const Point3D& sphereCenter, float sphereRadiusSquared, const RayPacket& packet, const int32_t* laneMask,
+		float* intersectionTimes, int32_t* laneHits)
+	{
+		RAY_STATS_ADD(sphereTests, RayStats::CountLanes(laneMask));
+
+		#pragma omp simd
+		for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+			const float ocX = packet.originX[lane] - sphereCenter.x;
+			const float ocY = packet.originY[lane] - sphereCenter.y;
+			const float ocZ = packet.originZ[lane] - sphereCenter.z;
+
+			const float halfB = packet.directionX[lane] * ocX + packet.directionY[lane] * ocY + packet.directionZ[lane] * ocZ;
+			const float c = ocX * ocX + ocY * ocY + ocZ * ocZ - sphereRadiusSquared;
+			const float discriminant = (halfB * halfB) - c;
 
-		return ray.origin + tempVector;
+			// Lanes with a negative discriminant get a NaN time, but they're masked out of the hits anyway.
+			const float t = (halfB * -1.f) - sqrtf(discriminant);
+
+			intersectionTimes[lane] = t;
+			laneHits[lane] = laneMask[lane] & (discriminant >= 0.f) & !std::signbit(t);
+		}
 	}
 
     // Description: Refer to the Object struct.
@@ -164,7 +236,15 @@ public:
 	}
 
     // Description: Refer to the Object struct.
-    [[nodiscard]] ColorRGB GetIntrinsicColorAtSurfacePoint(const Point3D& surfacePoint) const override;
+	[[nodiscard]] BoundingBox
+	Bounds() const override
+	{
+		const float extent = std::fabs(radius);
+		return {center + (-extent), center + extent};
+	}
+
+    // Description: Refer to the Object struct.
+    [[nodiscard]] ColorRGB GetIntrinsicColor(const HitRecord& hit) const override;
 
     // Description: Checks if the Sphere 'other' is equivalent to this Sphere.
 	bool operator==(const Sphere& other) const = default;
@@ -206,9 +286,50 @@ public:
     // Description: Refer to the Object struct.
 	[[nodiscard]] std::optional<Point3D>
 	IntersectWith(const Ray& ray, float* intersectionTime) const override
+	{
+		float t = 0.f;
+		if (!IntersectWith(center, radius, direction, length, ray, t))
+			return {};
+
+		if (intersectionTime != nullptr)
+			*intersectionTime = t;
+
+		return ray.origin + (ray.direction * t);
+	}
+
+    // Description: Refer to the Object struct.
+	[[nodiscard]] bool
+	IntersectWith(const Ray& ray, HitRecord& hit) const override
+	{
+		if (!IntersectWith(center, radius, direction, length, ray, hit.time))
+			return false;
+
+		FillHitRecord(ray, hit);
+		return true;
+	}
+
+    // Description: Refer to the Object struct.
+	void
+	FillHitRecord(const Ray& ray, HitRecord& hit) const override
 	{
 		// Unimplemented
-		return {};
+		hit.position = ray.origin + (ray.direction * hit.time);
+		hit.object = this;
+		hit.instance = nullptr;
+	}
+
+    // Description: Intersection test between 'ray' and the cylinder described by 'cylinderCenter', 'cylinderRadius',
+    // 'cylinderDirection', and 'cylinderLength', which doesn't need a Cylinder to exist.
+    // Returns: true if 'ray' hits the cylinder in front of its origin, along with the time of intersection.
+	[[nodiscard]] static bool
+	IntersectWith([[maybe_unused]] const Point3D& cylinderCenter, [[maybe_unused]] float cylinderRadius,
+		[[maybe_unused]] const Vector3D& cylinderDirection, [[maybe_unused]] float cylinderLength,
+		[[maybe_unused]] const Ray& ray, [[maybe_unused]] float& intersectionTime)
+	{
+		RAY_STATS_ADD(cylinderTests, 1);
+
+		// Unimplemented
+		return false;
 	}
 
     // Description: Refer to the Object struct.
@@ -219,9 +340,18 @@ public:
 		return {};
 	}
 
+    // Description: Refer to the Object struct.
+	[[nodiscard]] BoundingBox
+	Bounds() const override
+	{
+		// Conservative, since the cylinder could be pointing in any direction away from its center.
+		const float extent = std::fabs(radius) + (std::fabs(length) * direction.Length());
+		return {center + (-extent), center + extent};
+	}
+
     // Description: Refer to the Object struct.
     [[nodiscard]] ColorRGB
-    GetIntrinsicColorAtSurfacePoint(const Point3D& surfacePoint) const override
+    GetIntrinsicColor([[maybe_unused]] const HitRecord& hit) const override
     {
         // Unimplemented
         return {};
@@ -289,51 +419,165 @@ public:
 		}
     }
 
+    // Everything a ray/triangle test needs, kept together so a test only touches this.
+    struct IntersectionData {
+        Point3D vertexA;
+        Vector3D edgeAB;
+        Vector3D edgeAC;
+
+        bool operator==(const IntersectionData& other) const = default;
+    };
+
+    // Description: Precomputes everything about this Triangle that intersection tests and shading need, which must
+    // be done once all of its vertices are set.
+    // Returns: false if the triangle is degenerate (its vertices are on a single line), as nothing can hit it.
+    bool
+    Precompute()
+    {
+        IntersectionData intersection{};
+        intersection.vertexA = vertexA;
+        intersection.edgeAB = Vector3D(vertexA, vertexB);
+        intersection.edgeAC = Vector3D(vertexA, vertexC);
+
+        ShadingData shading{};
+        shading.d11 = intersection.edgeAB.DotProduct(intersection.edgeAB);
+        shading.d12 = intersection.edgeAB.DotProduct(intersection.edgeAC);
+        shading.d22 = intersection.edgeAC.DotProduct(intersection.edgeAC);
+
+        // The determinant is the squared area of the parallelogram spanned by the edges.
+        const float determinant = (shading.d11 * shading.d22) - (shading.d12 * shading.d12);
+
+        // Check if determinant is zero, given some leeway!
+        const float kEpsilon = 0.001f;
+        if (std::fabs(determinant) < kEpsilon)
+            return false;
+
+        shading.inverseDeterminant = 1.f / determinant;
+        shading.flatNormal = intersection.edgeAB.CrossProduct(intersection.edgeAC).Normalize();
+
+        intersectionData = intersection;
+        shadingData = shading;
+        return true;
+    }
+
     // Description: Refer to the Object struct.
     [[nodiscard]] std::optional<Point3D>
     IntersectWith(const Ray& ray, float* intersectionTime) const override
     {
-        auto e1 = Vector3D(vertexA, vertexB);
-        auto e2 = Vector3D(vertexA, vertexC);
-        auto n = e1.CrossProduct(e2);
-
-        // Solve for D in Plane Equation: Ax + By + Cz + D = 0
-        // A = nx, B = ny, C = nz, x = p0x, y = p0y, z = p0z
-        float d = (n.dx * vertexA.x) + (n.dy * vertexA.y) + (n.dz * vertexA.z);
-        d *= -1.f;
-
-        // Solve for t (intersection)
-        // Plane equation: Ax + By + Cz + D = 0
-        // x = x0 + t×xd
-        // y = y0 + t×yd
-        // z = z0 + t×zd
-        // t = –(A×x0 + B×y0 + C×z0 + D)/(A×xd + B×yd + C×zd)
-        float tDenominator = (n.dx * ray.direction.dx) + (n.dy * ray.direction.dy) + (n.dz * ray.direction.dz);
-        if (std::fpclassify(tDenominator) == FP_ZERO) {
-            // The ray is parallel to the plane!
+        float t = 0.f;
+        float beta = 0.f;
+        float gamma = 0.f;
+        if (!IntersectWith(ray, t, beta, gamma))
             return {};
-        }
 
-        float tNumerator = (n.dx * ray.origin.x) + (n.dy * ray.origin.y) + (n.dz * ray.origin.z) + d;
-        float t = tNumerator / tDenominator;
-        t *= -1.f;
-        if (std::islessequal(t, 0.0f)) {
-            // Intersection behind ray origin!
-            return {};
+        if (intersectionTime != nullptr)
+            *intersectionTime = t;
+
+        return ray.origin + (ray.direction * t);
+    }
+
+    // Description: Möller–Trumbore intersection test between 'ray' and this Triangle, using the data from Precompute().
+    // Returns: true if 'ray' hits this Triangle in front of its origin, along with the time of intersection and the
+    // barycentric coordinates (beta for vertex B, gamma for vertex C) of the point of intersection.
+    [[nodiscard]] bool
+    IntersectWith(const Ray& ray, float& intersectionTime, float& beta, float& gamma) const
+    {
+        return IntersectWith(intersectionData, ray, intersectionTime, beta, gamma);
+    }
+
+    // Description: Refer to the Object struct.
+    [[nodiscard]] bool
+    IntersectWith(const Ray& ray, HitRecord& hit) const override
+    {
+        if (!IntersectWith(ray, hit.time, hit.beta, hit.gamma))
+            return false;
+
+        FillHitRecord(ray, hit);
+        return true;
+    }
+
+    // Description: Refer to the Object struct.
+    void FillHitRecord(const Ray& ray, HitRecord& hit) const override;
+
+    // Description: Returns what Precompute() worked out for intersection tests.
+    [[nodiscard]] const IntersectionData& Intersection() const { return intersectionData; }
+
+    // Description: Same as the IntersectWith() above, but for the triangle described by 'data', which doesn't need a
+    // Triangle to exist, so that Triangles can be tested straight out of a TriangleArray.
+    [[nodiscard]] static bool
+    IntersectWith(const IntersectionData& data, const Ray& ray, float& intersectionTime, float& beta, float& gamma)
+    {
+        RAY_STATS_ADD(triangleTests, 1);
+
+        const Vector3D p = ray.direction.CrossProduct(data.edgeAC);
+        const float determinant = data.edgeAB.DotProduct(p);
+        if (std::fpclassify(determinant) == FP_ZERO) {
+            // The ray is parallel to the plane!
+            return false;
         }
 
-        Point3D intersectionPoint{};
-        intersectionPoint.x = ray.origin.x + (ray.direction.dx * t);
-        intersectionPoint.y = ray.origin.y + (ray.direction.dy * t);
-        intersectionPoint.z = ray.origin.z + (ray.direction.dz * t);
+        // Work with everything scaled by the determinant, so we only have to divide once we know there's a hit.
+        const float sign = std::signbit(determinant) ? -1.f : 1.f;
+        const float scaledArea = determinant * sign;
 
-        if (!PointInTriangle(intersectionPoint))
-            return {};
+        const Vector3D s(data.vertexA, ray.origin);
+        const Vector3D q = s.CrossProduct(data.edgeAB);
 
-		if (intersectionTime != nullptr)
-			*intersectionTime = t;
+        const float scaledBeta = s.DotProduct(p) * sign;
+        const float scaledGamma = ray.direction.DotProduct(q) * sign;
+        const float scaledTime = data.edgeAC.DotProduct(q) * sign;
 
-        return intersectionPoint;
+        // The point of intersection has to be within the triangle and in front of the ray's origin.
+        const bool inside = (scaledBeta >= 0.f) & (scaledGamma >= 0.f) & ((scaledBeta + scaledGamma) <= scaledArea);
+        if (!inside || !std::isgreater(scaledTime, 0.f))
+            return false;
+
+        const float inverseDeterminant = 1.f / scaledArea;
+        const float t = scaledTime * inverseDeterminant;
+        beta = scaledBeta * inverseDeterminant;
+        gamma = scaledGamma * inverseDeterminant;
+
+        intersectionTime = t;
+        return true;
+    }
+
+    // Description: Intersects every lane of 'packet' enabled in 'laneMask' with the triangle described by 'data' at
+    // once, doing the same math as the single ray version. Each lane's time of intersection and barycentric
+    // coordinates are stored in 'intersectionTimes', 'betas', and 'gammas', with 'laneHits' set to 1 if it hit and 0
+    // otherwise.
+    static void
+    IntersectWith(const IntersectionData& data, const RayPacket& packet, const int32_t* laneMask,
+        float* intersectionTimes, int32_t* laneHits, float* betas, float* gammas)
+    {
+        RAY_STATS_ADD(triangleTests, RayStats::CountLanes(laneMask));
+
+        #pragma omp simd
+        for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+            const Vector3D direction(packet.directionX[lane], packet.directionY[lane], packet.directionZ[lane]);
+            const Point3D origin(packet.originX[lane], packet.originY[lane], packet.originZ[lane]);
+
+            const Vector3D p = direction.CrossProduct(data.edgeAC);
+            const float determinant = data.edgeAB.DotProduct(p);
+
+            const float sign = std::signbit(determinant) ? -1.f : 1.f;
+            const float scaledArea = determinant * sign;
+
+            const Vector3D s(data.vertexA, origin);
+            const Vector3D q = s.CrossProduct(data.edgeAB);
+
+            const float scaledBeta = s.DotProduct(p) * sign;
+            const float scaledGamma = direction.DotProduct(q) * sign;
+            const float scaledTime = data.edgeAC.DotProduct(q) * sign;
+
+            const int32_t inside = (determinant != 0.f) & (scaledBeta >= 0.f) & (scaledGamma >= 0.f)
+                & ((scaledBeta + scaledGamma) <= scaledArea) & (scaledTime > 0.f);
+
+            const float inverseDeterminant = 1.f / scaledArea;
+            intersectionTimes[lane] = scaledTime * inverseDeterminant;
+            betas[lane] = scaledBeta * inverseDeterminant;
+            gammas[lane] = scaledGamma * inverseDeterminant;
+            laneHits[lane] = laneMask[lane] & inside;
+        }
     }
 
     // Description: Refer to the Object struct.
@@ -343,53 +587,53 @@ public:
         return SmoothShaded() ? SmoothShadeSurfaceNormal(*surfacePoint) : FlatShadeSurfaceNormal();
     }
 
+    // Description: Refer to the Object struct.
+    [[nodiscard]] BoundingBox
+    Bounds() const override
+    {
+        BoundingBox bounds;
+        bounds.Expand(vertexA);
+        bounds.Expand(vertexB);
+        bounds.Expand(vertexC);
+
+        return bounds;
+    }
+
     // Description: Refer to the Object struct.`
-    [[nodiscard]] ColorRGB GetIntrinsicColorAtSurfacePoint(const Point3D& surfacePoint) const override;
+    [[nodiscard]] ColorRGB GetIntrinsicColor(const HitRecord& hit) const override;
 
     // Description: Checks if the Triangle 'other' is equivalent to this Triangle.
     bool operator==(const Triangle& other) const = default;
 
 private:
-    bool
+    // Everything shading needs that stays the same for every point on the triangle.
+    struct ShadingData {
+        Vector3D flatNormal;
+        float d11;
+        float d12;
+        float d22;
+        float inverseDeterminant;
+
+        bool operator==(const ShadingData& other) const = default;
+    };
+
+    IntersectionData intersectionData{};
+    ShadingData shadingData{};
+
+    void
     CalculateBarycentricCoordinates(const Point3D& surfacePoint, float& alpha, float& beta, float& gamma) const
     {
         // B * d11 + y * d12 = d1p
         // B * d12 + y * d11 = d2p
-        Vector3D e1 = Vector3D(vertexA, vertexB);
-        Vector3D e2 = Vector3D(vertexA, vertexC);
+        const ShadingData& data = shadingData;
         Vector3D ep = Vector3D(vertexA, surfacePoint);
 
-        float d11 = e1.DotProduct(e1);
-        float d12 = e1.DotProduct(e2);
-        float d22 = e2.DotProduct(e2);
-
-        float determinant = (d11 * d22) - (d12 * d12);
-
-		// Check if determinant is zero, given some leeway!
-		const float kEpsilon = 0.001f;
-		if (std::fabs(determinant) < kEpsilon)
-			return false;
-
-        float d1p = e1.DotProduct(ep);
-        float d2p = e2.DotProduct(ep);
+        float d1p = intersectionData.edgeAB.DotProduct(ep);
+        float d2p = intersectionData.edgeAC.DotProduct(ep);
 
-        beta = ((d22 * d1p) - (d12 * d2p)) / determinant;
-        gamma = ((d11 * d2p) - (d12 * d1p)) / determinant;
+        beta = ((data.d22 * d1p) - (data.d12 * d2p)) * data.inverseDeterminant;
+        gamma = ((data.d11 * d2p) - (data.d12 * d1p)) * data.inverseDeterminant;
         alpha = 1.f - beta - gamma;
-
-        return true;
-    }
-
-    [[nodiscard]] bool
-    PointInTriangle(const Point3D& pointToCheck) const
-    {
-        float alpha = 0.f;
-        float beta = 0.f;
-        float gamma = 0.f;
-        if (!CalculateBarycentricCoordinates(pointToCheck, alpha, beta, gamma))
-            return false;
-
-        return (alpha >= 0.f && alpha <= 1.f && beta >= 0.f && beta <= 1.f && gamma >= 0.f && gamma <= 1.f);
     }
 
     [[nodiscard]] bool
@@ -404,8 +648,7 @@ private:
         float alpha = 0.f;
         float beta = 0.f;
         float gamma = 0.f;
-        if (!CalculateBarycentricCoordinates(surfacePoint, alpha, beta, gamma))
-            return {};
+        CalculateBarycentricCoordinates(surfacePoint, alpha, beta, gamma);
 
         Vector3D surfaceNormal = (*vertexNormalA * alpha) + (*vertexNormalB * beta) + (*vertexNormalC * gamma);
         surfaceNormal.NormalizeSelf();
@@ -416,10 +659,7 @@ private:
     [[nodiscard]] Vector3D
     FlatShadeSurfaceNormal() const
     {
-        auto e1 = Vector3D(vertexA, vertexB);
-        auto e2 = Vector3D(vertexA, vertexC);
-
-        return e1.CrossProduct(e2).Normalize();
+        return shadingData.flatNormal;
     }
 
 	[[nodiscard]] bool
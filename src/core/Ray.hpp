@@ -18,7 +18,8 @@ public:
 
 public:
 	Ray();
-	Ray(const Ray& other);
+	Ray(const Ray& other) = default;
+	Ray& operator=(const Ray& other) = default;
 
 	virtual ~Ray() = default;
 
@@ -0,0 +1,116 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef RAY_PACKET_H
+#define RAY_PACKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "Point.hpp"
+#include "Ray.hpp"
+#include "Vector3D.hpp"
+
+// One lane per float in the widest vector registers we're compiling for: SSE (4), AVX/AVX2 (8), or AVX-512 (16).
+#if defined(__AVX512F__)
+static constexpr std::size_t kRayPacketSize = 16;
+#elif defined(__AVX__)
+static constexpr std::size_t kRayPacketSize = 8;
+#else
+static constexpr std::size_t kRayPacketSize = 4;
+#endif
+
+static constexpr int64_t kNoObjectHit = -1;
+
+/** RayPacket */
+
+// A group of rays stored as a structure of arrays (one array per component), so that a ray/object test can run on
+// every lane at once with vector instructions. Lanes are masked out with 'active' as the rays in a packet diverge.
+struct alignas(64) RayPacket {
+	alignas(64) float originX[kRayPacketSize];
+	alignas(64) float originY[kRayPacketSize];
+	alignas(64) float originZ[kRayPacketSize];
+
+	alignas(64) float directionX[kRayPacketSize];
+	alignas(64) float directionY[kRayPacketSize];
+	alignas(64) float directionZ[kRayPacketSize];
+
+	alignas(64) float inverseDirectionX[kRayPacketSize];
+	alignas(64) float inverseDirectionY[kRayPacketSize];
+	alignas(64) float inverseDirectionZ[kRayPacketSize];
+
+	// The closest intersection found so far (or the farthest an intersection may be), and which object it's with.
+	// When that object is a MeshInstance, 'primitiveIndex' is which of its mesh's triangles was hit. When a triangle
+	// was hit, 'beta' and 'gamma' are the barycentric coordinates of the intersection.
+	alignas(64) float maxTime[kRayPacketSize];
+	alignas(64) int64_t objectIndex[kRayPacketSize];
+	alignas(64) uint32_t primitiveIndex[kRayPacketSize];
+	alignas(64) float beta[kRayPacketSize];
+	alignas(64) float gamma[kRayPacketSize];
+
+	// Lanes that are set to 0 are ignored.
+	alignas(64) int32_t active[kRayPacketSize];
+
+public:
+	// Description: Constructs a packet with every lane inactive.
+	RayPacket()
+	{
+		for (std::size_t lane = 0; lane < kRayPacketSize; lane++) {
+			originX[lane] = originY[lane] = originZ[lane] = 0.f;
+			directionX[lane] = directionY[lane] = directionZ[lane] = 0.f;
+			inverseDirectionX[lane] = inverseDirectionY[lane] = inverseDirectionZ[lane] = 0.f;
+			maxTime[lane] = std::numeric_limits<float>::max();
+			objectIndex[lane] = kNoObjectHit;
+			primitiveIndex[lane] = 0;
+			beta[lane] = gamma[lane] = 0.f;
+			active[lane] = 0;
+		}
+	}
+
+	// Description: Puts 'ray' in 'lane' and activates it, with intersections allowed up to 'laneMaxTime'.
+	void
+	SetRay(std::size_t lane, const Ray& ray, float laneMaxTime = std::numeric_limits<float>::max())
+	{
+		originX[lane] = ray.origin.x;
+		originY[lane] = ray.origin.y;
+		originZ[lane] = ray.origin.z;
+
+		directionX[lane] = ray.direction.dx;
+		directionY[lane] = ray.direction.dy;
+		directionZ[lane] = ray.direction.dz;
+
+		inverseDirectionX[lane] = 1.f / ray.direction.dx;
+		inverseDirectionY[lane] = 1.f / ray.direction.dy;
+		inverseDirectionZ[lane] = 1.f / ray.direction.dz;
+
+		maxTime[lane] = laneMaxTime;
+		objectIndex[lane] = kNoObjectHit;
+		primitiveIndex[lane] = 0;
+		beta[lane] = gamma[lane] = 0.f;
+		active[lane] = 1;
+	}
+
+	// Description: Returns the ray in 'lane'.
+	[[nodiscard]] Ray
+	GetRay(std::size_t lane) const
+	{
+		Ray ray;
+		ray.origin = Point3D(originX[lane], originY[lane], originZ[lane]);
+		ray.direction = Vector3D(directionX[lane], directionY[lane], directionZ[lane]);
+
+		return ray;
+	}
+
+	// Description: Returns true if any lane is still active.
+	[[nodiscard]] bool
+	AnyActive() const
+	{
+		int32_t any = 0;
+		for (std::size_t lane = 0; lane < kRayPacketSize; lane++)
+			any |= active[lane];
+
+		return any != 0;
+	}
+};
+
+#endif // RAY_PACKET_H
@@ -0,0 +1,47 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+#include "RayStats.hpp"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+
+/* RayStats */
+
+// A thread's counters, on cache lines of their own.
+struct alignas(64) PaddedRayCounters {
+	RayCounters counters;
+};
+
+// Every thread's counters, kept around after the thread's gone so they're still added up.
+static std::mutex sRegistryMutex;
+static std::deque<std::unique_ptr<PaddedRayCounters>> sRegistry;
+
+RayCounters*
+RayStats::Register_()
+{
+	std::lock_guard lock(sRegistryMutex);
+	sRegistry.push_back(std::make_unique<PaddedRayCounters>());
+	return &sRegistry.back()->counters;
+}
+
+RayCounters
+RayStats::Total()
+{
+	std::lock_guard lock(sRegistryMutex);
+
+	RayCounters total;
+	for (const std::unique_ptr<PaddedRayCounters>& padded : sRegistry)
+		total += padded->counters;
+
+	return total;
+}
+
+void
+RayStats::Reset()
+{
+	std::lock_guard lock(sRegistryMutex);
+	for (const std::unique_ptr<PaddedRayCounters>& padded : sRegistry)
+		padded->counters = RayCounters{};
+}
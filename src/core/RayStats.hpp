@@ -0,0 +1,118 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef RAY_STATS_H
+#define RAY_STATS_H
+
+#include <cstdint>
+
+#include "RayPacket.hpp"
+
+/** RayCounters */
+
+// How many rays of each kind were traced, and how many intersection tests they took.
+struct RayCounters {
+	uint64_t primaryRays = 0;
+	uint64_t shadowRays = 0;
+	uint64_t reflectedRays = 0;
+	uint64_t refractedRays = 0;
+
+	// Rays traced to find the closest thing they hit, and whether they hit anything.
+	uint64_t closestHits = 0;
+	uint64_t closestMisses = 0;
+
+	// Intersection tests, counting each lane of a packet as one test.
+	uint64_t boxTests = 0;
+	uint64_t sphereTests = 0;
+	uint64_t cylinderTests = 0;
+	uint64_t triangleTests = 0;
+	uint64_t instanceTests = 0;
+
+	// Description: Returns how many rays were traced, of every kind.
+	[[nodiscard]] uint64_t
+	TotalRays() const
+	{
+		return primaryRays + shadowRays + reflectedRays + refractedRays;
+	}
+
+	// Description: Returns how many intersection tests were done against primitives, rather than bounding boxes.
+	[[nodiscard]] uint64_t
+	PrimitiveTests() const
+	{
+		return sphereTests + cylinderTests + triangleTests + instanceTests;
+	}
+
+	RayCounters&
+	operator+=(const RayCounters& other)
+	{
+		primaryRays += other.primaryRays;
+		shadowRays += other.shadowRays;
+		reflectedRays += other.reflectedRays;
+		refractedRays += other.refractedRays;
+		closestHits += other.closestHits;
+		closestMisses += other.closestMisses;
+		boxTests += other.boxTests;
+		sphereTests += other.sphereTests;
+		cylinderTests += other.cylinderTests;
+		triangleTests += other.triangleTests;
+		instanceTests += other.instanceTests;
+		return *this;
+	}
+};
+
+
+/** RayStats */
+
+// Every thread that traces rays counts them in its own RayCounters, each on cache lines of its own so that threads
+// counting at once don't fight over them, and they're only added up once the rendering's done.
+// Counting is only compiled in when RAYTRACER_STATS is defined, and RAY_STATS_ADD() does nothing at all otherwise.
+class RayStats {
+public:
+#ifdef RAYTRACER_STATS
+	static constexpr bool kEnabled = true;
+#else
+	static constexpr bool kEnabled = false;
+#endif
+
+	// Description: Returns the counters of the calling thread.
+	static RayCounters&
+	Local()
+	{
+		if (sLocal == nullptr) [[unlikely]]
+			sLocal = Register_();
+
+		return *sLocal;
+	}
+
+	// Description: Returns the counters of every thread added up. Nothing can be tracing rays while they're added up.
+	static RayCounters Total();
+
+	// Description: Zeroes the counters of every thread. Nothing can be tracing rays while they're zeroed.
+	static void Reset();
+
+	// Description: Returns how many lanes are enabled in 'laneMask', the mask of a packet of kRayPacketSize lanes.
+	static uint64_t
+	CountLanes(const int32_t* laneMask)
+	{
+		uint64_t laneCount = 0;
+		for (std::size_t lane = 0; lane < kRayPacketSize; lane++)
+			laneCount += laneMask[lane] != 0 ? 1 : 0;
+
+		return laneCount;
+	}
+
+private:
+	static RayCounters* Register_();
+
+	// Constant initialized where it's declared, so reading it is no more than a load from the thread's own storage.
+	static inline constinit thread_local RayCounters* sLocal = nullptr;
+};
+
+// Adds 'amount' to the calling thread's counter 'counter', which compiles down to nothing, 'amount' and all, without
+// RAYTRACER_STATS.
+#ifdef RAYTRACER_STATS
+#define RAY_STATS_ADD(counter, amount) (RayStats::Local().counter += (amount))
+#else
+#define RAY_STATS_ADD(counter, amount) ((void)0)
+#endif
+
+#endif // RAY_STATS_H
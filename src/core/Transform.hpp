@@ -0,0 +1,146 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <cmath>
+#include <optional>
+
+#include "BoundingBox.hpp"
+#include "Point.hpp"
+#include "Ray.hpp"
+#include "Vector3D.hpp"
+
+/** Transform */
+
+// An affine transformation, stored as the top three rows of a 4x4 matrix (the bottom row is always 0 0 0 1).
+// The last column is the translation.
+struct Transform {
+	float m[3][4];
+
+public:
+	// Description: Constructs the identity transform.
+	Transform()
+		:
+		m{{1.f, 0.f, 0.f, 0.f},
+		  {0.f, 1.f, 0.f, 0.f},
+		  {0.f, 0.f, 1.f, 0.f}}
+	{
+	}
+
+	// Description: Transforms 'point', translation included.
+	[[nodiscard]] Point3D
+	TransformPoint(const Point3D& point) const
+	{
+		return {
+			(m[0][0] * point.x) + (m[0][1] * point.y) + (m[0][2] * point.z) + m[0][3],
+			(m[1][0] * point.x) + (m[1][1] * point.y) + (m[1][2] * point.z) + m[1][3],
+			(m[2][0] * point.x) + (m[2][1] * point.y) + (m[2][2] * point.z) + m[2][3]
+		};
+	}
+
+	// Description: Transforms 'vector', which ignores the translation.
+	[[nodiscard]] Vector3D
+	TransformVector(const Vector3D& vector) const
+	{
+		return {
+			(m[0][0] * vector.dx) + (m[0][1] * vector.dy) + (m[0][2] * vector.dz),
+			(m[1][0] * vector.dx) + (m[1][1] * vector.dy) + (m[1][2] * vector.dz),
+			(m[2][0] * vector.dx) + (m[2][1] * vector.dy) + (m[2][2] * vector.dz)
+		};
+	}
+
+	// Description: Transforms 'vector' by the transpose of this transform, ignoring the translation.
+	// Surface normals have to go through the inverse transpose to stay perpendicular to a surface that's been scaled or
+	// sheared, so calling this on the inverse of a transform is how to transform normals with it.
+	[[nodiscard]] Vector3D
+	TransposeTransformVector(const Vector3D& vector) const
+	{
+		return {
+			(m[0][0] * vector.dx) + (m[1][0] * vector.dy) + (m[2][0] * vector.dz),
+			(m[0][1] * vector.dx) + (m[1][1] * vector.dy) + (m[2][1] * vector.dz),
+			(m[0][2] * vector.dx) + (m[1][2] * vector.dy) + (m[2][2] * vector.dz)
+		};
+	}
+
+	// Description: Transforms 'ray'. Its direction is left as it comes out, without being normalized, so that times of
+	// intersection found with the transformed ray are the same as with 'ray'.
+	[[nodiscard]] Ray
+	TransformRay(const Ray& ray) const
+	{
+		Ray transformedRay;
+		transformedRay.origin = TransformPoint(ray.origin);
+		transformedRay.direction = TransformVector(ray.direction);
+
+		return transformedRay;
+	}
+
+	// Description: Returns the smallest axis aligned box that fully encloses 'box' once it's been transformed.
+	[[nodiscard]] BoundingBox
+	TransformBox(const BoundingBox& box) const
+	{
+		BoundingBox transformedBox;
+		if (box.Empty())
+			return transformedBox;
+
+		for (int corner = 0; corner < 8; corner++) {
+			const Point3D point((corner & 1) != 0 ? box.max.x : box.min.x,
+				(corner & 2) != 0 ? box.max.y : box.min.y,
+				(corner & 4) != 0 ? box.max.z : box.min.z);
+			transformedBox.Expand(TransformPoint(point));
+		}
+
+		return transformedBox;
+	}
+
+	// Description: Calculates the transform that undoes this one.
+	// Returns: The inverse, or nothing if this transform squashes space flat and can't be undone.
+	[[nodiscard]] std::optional<Transform>
+	Inverse() const
+	{
+		// Inverse of the 3x3 part through its cofactors.
+		const float c00 = (m[1][1] * m[2][2]) - (m[1][2] * m[2][1]);
+		const float c01 = (m[1][2] * m[2][0]) - (m[1][0] * m[2][2]);
+		const float c02 = (m[1][0] * m[2][1]) - (m[1][1] * m[2][0]);
+
+		const float determinant = (m[0][0] * c00) + (m[0][1] * c01) + (m[0][2] * c02);
+		if (std::fpclassify(determinant) == FP_ZERO)
+			return {};
+
+		const float inverseDeterminant = 1.f / determinant;
+
+		Transform inverse;
+		inverse.m[0][0] = c00 * inverseDeterminant;
+		inverse.m[1][0] = c01 * inverseDeterminant;
+		inverse.m[2][0] = c02 * inverseDeterminant;
+		inverse.m[0][1] = ((m[0][2] * m[2][1]) - (m[0][1] * m[2][2])) * inverseDeterminant;
+		inverse.m[1][1] = ((m[0][0] * m[2][2]) - (m[0][2] * m[2][0])) * inverseDeterminant;
+		inverse.m[2][1] = ((m[0][1] * m[2][0]) - (m[0][0] * m[2][1])) * inverseDeterminant;
+		inverse.m[0][2] = ((m[0][1] * m[1][2]) - (m[0][2] * m[1][1])) * inverseDeterminant;
+		inverse.m[1][2] = ((m[0][2] * m[1][0]) - (m[0][0] * m[1][2])) * inverseDeterminant;
+		inverse.m[2][2] = ((m[0][0] * m[1][1]) - (m[0][1] * m[1][0])) * inverseDeterminant;
+
+		// Then undo the translation, after the rest has been undone.
+		for (int row = 0; row < 3; row++) {
+			inverse.m[row][3] = -((inverse.m[row][0] * m[0][3]) + (inverse.m[row][1] * m[1][3])
+				+ (inverse.m[row][2] * m[2][3]));
+		}
+
+		return inverse;
+	}
+};
+
+inline std::ostream&
+operator<<(std::ostream& out, const Transform& transform)
+{
+	for (int row = 0; row < 3; row++) {
+		out << (row == 0 ? "[" : " ");
+		for (int column = 0; column < 4; column++)
+			out << transform.m[row][column] << (column < 3 ? " " : "");
+		out << (row == 2 ? "]" : "\n");
+	}
+
+	return out;
+}
+
+#endif // TRANSFORM_H
@@ -116,11 +116,4 @@ operator<<(std::ostream& out, const TextureCoordinate& coordinate)
 	return out;
 }
 
-
-struct PixelInfo {
-	ColorRGB pixel;
-	uint32_t x;
-	uint32_t y;
-};
-
 #endif // TYPE_DEFINITIONS_H
@@ -4,140 +4,188 @@
 //#include <parallel/algorithm>
 //#include <execution>
 
+#include <chrono>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
 
-#include <omp.h>
-
+#include "BatchRenderer.hpp"
+#include "CostHeatmap.hpp"
+#include "Framebuffer.hpp"
 #include "GraphicsEngine.hpp"
-#include "InputFileParser.hpp"
+#include "PhaseTrace.hpp"
 #include "PpmWriter.hpp"
-#include "core/Texture.hpp"
-#include "TextureCache.hpp"
+#include "RenderClient.hpp"
+#include "RenderOptions.hpp"
+#include "RenderServer.hpp"
+#include "SceneLoader.hpp"
+#include "SceneRenderer.hpp"
+#include "TileCoordinator.hpp"
+#include "TileRenderer.hpp"
+#include "TileScheduler.hpp"
+#include "TileWorker.hpp"
+#include "Transport.hpp"
+#include "core/RayStats.hpp"
 #include "core/TypeDefinitions.hpp"
 
 #include "tests.hpp"
 
+// Description: Returns the path to this program, called as 'programName', for starting more of it.
+static std::filesystem::path
+program_path(const char* programName)
+{
+	std::error_code error;
+	std::filesystem::path path = std::filesystem::read_symlink("/proc/self/exe", error);
+	if (error)
+		path = std::filesystem::absolute(programName);
+
+	return path;
+}
+
 int
 main(int argc, char* argv[])
 {
 	// Check arguments...
-	if (argc != 2) {
-		std::cerr << "Usage: " << argv[0] << " <Path to input file>" << std::endl;
+	std::optional<RenderOptions> maybeOptions = RenderOptions::FromArguments(argc, argv);
+	if (!maybeOptions) {
+		RenderOptions::PrintUsage(std::cerr, argv[0]);
 		return EXIT_FAILURE;
 	}
+	const RenderOptions& options = *maybeOptions;
 
-	// (1) Start reading in the input file!
-	std::cout << "=== Reading in Input File ===" << std::endl;
+	if (options.workerAddress) {
+		// Workers usually share the coordinator's terminal, which has already printed out everything about the scene,
+		// so only their errors are worth printing.
+		std::cout.setstate(std::ios_base::badbit);
 
-	auto inputFilePath = std::filesystem::path(argv[1]);
-	if (!std::filesystem::exists(inputFilePath)) {
-		std::cerr << "The provided filepath does not exist! Exiting..." << std::endl;
-		return EXIT_FAILURE;
+		TileWorker worker(*options.workerAddress);
+		return worker.Run() ? EXIT_SUCCESS : EXIT_FAILURE;
 	}
 
-	SceneDefinition scene;
+	if (options.serverAddress) {
+		std::unique_ptr<Listener> listener = Listener::Listen(*options.serverAddress);
+		if (!listener)
+			return EXIT_FAILURE;
 
-	InputFileParser parser(inputFilePath);
-	bool result = parser.Parse(scene);
-	parser.Close();
-	if (!result) {
-		std::cerr << "Couldn't parse the input file! Did you format it correctly?" << std::endl;
-		return EXIT_FAILURE;
+		RenderServer server(std::move(listener), options.maxConcurrentJobs);
+		return server.Run(std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
 	}
 
-    // Let's set our current working directory to where the scene definition file was found.
-    std::error_code error;
-    std::filesystem::current_path(inputFilePath.remove_filename(), error);
-    if (error) {
-        std::cerr << "(Error) Failed to switch current working directory to directory containing the scene definition file." << std::endl;
-        return EXIT_FAILURE;
-    }
+	if (options.submitAddress) {
+		RenderClient client(*options.submitAddress);
+		return client.Submit(options, std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
 
-	// Print out Scene Definition
-	std::cout << "Scene Definition Read:" << std::endl;
-	std::cout << scene << std::endl;
+	if (!options.batchManifestPath.empty()) {
+		std::vector<std::filesystem::path> scenePaths;
+		if (!BatchRenderer::ReadManifest(options.batchManifestPath, scenePaths))
+			return EXIT_FAILURE;
 
-    // Pre-Load Texture Files
-    std::cout << "=== Pre-Loading Texture Files ===" << std::endl;
-    for (const auto& object : scene.objectList) {
-        if (object->texturePath.empty())
-            continue;
+		BatchRenderer batch(options);
+		const bool rendered = batch.Render(scenePaths, std::cout);
+		if (!batch.WriteSummary(options.batchSummaryPath))
+			return EXIT_FAILURE;
 
-        if (TextureCache::Instance().HasTexture(object->texturePath))
-            continue;
+		std::cout << "Batch summary written to: " << options.batchSummaryPath.string() << std::endl;
+		return rendered ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
 
-        if (!TextureCache::Instance().LoadTexture(object->texturePath)) {
-            std::cerr << "(Error) Failed to start loading texture from file: " << object->texturePath << std::endl;
-            return EXIT_FAILURE;
-        }
+	if (!options.tracePath.empty())
+		PhaseTrace::Start();
 
-        std::cout << "\tLoaded Texture: " << object->texturePath << std::endl;
-    }
+	const std::filesystem::path programPath = program_path(argv[0]);
+	const std::filesystem::path inputFilePath = std::filesystem::absolute(options.inputFilePath);
 
-    // Wait on textures to finish loading...
-//    TextureCache::Instance().WaitForTextureLoad();
-    std::cout << "\tFinished loading textures!" << std::endl;
+	SceneDefinition scene;
+	if (!SceneLoader::Load(inputFilePath, scene, std::cout))
+		return EXIT_FAILURE;
+
+	SceneRenderer::ChoosePruning(scene, options);
 
 	// (2) Pixel Array Time!
 	std::cout << "=== Creating Pixel Array ===" << std::endl;
-	const size_t pixelBufferSize = scene.imagePixelSize.width * scene.imagePixelSize.height;
-
-	std::vector<PixelInfo> pixelBuffer(pixelBufferSize);
-
-	// Pre-populate the pixel array with information about the corresponding X and Y coordinate.
-	size_t currentPixelIndex = 0;
-	for (uint32_t currentY = 0; currentY < scene.imagePixelSize.height; currentY++) {
-		for (uint32_t currentX = 0; currentX < scene.imagePixelSize.width; currentX++) {
-			pixelBuffer[currentPixelIndex].x = currentX;
-			pixelBuffer[currentPixelIndex].y = currentY;
-			currentPixelIndex++;
-		}
+	std::optional<ScopedPhaseTimer> phaseTimer(std::in_place, "Creating Pixel Array");
+	Framebuffer framebuffer(scene.imagePixelSize);
+
+	// (3) Ray Casting Time!
+	std::cout << "=== Casting The Rays ===" << std::endl;
+	phaseTimer.emplace("Casting The Rays");
+	std::optional<CostHeatmap> heatmap;
+	if (options.heatmapMetric) {
+		const Tile wholeImage{ 0, 0, scene.imagePixelSize.width, scene.imagePixelSize.height };
+		heatmap.emplace(scene.imagePixelSize, options.cropWindow.value_or(wholeImage), *options.heatmapMetric);
 	}
 
-	// (3) Define Viewing Window
-	std::cout << "=== Defining View Window ===" << std::endl;
-	CoordSys coordinateSystem(scene.viewDirection, scene.upDirection);
-	ViewingWindow window(coordinateSystem, scene.viewDirection, scene.eyePosition, scene.fovVertical, scene.imagePixelSize);
+	TileRenderStats renderStats;
+	RayStats::Reset();
+	const auto renderStartTime = std::chrono::steady_clock::now();
+	if (options.coordinatorAddress) {
+		std::unique_ptr<Listener> listener = Listener::Listen(*options.coordinatorAddress);
+		if (!listener)
+			return EXIT_FAILURE;
+
+		std::cout << "\tHanding out tiles to workers at " << listener->Address().ToString() << std::endl;
+
+		// Workers load the scene for themselves, so they need to be able to find it from wherever they're started.
+		RenderOptions job = options;
+		job.inputFilePath = inputFilePath;
+
+		const std::optional<Tile> region = SceneRenderer::PrepareRegion(scene, options, framebuffer);
+		if (!region)
+			return EXIT_FAILURE;
+
+		TileCoordinator coordinator(std::move(listener), job);
+		TileScheduler scheduler(*region, options.tileSize);
+		if (!coordinator.SpawnWorkers(options.workerCount, programPath)
+			|| !coordinator.Render(scheduler.Tiles(), framebuffer))
+			return EXIT_FAILURE;
+
+		coordinator.PrintReport(std::cout);
+		renderStats = coordinator.Stats();
+	} else if (!SceneRenderer::Render(scene, options, inputFilePath, framebuffer, renderStats, std::cout, {},
+			heatmap ? &*heatmap : nullptr)) {
+		return EXIT_FAILURE;
+	}
 
-	// (4) Ray Casting Time!
-	std::cout << "=== Casting The Rays ===" << std::endl;
-	Ray wildRay{};
-	wildRay.origin = scene.eyePosition;
-
-	// The depth to use!
-	const uint32_t depthChoice = 2;
-
-	#pragma omp parallel firstprivate(wildRay) shared(pixelBuffer) shared(window) shared(scene) default(none)
-	{
-		#pragma omp for schedule(auto)
-		for (auto& pixelInfo : pixelBuffer)
-		{
-			// Map the current pixel of the image to a point on the view window.
-			Point2D<uint32_t> currentPoint(pixelInfo.x, pixelInfo.y);
-			Point3D viewWindowPoint = window.MapImagePixelToPoint(scene.imagePixelSize, currentPoint);
-			// Point the ray towards the view window.
-			wildRay.SetDirectionFromIntersection(viewWindowPoint);
-
-			pixelInfo.pixel = GraphicsEngine::TraceWithRay(wildRay, scene, scene.backgroundRefractionIndex, depthChoice);
-		}
+	SceneRenderer::PrintStats(std::cout, renderStats, framebuffer.PixelCount(), options);
+
+	// The coordinator's workers trace all of its rays, so it has none of its own to count.
+	if (RayStats::kEnabled && !options.coordinatorAddress) {
+		const double renderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now()
+			- renderStartTime).count();
+		const RayCounters rayCounters = RayStats::Total();
+		SceneRenderer::PrintRayStats(std::cout, rayCounters, renderSeconds);
+		if (!options.rayStatsPath.empty() && !SceneRenderer::WriteRayStats(options.rayStatsPath, rayCounters, renderSeconds))
+			return EXIT_FAILURE;
 	}
 
 	// Write out PPM File!
 	std::cout << "=== Writing Out PPM File ===" << std::endl;
-	PPMWriter writer{};
-
-	if (!ppm_writer_open(argv[1], &writer))
+	phaseTimer.emplace("Writing Out PPM File");
+	if (!ppm_writer_write_file(inputFilePath.c_str(), SceneRenderer::OutputImage(std::move(framebuffer), options)))
 		return EXIT_FAILURE;
 
-	ppm_writer_set_image_size(&writer, scene.imagePixelSize);
+	if (heatmap) {
+		std::cout << "=== Writing Out Cost Heatmap ===" << std::endl;
+		phaseTimer.emplace("Writing Out Cost Heatmap");
+		heatmap->PrintSummary(std::cout);
 
-	// Write out the pixels in ASCII PPM format
-	if (!ppm_writer_write(&writer, pixelBuffer)) {
-		std::cerr << "Failed to write out pixels to the PPM file." << std::endl;
-		return EXIT_FAILURE;
+		std::filesystem::path heatmapName = inputFilePath;
+		heatmapName += ".heatmap";
+		if (!ppm_writer_write_file(heatmapName.c_str(), SceneRenderer::OutputImage(heatmap->ToImage(), options)))
+			return EXIT_FAILURE;
 	}
+	phaseTimer.reset();
 
-	ppm_writer_close(&writer);
+	if (PhaseTrace::IsRecording()) {
+		std::cout << "=== Timing Each Phase ===" << std::endl;
+		PhaseTrace::PrintPhases(std::cout);
+		if (!PhaseTrace::WriteChromeTrace(options.tracePath))
+			return EXIT_FAILURE;
+
+		std::cout << "\tTrace written to: " << options.tracePath.string() << std::endl;
+	}
 
 	std::cout << "All done! Have a fine day! :)" << std::endl;
 	return EXIT_SUCCESS;
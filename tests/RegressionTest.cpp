@@ -0,0 +1,538 @@
+// Assignment 1d - Transparency and Mirror Reflections
+// Work by Jacob Secunda
+
+// Renders a scene with raytracer1d and checks the image it writes out against a golden image, how long it took against
+// a baseline, or that the cost heatmap it writes out shows the costs. CTest runs one of these per scene and way of
+// rendering it; see CMakeLists.txt.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "Framebuffer.hpp"
+#include "PpmWriter.hpp"
+
+// A render can take this much longer than its baseline without failing, however short it is, as starting the renderer
+// and reading in the scene takes about this long and varies from run to run.
+static constexpr double kTimingSlackSeconds = 0.01;
+
+// What the program exits with when there's nothing to check against yet, which CTest reports as a skipped test rather
+// than a passing one; see SKIP_RETURN_CODE in CMakeLists.txt.
+static constexpr int kSkippedExitCode = 77;
+
+// How a check turned out.
+enum class CheckResult {
+	Passed,
+	Failed,
+	Skipped
+};
+
+// An image, with each pixel's red, green, and blue components one after another, row by row.
+struct Image {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	std::vector<uint8_t> components;
+};
+
+// Everything about the check that comes from the command line.
+struct RegressionOptions {
+	std::string mode;
+	std::string name;
+	std::filesystem::path rendererPath;
+	std::filesystem::path scenePath;
+	std::filesystem::path workDirectory;
+
+	// For checking the image.
+	std::filesystem::path goldenPath;
+	int tolerance = 1;
+	double minimumPsnr = 50.0;
+
+	// For checking how long it took.
+	std::filesystem::path baselinePath;
+	double maximumSlowdown = 20.0;
+	int runCount = 3;
+
+	// Write out what was rendered as the new golden image or baseline, rather than checking against it.
+	bool update = false;
+
+	// Passed on to the renderer.
+	std::vector<std::string> rendererOptions;
+};
+
+/* Images */
+
+// Description: Reads the next number out of the header of a PPM file, skipping whitespace and comments.
+// Returns: false if there isn't one.
+static bool
+read_header_number(std::istream& in, uint32_t& number)
+{
+	while (in) {
+		const int next = in.peek();
+		if (next == '#') {
+			in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+		} else if (std::isspace(next)) {
+			in.get();
+		} else {
+			break;
+		}
+	}
+
+	return static_cast<bool>(in >> number);
+}
+
+// Description: Reads the ASCII (P3) or binary (P6) PPM image at 'path' into 'image'.
+// Returns: false if it couldn't be read.
+static bool
+read_ppm(const std::filesystem::path& path, Image& image)
+{
+	std::ifstream in(path, std::ios::binary);
+	std::string type;
+	uint32_t maxValue = 0;
+	if (!(in >> type) || (type != "P3" && type != "P6") || !read_header_number(in, image.width)
+		|| !read_header_number(in, image.height) || !read_header_number(in, maxValue) || maxValue != 255) {
+		std::cerr << "(Error) Failed to read the PPM image at path: " << path << std::endl;
+		return false;
+	}
+
+	image.components.resize(static_cast<std::size_t>(image.width) * image.height * 3);
+	if (type == "P6") {
+		in.get();
+		in.read(reinterpret_cast<char*>(image.components.data()), static_cast<std::streamsize>(image.components.size()));
+	} else {
+		for (uint8_t& component : image.components) {
+			uint32_t value = 0;
+			in >> value;
+			component = static_cast<uint8_t>(value);
+		}
+	}
+
+	if (in.fail()) {
+		std::cerr << "(Error) The PPM image at path " << path << " ends before all of its pixels!" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+// Description: Writes 'image' out to 'path' as a binary (P6) PPM image, which golden images are kept as.
+// Returns: true if it was written.
+static bool
+write_golden(const std::filesystem::path& path, const Image& image)
+{
+	std::ofstream out(path, std::ios::binary);
+	out << "P6\n" << image.width << " " << image.height << "\n255\n";
+	out.write(reinterpret_cast<const char*>(image.components.data()), static_cast<std::streamsize>(image.components.size()));
+	out.close();
+
+	if (out.fail()) {
+		std::cerr << "(Error) Failed to write the golden image at path: " << path << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+
+/* Rendering */
+
+// Description: Copies the scene at 'scenePath', along with the textures next to it, into 'directory', so it can be
+// rendered without writing anything next to the original.
+// Returns: The path to the copy, or nothing if it couldn't be copied.
+static std::optional<std::filesystem::path>
+copy_scene(const std::filesystem::path& scenePath, const std::filesystem::path& directory)
+{
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	std::filesystem::create_directories(directory, error);
+
+	const std::filesystem::path copiedScene = directory / scenePath.filename();
+	std::filesystem::copy_file(scenePath, copiedScene, error);
+
+	const std::filesystem::path textureDirectory = scenePath.parent_path() / "texture";
+	if (!error && std::filesystem::is_directory(textureDirectory))
+		std::filesystem::copy(textureDirectory, directory / "texture", std::filesystem::copy_options::recursive, error);
+
+	if (error) {
+		std::cerr << "(Error) Failed to copy the scene " << scenePath << " to " << directory << ": " << error.message()
+			<< std::endl;
+		return {};
+	}
+
+	return copiedScene;
+}
+
+// Description: Renders the scene at 'scenePath' with the renderer and options in 'options', with what it prints out
+// going to 'logPath'.
+// Returns: true if it rendered the scene, along with how long that took.
+static bool
+run_renderer(const RegressionOptions& options, const std::filesystem::path& scenePath,
+	const std::filesystem::path& logPath, double& seconds)
+{
+	std::vector<std::string> arguments = { options.rendererPath.string() };
+	arguments.insert(arguments.end(), options.rendererOptions.begin(), options.rendererOptions.end());
+	arguments.push_back(scenePath.string());
+
+	std::vector<char*> argv;
+	for (std::string& argument : arguments)
+		argv.push_back(argument.data());
+	argv.push_back(nullptr);
+
+	const auto startTime = std::chrono::steady_clock::now();
+	const pid_t processID = fork();
+	if (processID < 0) {
+		std::cerr << "(Error) Couldn't start the renderer: " << std::strerror(errno) << std::endl;
+		return false;
+	}
+
+	if (processID == 0) {
+		const int log = open(logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (log >= 0)
+			dup2(log, STDOUT_FILENO);
+
+		execv(argv.front(), argv.data());
+		std::cerr << "(Error) Couldn't run the renderer " << argv.front() << ": " << std::strerror(errno) << std::endl;
+		_exit(EXIT_FAILURE);
+	}
+
+	int status = 0;
+	if (waitpid(processID, &status, 0) < 0) {
+		std::cerr << "(Error) Couldn't wait for the renderer: " << std::strerror(errno) << std::endl;
+		return false;
+	}
+
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+		std::cerr << "(Error) The renderer failed to render " << scenePath << ", see " << logPath << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+
+/* Checks */
+
+// Description: Renders the scene and compares its image to the golden one, pixel by pixel. Where they differ by more
+// than the tolerance, an image of the differences is written out next to the rendered one.
+// Returns: true if no component of any pixel differs by more than the tolerance, and the PSNR is high enough.
+static bool
+check_image(const RegressionOptions& options)
+{
+	const std::filesystem::path directory = options.workDirectory / options.name;
+	const std::optional<std::filesystem::path> scenePath = copy_scene(options.scenePath, directory);
+	double seconds = 0.0;
+	if (!scenePath || !run_renderer(options, *scenePath, directory / "render.log", seconds))
+		return false;
+
+	std::filesystem::path renderedPath = *scenePath;
+	renderedPath += ".ppm";
+
+	Image rendered;
+	if (!read_ppm(renderedPath, rendered))
+		return false;
+
+	if (options.update) {
+		if (!write_golden(options.goldenPath, rendered))
+			return false;
+
+		std::cout << "Wrote the golden image for " << options.name << " to " << options.goldenPath.string() << std::endl;
+		return true;
+	}
+
+	if (!std::filesystem::exists(options.goldenPath)) {
+		std::cerr << "(Error) There's no golden image for " << options.name << " at " << options.goldenPath
+			<< ". Build the update_golden_images target to render one." << std::endl;
+		return false;
+	}
+
+	Image golden;
+	if (!read_ppm(options.goldenPath, golden))
+		return false;
+
+	if (rendered.width != golden.width || rendered.height != golden.height) {
+		std::cerr << "FAILED: " << options.name << " rendered at " << rendered.width << "x" << rendered.height
+			<< ", but the golden image is " << golden.width << "x" << golden.height << std::endl;
+		return false;
+	}
+
+	Framebuffer differences(Size{ rendered.width, rendered.height });
+	double squaredErrorSum = 0.0;
+	int largestDifference = 0;
+	std::size_t differingPixels = 0;
+	for (uint32_t y = 0; y < rendered.height; y++) {
+		for (uint32_t x = 0; x < rendered.width; x++) {
+			const std::size_t first = ((static_cast<std::size_t>(y) * rendered.width) + x) * 3;
+
+			int pixelDifference = 0;
+			for (std::size_t component = first; component < first + 3; component++) {
+				const int difference = std::abs(rendered.components[component] - golden.components[component]);
+				pixelDifference = std::max(pixelDifference, difference);
+				squaredErrorSum += static_cast<double>(difference * difference);
+			}
+
+			largestDifference = std::max(largestDifference, pixelDifference);
+			differingPixels += pixelDifference > options.tolerance ? 1 : 0;
+
+			// Exaggerated, so even the smallest differences can be seen.
+			const auto shade = static_cast<uint8_t>(std::min(255, pixelDifference * 16));
+			differences(x, y) = ColorRGB(shade, shade, shade);
+		}
+	}
+
+	// The peak signal-to-noise ratio, which is infinite when the images are the same.
+	const double meanSquaredError = squaredErrorSum / static_cast<double>(rendered.components.size());
+	const double psnr = meanSquaredError > 0.0 ? 10.0 * std::log10((255.0 * 255.0) / meanSquaredError)
+		: std::numeric_limits<double>::infinity();
+
+	std::cout << options.name << ": " << differingPixels << " of " << (rendered.width * rendered.height)
+		<< " pixels differ by more than " << options.tolerance << ", by " << largestDifference << " at most, PSNR "
+		<< psnr << " dB" << std::endl;
+
+	if (differingPixels == 0 && psnr >= options.minimumPsnr)
+		return true;
+
+	std::filesystem::path differencesName = directory / "differences";
+	ppm_writer_write_file(differencesName.c_str(), differences);
+	std::cerr << "FAILED: " << options.name << " doesn't match its golden image " << options.goldenPath
+		<< " (needs no pixel to differ by more than " << options.tolerance << " and a PSNR of at least "
+		<< options.minimumPsnr << " dB)" << std::endl;
+	return false;
+}
+
+// Description: Renders the scene with the heatmap options passed on to the renderer, and checks the cost heatmap it
+// writes out. Costs vary from run to run, so there's no golden image, but the heatmap must be the size of the image
+// and, as the costliest pixels rendered are shown as white, have some white in it.
+// Returns: true if it does.
+static bool
+check_heatmap(const RegressionOptions& options)
+{
+	const std::filesystem::path directory = options.workDirectory / options.name;
+	const std::optional<std::filesystem::path> scenePath = copy_scene(options.scenePath, directory);
+	double seconds = 0.0;
+	if (!scenePath || !run_renderer(options, *scenePath, directory / "render.log", seconds))
+		return false;
+
+	std::filesystem::path renderedPath = *scenePath;
+	renderedPath += ".ppm";
+	std::filesystem::path heatmapPath = *scenePath;
+	heatmapPath += ".heatmap.ppm";
+
+	Image rendered;
+	Image heatmap;
+	if (!read_ppm(renderedPath, rendered) || !read_ppm(heatmapPath, heatmap))
+		return false;
+
+	if (heatmap.width != rendered.width || heatmap.height != rendered.height) {
+		std::cerr << "FAILED: " << options.name << "'s heatmap is " << heatmap.width << "x" << heatmap.height
+			<< ", but the image is " << rendered.width << "x" << rendered.height << std::endl;
+		return false;
+	}
+
+	std::size_t whitePixels = 0;
+	for (std::size_t first = 0; first < heatmap.components.size(); first += 3) {
+		const auto pixel = heatmap.components.begin() + static_cast<std::ptrdiff_t>(first);
+		whitePixels += std::all_of(pixel, pixel + 3, [](uint8_t component) { return component == 255; }) ? 1 : 0;
+	}
+
+	std::cout << options.name << ": " << whitePixels << " of " << (heatmap.width * heatmap.height)
+		<< " pixels of the heatmap are white" << std::endl;
+
+	if (whitePixels > 0)
+		return true;
+
+	std::cerr << "FAILED: " << options.name << "'s heatmap has no white pixels, so the costs aren't scaled to the pixels"
+		" that were rendered" << std::endl;
+	return false;
+}
+
+// Description: Reads the render times in the baseline at 'path', one "<name> <seconds>" per line, into 'baseline'.
+static void
+read_baseline(const std::filesystem::path& path, std::map<std::string, double>& baseline)
+{
+	std::ifstream in(path);
+	std::string name;
+	double seconds = 0.0;
+	while (in >> name >> seconds)
+		baseline[name] = seconds;
+}
+
+static bool
+write_baseline(const std::filesystem::path& path, const std::map<std::string, double>& baseline)
+{
+	std::ofstream out(path);
+	for (const auto& [name, seconds] : baseline)
+		out << name << " " << seconds << "\n";
+	out.close();
+
+	if (out.fail()) {
+		std::cerr << "(Error) Failed to write the baseline at path: " << path << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+// Description: Renders the scene a few times, and compares the fastest to its time in the baseline. With '--update', or
+// the baseline's time is replaced with it instead.
+// Returns: Passed if it wasn't more than the allowed percentage slower, or Skipped if the scene isn't in the baseline.
+static CheckResult
+check_timing(const RegressionOptions& options)
+{
+	std::map<std::string, double> baseline;
+	read_baseline(options.baselinePath, baseline);
+
+	// A time from another machine, or from nowhere, says nothing about this one, so the scene isn't timed until its
+	// baseline has been recorded here on purpose.
+	const auto found = baseline.find(options.name);
+	if (!options.update && found == baseline.end()) {
+		std::cout << "SKIPPED: There's no time for " << options.name << " in the baseline at "
+			<< options.baselinePath.string() << ". Build the update_perf_baseline target to record one." << std::endl;
+		return CheckResult::Skipped;
+	}
+
+	const std::filesystem::path directory = options.workDirectory / options.name;
+	const std::optional<std::filesystem::path> scenePath = copy_scene(options.scenePath, directory);
+	if (!scenePath)
+		return CheckResult::Failed;
+
+	double fastestSeconds = std::numeric_limits<double>::infinity();
+	for (int run = 0; run < options.runCount; run++) {
+		double seconds = 0.0;
+		if (!run_renderer(options, *scenePath, directory / "render.log", seconds))
+			return CheckResult::Failed;
+
+		fastestSeconds = std::min(fastestSeconds, seconds);
+	}
+
+	if (options.update) {
+		baseline[options.name] = fastestSeconds;
+		if (!write_baseline(options.baselinePath, baseline))
+			return CheckResult::Failed;
+
+		std::cout << options.name << ": recorded " << fastestSeconds << "s in the baseline at "
+			<< options.baselinePath.string() << std::endl;
+		return CheckResult::Passed;
+	}
+
+	const double baselineSeconds = found->second;
+	const double slowdown = 100.0 * ((fastestSeconds / baselineSeconds) - 1.0);
+	std::cout << options.name << ": " << fastestSeconds << "s at best of " << options.runCount << " runs, against "
+		<< baselineSeconds << "s in the baseline (" << (slowdown >= 0.0 ? "+" : "") << slowdown << "%)" << std::endl;
+
+	if (slowdown <= options.maximumSlowdown || fastestSeconds - baselineSeconds <= kTimingSlackSeconds)
+		return CheckResult::Passed;
+
+	std::cerr << "FAILED: " << options.name << " is " << slowdown << "% slower than its baseline, more than the "
+		<< options.maximumSlowdown << "% allowed" << std::endl;
+	return CheckResult::Failed;
+}
+
+
+/* Options */
+
+static void
+print_usage(const char* programName)
+{
+	std::cerr << "Usage: " << programName << " image <name> --renderer <path> --scene <path> --work-directory <path> "
+		"--golden <path> [--tolerance <n>] [--min-psnr <dB>] [--update] [-- <renderer options>]" << std::endl;
+	std::cerr << "       " << programName << " timing <name> --renderer <path> --scene <path> --work-directory <path> "
+		"--baseline <path> [--max-slowdown <percent>] [--runs <n>] [--update] [-- <renderer options>]" << std::endl;
+	std::cerr << "       " << programName << " heatmap <name> --renderer <path> --scene <path> --work-directory <path> "
+		"-- <renderer options>" << std::endl;
+}
+
+static bool
+parse_options(int argc, char* argv[], RegressionOptions& options)
+{
+	if (argc < 3)
+		return false;
+
+	options.mode = argv[1];
+	options.name = argv[2];
+	for (int index = 3; index < argc; index++) {
+		const std::string_view option = argv[index];
+		if (option == "--") {
+			options.rendererOptions.assign(argv + index + 1, argv + argc);
+			break;
+		}
+
+		if (option == "--update") {
+			options.update = true;
+			continue;
+		}
+
+		if (index + 1 >= argc)
+			return false;
+
+		const char* value = argv[++index];
+		if (option == "--renderer")
+			options.rendererPath = value;
+		else if (option == "--scene")
+			options.scenePath = value;
+		else if (option == "--work-directory")
+			options.workDirectory = value;
+		else if (option == "--golden")
+			options.goldenPath = value;
+		else if (option == "--tolerance")
+			options.tolerance = std::atoi(value);
+		else if (option == "--min-psnr")
+			options.minimumPsnr = std::atof(value);
+		else if (option == "--baseline")
+			options.baselinePath = value;
+		else if (option == "--max-slowdown")
+			options.maximumSlowdown = std::atof(value);
+		else if (option == "--runs")
+			options.runCount = std::max(1, std::atoi(value));
+		else
+			return false;
+	}
+
+	if (options.rendererPath.empty() || options.scenePath.empty() || options.workDirectory.empty())
+		return false;
+
+	if (options.mode == "image")
+		return !options.goldenPath.empty();
+	if (options.mode == "timing")
+		return !options.baselinePath.empty();
+	if (options.mode == "heatmap")
+		return !options.rendererOptions.empty();
+	return false;
+}
+
+int
+main(int argc, char* argv[])
+{
+	RegressionOptions options;
+	if (!parse_options(argc, argv, options)) {
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	CheckResult result = CheckResult::Failed;
+	if (options.mode == "image")
+		result = check_image(options) ? CheckResult::Passed : CheckResult::Failed;
+	else if (options.mode == "timing")
+		result = check_timing(options);
+	else
+		result = check_heatmap(options) ? CheckResult::Passed : CheckResult::Failed;
+
+	if (result == CheckResult::Skipped)
+		return kSkippedExitCode;
+
+	return result == CheckResult::Passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}